@@ -67,12 +67,14 @@ function(${PROJECT_NAME}_add_test)
     if(NOT ${PROJECT_NAME}_USING_CATKIN)
         add_executable(${TEST_NAME} ${${PROJECT_NAME}_SOURCES})
         target_link_libraries(${TEST_NAME}
-            ${${PROJECT_NAME}_TEST_LIBS} ${${PROJECT_NAME}_LIBS})
+            ${${PROJECT_NAME}_TEST_LIBS} ${${PROJECT_NAME}_LIBS}
+            ${CMAKE_THREAD_LIBS_INIT})
         add_test(${TEST_NAME} ${TEST_NAME})
     else(NOT ${PROJECT_NAME}_USING_CATKIN)
         catkin_add_gtest(${TEST_NAME} ${${PROJECT_NAME}_SOURCES})
         target_link_libraries(${TEST_NAME}
-            ${${PROJECT_NAME}_TEST_LIBS} ${${PROJECT_NAME}_LIBS})
+            ${${PROJECT_NAME}_TEST_LIBS} ${${PROJECT_NAME}_LIBS}
+            ${CMAKE_THREAD_LIBS_INIT})
     endif(NOT ${PROJECT_NAME}_USING_CATKIN)
 endfunction(${PROJECT_NAME}_add_test)
 
@@ -105,6 +105,21 @@ public:
     typedef
     typename StdGaussianMappingInterface::StandardVariate StandardVariate;
 
+    /**
+     * \brief Batch of variates, one variate per column
+     */
+    typedef Eigen::Matrix<
+                typename Variate::Scalar,
+                SizeOf<Variate>::Value,
+                Eigen::Dynamic
+            > VariateMatrix;
+
+    /**
+     * \brief Batch of scalar values, one value per variate of a
+     *        \c VariateMatrix
+     */
+    typedef Eigen::Array<Real, Eigen::Dynamic, 1> ValueArray;
+
 protected:
     /** \cond internal */
     /**
@@ -426,14 +441,35 @@ public:
         if(has_full_rank())
         {
             return log_normalizer() - 0.5
-                    * (vector - mean()).transpose()
-                    * precision()
-                    * (vector - mean());
+                    * (vector - mean()).cwiseAbs2()
+                          .dot(precision().diagonal());
         }
 
         return -std::numeric_limits<Real>::infinity();
     }
 
+    /**
+     * \return Log probabilities of all \a points, one point per column
+     *
+     * The squared differences of all points are weighted by the diagonal
+     * precision at once and the normalizer is evaluated once.
+     *
+     * \throws see has_full_rank()
+     */
+    virtual ValueArray log_probabilities(const VariateMatrix& points) const
+    {
+        if(has_full_rank())
+        {
+            return log_normalizer() - 0.5
+                    * (precision().diagonal().transpose()
+                       * (points.colwise() - mean()).cwiseAbs2())
+                          .transpose().array();
+        }
+
+        return ValueArray::Constant(
+                    points.cols(), -std::numeric_limits<Real>::infinity());
+    }
+
     /**
      * \return a Gaussian sample of the type \c Vector determined by mapping a
      * noise sample into the Gaussian sample space
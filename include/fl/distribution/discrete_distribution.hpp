@@ -23,10 +23,13 @@
 #include <Eigen/Core>
 
 #include <vector>
+#include <algorithm>
 
 #include <fl/util/types.hpp>
 #include <fl/util/traits.hpp>
 #include <fl/util/assertions.hpp>
+#include <fl/util/thread_pool.hpp>
+#include <fl/distribution/weighted_moments.hpp>
 #include <fl/distribution/interface/moments.hpp>
 #include <fl/distribution/interface/standard_gaussian_mapping.hpp>
 
@@ -45,6 +48,7 @@ public:
 
     typedef Eigen::Array<Real,    Locations, 1> Function;
     typedef Eigen::Array<Variate, Locations, 1> LocationArray;
+    typedef Eigen::Array<int,     Locations, 1> IndexArray;
 
     typedef StandardGaussianMapping<Variate, 1> StdGaussianMapping;
     typedef typename StdGaussianMapping::StandardVariate StandardVariate;
@@ -64,44 +68,31 @@ public:
     // set ---------------------------------------------------------------------
     virtual void log_unnormalized_prob_mass(const Function& log_prob_mass)
     {
-        // rescale for numeric stability
-        log_prob_mass_ = log_prob_mass - log_prob_mass.maxCoeff();
-
-        // copy to prob mass
-        prob_mass_ = log_prob_mass_.exp();
-        Real sum = prob_mass_.sum();
-
-        // normalize
-        prob_mass_ /= sum;
-        log_prob_mass_ -= std::log(sum);
-
-        // compute cdf
-        cumul_distr_.resize(log_prob_mass_.size());
-
-        cumul_distr_[0] = prob_mass_[0];
-        for(int i = 1; i < cumul_distr_.size(); i++)
-        {
-            cumul_distr_[i] = cumul_distr_[i-1] + prob_mass_[i];
-        }
-
-        // resize locations
-        locations_.resize(log_prob_mass_.size());
+        log_prob_mass_ = log_prob_mass;
+        normalize();
     }
 
     virtual void delta_log_prob_mass(const Function& delta)
     {
-        log_unnormalized_prob_mass(log_prob_mass_ + delta);
+        log_prob_mass_ += delta;
+        normalize();
     }
 
     virtual void set_uniform(int new_size = -1)
     {
         if (new_size == -1) new_size = size();
 
-        log_unnormalized_prob_mass(Function::Zero(new_size));
+        log_prob_mass_.setZero(new_size);
+        normalize();
     }
 
+    /**
+     * \brief Write access to the i-th location. This invalidates the cached
+     *        moments.
+     */
     virtual Variate& location(int i)
     {
+        moments_.invalidate();
         return locations_[i];
     }
 
@@ -120,6 +111,46 @@ public:
 
         set_uniform(new_size);
         locations_ = new_locations;
+        moments_.invalidate();
+    }
+
+    /**
+     * \brief Resamples the locations of \a distribution using the given
+     *        resampling scheme. The resulting distribution is uniform over the
+     *        \a new_size selected locations.
+     *
+     * In contrast to from_distribution(distribution, new_size), which draws
+     * every location independently, the \a resampling policy is handed the
+     * whole cumulative distribution and selects all indices at once. See
+     * MultinomialResampling, SystematicResampling, StratifiedResampling and
+     * ResidualResampling.
+     *
+     * \param distribution   Source distribution. May be \c *this.
+     * \param new_size       Number of resampled locations
+     * \param resampling     Resampling policy
+     */
+    template <typename Resampling>
+    void from_distribution(const DiscreteDistribution& distribution,
+                           const int& new_size,
+                           const Resampling& resampling)
+    {
+        resampled_indices_.resize(new_size);
+        resampling(distribution.cumulative_distribution(), resampled_indices_);
+
+        // same as above, the source locations must remain intact while
+        // copying in case distribution is *this. the selected locations are
+        // gathered into a second buffer which is then swapped in. once both
+        // buffers have reached new_size, resampling does not allocate.
+        resampled_locations_.resize(new_size);
+
+        for(int i = 0; i < new_size; i++)
+        {
+            resampled_locations_[i] =
+                distribution.location(resampled_indices_[i]);
+        }
+
+        locations_.swap(resampled_locations_);
+        set_uniform(new_size);
     }
 
 
@@ -139,11 +170,13 @@ public:
     virtual Variate map_standard_uniform(const StandardVariate& uniform_sample,
                                          int& index) const
     {
-        index = 0;
-        for (index = 0; index < cumul_distr_.size(); ++index)
-        {
-            if (cumul_distr_[index] >= uniform_sample) break;
-        }
+        // binary search for the first cdf entry which is >= uniform_sample
+        const Function& cdf = cumulative_distribution();
+        const Real* begin = cdf.data();
+        const Real* end = cdf.data() + cdf.size();
+
+        index = std::lower_bound(begin, end, Real(uniform_sample)) - begin;
+        index = std::min(index, int(cdf.size()) - 1);
 
         return locations_[index];
     }
@@ -199,6 +232,29 @@ public:
         return prob_mass_;
     }
 
+    /**
+     * \return Cumulative distribution of the probability mass. It is
+     *         rebuilt here on the first access after the weights changed.
+     */
+    virtual const Function& cumulative_distribution() const
+    {
+        if (cumul_distr_outdated_)
+        {
+            cumul_distr_.resize(prob_mass_.size());
+
+            Real cumul = 0;
+            for(int i = 0; i < cumul_distr_.size(); i++)
+            {
+                cumul += prob_mass_[i];
+                cumul_distr_[i] = cumul;
+            }
+
+            cumul_distr_outdated_ = false;
+        }
+
+        return cumul_distr_;
+    }
+
     virtual int size() const
     {
         return locations_.size();
@@ -211,16 +267,16 @@ public:
 
 
     // compute properties ------------------------------------------------------
+    /**
+     * \return Weighted mean. The mean and the covariance are computed
+     *         together in a single blocked pass and cached until the
+     *         locations or the weights change, see compute_moments().
+     */
     virtual const Mean& mean() const
     {
-        mu_ = Mean::Zero(dimension());
+        if (moments_.outdated()) compute_moments();
 
-        for(int i = 0; i < locations_.size(); i++)
-        {
-            mu_ += prob_mass(i) * locations_[i].template cast<Real>();
-        }
-
-        return mu_;
+        return moments_.mean();
     }
 
     virtual const Variate& max() const
@@ -233,17 +289,25 @@ public:
 
 
 
+    /**
+     * \return Weighted covariance, see mean()
+     */
     virtual const Covariance& covariance() const
     {
-        Mean mu = mean();
-        cov_ = Covariance::Zero(dimension(), dimension());
-        for(int i = 0; i < locations_.size(); i++)
-        {
-            Mean delta = (locations_[i].template cast<Real>()-mu);
-            cov_ += prob_mass(i) * delta * delta.transpose();
-        }
+        if (moments_.outdated()) compute_moments();
+
+        return moments_.covariance();
+    }
 
-        return cov_;
+    /**
+     * \brief Computes the cached mean and covariance if they are outdated.
+     *        The locations are split into contiguous chunks, one per thread
+     *        of \a thread_pool, and the partial moments of the chunks are
+     *        reduced afterwards.
+     */
+    void compute_moments(ThreadPool& thread_pool) const
+    {
+        if (moments_.outdated()) compute_moments(&thread_pool);
     }
 
     virtual Real entropy() const
@@ -257,6 +321,83 @@ public:
         return std::log(Real(size())) - entropy();
     }
 
+    /**
+     * \return Effective sample size \f$ 1 / \sum_i w_i^2 \f$ of the
+     *         normalized weights \f$ w \f$. It ranges from 1, if the entire
+     *         mass is on one location, to size() for uniform weights. The
+     *         value is computed along with the normalization and returned
+     *         without any further pass over the weights.
+     */
+    virtual Real effective_sample_size() const
+    {
+        return effective_sample_size_;
+    }
+
+
+protected:
+    /** \cond internal */
+    /**
+     * \brief Computes the mean and the covariance in one pass, see
+     *        internal::WeightedMoments
+     */
+    void compute_moments(ThreadPool* thread_pool = nullptr) const
+    {
+        moments_.compute(
+            dimension(),
+            prob_mass_,
+            [this](int i) -> const Variate& { return locations_[i]; },
+            thread_pool);
+    }
+
+    /**
+     * \brief Number of weights processed per block in normalize()
+     */
+    enum : int { NormalizationBlock = 256 };
+
+    /**
+     * \brief Normalizes log_prob_mass_ in place and updates the probability
+     *        mass and the effective sample size. No memory is allocated
+     *        unless the number of locations changes. The cumulative
+     *        distribution is only marked outdated, it is rebuilt on demand
+     *        by cumulative_distribution().
+     *
+     * The exponentiation, the sum and the sum of squares are evaluated
+     * together block by block, so that each block is still cached when it is
+     * reduced. A final pass rescales both the log and the linear masses.
+     */
+    void normalize()
+    {
+        const int size = log_prob_mass_.size();
+        prob_mass_.resize(size);
+
+        // rescale for numeric stability
+        const Real max = log_prob_mass_.maxCoeff();
+
+        Real sum = 0;
+        Real squared_sum = 0;
+        for (int begin = 0; begin < size; begin += NormalizationBlock)
+        {
+            const int length = std::min(int(NormalizationBlock), size - begin);
+
+            auto block = prob_mass_.segment(begin, length);
+            block = (log_prob_mass_.segment(begin, length) - max).exp();
+
+            sum += block.sum();
+            squared_sum += block.square().sum();
+        }
+
+        // normalize
+        prob_mass_ *= Real(1) / sum;
+        log_prob_mass_ -= max + std::log(sum);
+
+        effective_sample_size_ = sum * sum / squared_sum;
+        cumul_distr_outdated_ = true;
+        moments_.invalidate();
+
+        // resize locations
+        locations_.resize(log_prob_mass_.size());
+    }
+    /** \endcond */
 
 protected:
     /// member variables *******************************************************
@@ -264,10 +405,17 @@ protected:
 
     Function log_prob_mass_;
     Function prob_mass_;
-    Function cumul_distr_;
+    mutable Function cumul_distr_;
+    mutable bool cumul_distr_outdated_;
+    Real effective_sample_size_;
+
+    mutable internal::WeightedMoments<Mean, Covariance> moments_;
 
-    mutable Mean mu_;
-    mutable Covariance cov_;
+    /** \cond internal */
+    /* resampling buffers, see from_distribution(distribution, size, resampling) */
+    IndexArray resampled_indices_;
+    LocationArray resampled_locations_;
+    /** \endcond */
 };
 
 }
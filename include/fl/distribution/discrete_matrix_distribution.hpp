@@ -0,0 +1,460 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file discrete_matrix_distribution.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Core>
+
+#include <algorithm>
+
+#include <fl/util/types.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/util/assertions.hpp>
+#include <fl/util/thread_pool.hpp>
+#include <fl/distribution/weighted_moments.hpp>
+#include <fl/distribution/interface/moments.hpp>
+#include <fl/distribution/interface/standard_gaussian_mapping.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup distributions
+ *
+ * \brief Discrete distribution storing all locations in one contiguous matrix.
+ *
+ * This is a drop-in alternative to DiscreteDistribution. Instead of an array
+ * of individually allocated variates, the locations are the columns of a
+ * single \f$\dim(x) \times N\f$ matrix. The weighted moments then reduce to a
+ * matrix-vector and a matrix-matrix product and a sensor can evaluate all
+ * locations column-wise (see SensorDensity::log_probabilities).
+ *
+ * Write access to a location is given through a column expression, i.e.
+ * \c location(i) can be assigned to like a \c Variate.
+ */
+template <typename Variate, int Locations = Eigen::Dynamic>
+class DiscreteMatrixDistribution
+    : public Moments<typename FirstMomentOf<Variate>::Type>,
+      public StandardGaussianMapping<Variate, 1>
+{
+public:
+    typedef Moments<typename FirstMomentOf<Variate>::Type>  MomentsInterface;
+    typedef typename MomentsInterface::Variate              Mean;
+    typedef typename MomentsInterface::SecondMoment         Covariance;
+
+    typedef Eigen::Array<Real, Locations, 1> Function;
+    typedef Eigen::Array<int,  Locations, 1> IndexArray;
+
+    /**
+     * \brief Location storage, one column per location
+     */
+    typedef Eigen::Matrix<
+                typename Variate::Scalar,
+                SizeOf<Variate>::Value,
+                Locations
+            > LocationMatrix;
+
+    typedef StandardGaussianMapping<Variate, 1> StdGaussianMapping;
+    typedef typename StdGaussianMapping::StandardVariate StandardVariate;
+
+public:
+    /// constructor and destructor *********************************************
+    explicit
+    DiscreteMatrixDistribution(int size = MaxOf<Locations, 1>::value,
+                               int dim = DimensionOf<Variate>())
+        : locations_(dim, size)
+    {
+        set_uniform(size);
+    }
+
+    virtual ~DiscreteMatrixDistribution() noexcept { }
+
+    /// non-const functions ****************************************************
+
+    // set ---------------------------------------------------------------------
+    virtual void log_unnormalized_prob_mass(const Function& log_prob_mass)
+    {
+        log_prob_mass_ = log_prob_mass;
+        normalize();
+    }
+
+    virtual void delta_log_prob_mass(const Function& delta)
+    {
+        log_prob_mass_ += delta;
+        normalize();
+    }
+
+    virtual void set_uniform(int new_size = -1)
+    {
+        if (new_size == -1) new_size = size();
+
+        log_prob_mass_.setZero(new_size);
+        normalize();
+    }
+
+    /**
+     * \brief Changes the dimension of the locations. The location values are
+     *        undefined afterwards.
+     */
+    virtual void dimension(int new_dimension)
+    {
+        locations_.resize(new_dimension, size());
+        moments_.invalidate();
+    }
+
+    /**
+     * \brief Write access to the i-th location. This invalidates the cached
+     *        moments.
+     */
+    virtual typename LocationMatrix::ColXpr location(int i)
+    {
+        moments_.invalidate();
+        return locations_.col(i);
+    }
+
+    /**
+     * \brief Write access to all locations. This invalidates the cached
+     *        moments.
+     */
+    virtual LocationMatrix& locations()
+    {
+        moments_.invalidate();
+        return locations_;
+    }
+
+    template <typename Distribution>
+    void from_distribution(const Distribution& distribution, const int& new_size)
+    {
+        // sample into a local matrix first. this way, if this is passed as an
+        // argument the locations and pmf are not overwritten while sampling
+        LocationMatrix new_locations;
+
+        for(int i = 0; i < new_size; i++)
+        {
+            const Variate sample = distribution.sample();
+
+            if (i == 0) new_locations.resize(sample.rows(), new_size);
+
+            new_locations.col(i) = sample;
+        }
+
+        set_uniform(new_size);
+        locations_ = new_locations;
+        moments_.invalidate();
+    }
+
+    /**
+     * \brief Resamples the locations of \a distribution using the given
+     *        resampling scheme. The resulting distribution is uniform over the
+     *        \a new_size selected locations.
+     *
+     * \see DiscreteDistribution::from_distribution
+     */
+    template <typename Resampling>
+    void from_distribution(const DiscreteMatrixDistribution& distribution,
+                           const int& new_size,
+                           const Resampling& resampling)
+    {
+        resampled_indices_.resize(new_size);
+        resampling(distribution.cumulative_distribution(), resampled_indices_);
+
+        // gather into the second buffer and swap it in, this keeps the
+        // source intact if distribution is *this and does not allocate once
+        // both buffers have reached their size
+        resampled_locations_.resize(distribution.dimension(), new_size);
+
+        for(int i = 0; i < new_size; i++)
+        {
+            resampled_locations_.col(i) =
+                distribution.locations_.col(resampled_indices_[i]);
+        }
+
+        locations_.swap(resampled_locations_);
+        set_uniform(new_size);
+    }
+
+
+    /// const functions ********************************************************
+
+    // sampling ----------------------------------------------------------------
+    virtual Variate map_standard_normal(const StandardVariate& gaussian_sample,
+                                        int& index) const
+    {
+        StandardVariate scaled_sample = gaussian_sample / std::sqrt(2.0);
+        StandardVariate uniform_sample = 0.5 * (1.0 + std::erf(scaled_sample));
+
+        return map_standard_uniform(uniform_sample, index);
+    }
+
+    virtual Variate map_standard_uniform(const StandardVariate& uniform_sample,
+                                         int& index) const
+    {
+        // binary search for the first cdf entry which is >= uniform_sample
+        const Function& cdf = cumulative_distribution();
+        const Real* begin = cdf.data();
+        const Real* end = cdf.data() + cdf.size();
+
+        index = std::lower_bound(begin, end, Real(uniform_sample)) - begin;
+        index = std::min(index, int(cdf.size()) - 1);
+
+        return locations_.col(index);
+    }
+
+    using StdGaussianMapping::sample;
+
+    virtual Variate sample(int& index) const
+    {
+        return map_standard_normal(this->standard_gaussian_.sample(), index);
+    }
+
+    virtual Variate map_standard_normal(const StandardVariate& gaussian_sample) const
+    {
+        int index;
+        return map_standard_normal(gaussian_sample, index);
+    }
+
+    virtual Variate map_standard_uniform(const StandardVariate& uniform_sample) const
+    {
+        int index;
+        return map_standard_uniform(uniform_sample, index);
+    }
+
+
+    // get ---------------------------------------------------------------------
+    virtual typename LocationMatrix::ConstColXpr location(int i) const
+    {
+        return locations_.col(i);
+    }
+
+    virtual const LocationMatrix& locations() const
+    {
+        return locations_;
+    }
+
+    virtual Real log_prob_mass(const int& i) const
+    {
+        return log_prob_mass_(i);
+    }
+
+    virtual Function log_prob_mass() const
+    {
+        return log_prob_mass_;
+    }
+
+    virtual Real prob_mass(const int& i) const
+    {
+        return prob_mass_(i);
+    }
+
+    virtual Function prob_mass() const
+    {
+        return prob_mass_;
+    }
+
+    /**
+     * \return Cumulative distribution of the probability mass. It is
+     *         rebuilt here on the first access after the weights changed.
+     */
+    virtual const Function& cumulative_distribution() const
+    {
+        if (cumul_distr_outdated_)
+        {
+            cumul_distr_.resize(prob_mass_.size());
+
+            Real cumul = 0;
+            for(int i = 0; i < cumul_distr_.size(); i++)
+            {
+                cumul += prob_mass_[i];
+                cumul_distr_[i] = cumul;
+            }
+
+            cumul_distr_outdated_ = false;
+        }
+
+        return cumul_distr_;
+    }
+
+    virtual int size() const
+    {
+        return locations_.cols();
+    }
+
+    virtual int dimension() const
+    {
+        return locations_.rows();
+    }
+
+
+    // compute properties ------------------------------------------------------
+    /**
+     * \return Weighted mean. The mean and the covariance are computed
+     *         together in a single blocked pass and cached until the
+     *         locations or the weights change, see compute_moments().
+     */
+    virtual const Mean& mean() const
+    {
+        if (moments_.outdated()) compute_moments();
+
+        return moments_.mean();
+    }
+
+    virtual Variate max() const
+    {
+        int max_index;
+        log_prob_mass_.maxCoeff(&max_index);
+
+        return locations_.col(max_index);
+    }
+
+    /**
+     * \return Weighted covariance, see mean()
+     */
+    virtual const Covariance& covariance() const
+    {
+        if (moments_.outdated()) compute_moments();
+
+        return moments_.covariance();
+    }
+
+    /**
+     * \brief Computes the cached mean and covariance if they are outdated
+     *        using the threads of \a thread_pool
+     *
+     * \see DiscreteDistribution::compute_moments
+     */
+    void compute_moments(ThreadPool& thread_pool) const
+    {
+        if (moments_.outdated()) compute_moments(&thread_pool);
+    }
+
+    virtual Real entropy() const
+    {
+        return - log_prob_mass_.cwiseProduct(prob_mass_).sum();
+    }
+
+    // implements KL(p||u) where p is this distr, and u is the uniform distr
+    virtual Real kl_given_uniform() const
+    {
+        return std::log(Real(size())) - entropy();
+    }
+
+    /**
+     * \return Effective sample size \f$ 1 / \sum_i w_i^2 \f$ of the
+     *         normalized weights \f$ w \f$. It ranges from 1, if the entire
+     *         mass is on one location, to size() for uniform weights. The
+     *         value is computed along with the normalization and returned
+     *         without any further pass over the weights.
+     */
+    virtual Real effective_sample_size() const
+    {
+        return effective_sample_size_;
+    }
+
+
+protected:
+    /** \cond internal */
+    /**
+     * \brief Computes the mean and the covariance in one pass, see
+     *        internal::WeightedMoments
+     */
+    void compute_moments(ThreadPool* thread_pool = nullptr) const
+    {
+        moments_.compute(
+            dimension(),
+            prob_mass_,
+            [this](int i) { return locations_.col(i); },
+            thread_pool);
+    }
+
+    /**
+     * \brief Number of weights processed per block in normalize()
+     */
+    enum : int { NormalizationBlock = 256 };
+
+    /**
+     * \brief Normalizes log_prob_mass_ in place and updates the probability
+     *        mass and the effective sample size. No memory is allocated
+     *        unless the number of locations changes. The cumulative
+     *        distribution is only marked outdated, it is rebuilt on demand
+     *        by cumulative_distribution().
+     *
+     * The exponentiation, the sum and the sum of squares are evaluated
+     * together block by block, so that each block is still cached when it is
+     * reduced. A final pass rescales both the log and the linear masses.
+     */
+    void normalize()
+    {
+        const int size = log_prob_mass_.size();
+        prob_mass_.resize(size);
+
+        // rescale for numeric stability
+        const Real max = log_prob_mass_.maxCoeff();
+
+        Real sum = 0;
+        Real squared_sum = 0;
+        for (int begin = 0; begin < size; begin += NormalizationBlock)
+        {
+            const int length = std::min(int(NormalizationBlock), size - begin);
+
+            auto block = prob_mass_.segment(begin, length);
+            block = (log_prob_mass_.segment(begin, length) - max).exp();
+
+            sum += block.sum();
+            squared_sum += block.square().sum();
+        }
+
+        // normalize
+        prob_mass_ *= Real(1) / sum;
+        log_prob_mass_ -= max + std::log(sum);
+
+        effective_sample_size_ = sum * sum / squared_sum;
+        cumul_distr_outdated_ = true;
+        moments_.invalidate();
+
+        // resize locations
+        if (locations_.cols() != log_prob_mass_.size())
+        {
+            locations_.conservativeResize(
+                locations_.rows(), log_prob_mass_.size());
+        }
+    }
+    /** \endcond */
+
+protected:
+    /// member variables *******************************************************
+    LocationMatrix locations_;
+
+    Function log_prob_mass_;
+    Function prob_mass_;
+    mutable Function cumul_distr_;
+    mutable bool cumul_distr_outdated_;
+    Real effective_sample_size_;
+
+    mutable internal::WeightedMoments<Mean, Covariance> moments_;
+
+    /** \cond internal */
+    /* resampling buffers, see from_distribution(distribution, size, resampling) */
+    IndexArray resampled_indices_;
+    LocationMatrix resampled_locations_;
+    /** \endcond */
+};
+
+}
@@ -24,11 +24,13 @@
 #include <Eigen/Dense>
 
 #include <array>
+#include <limits>
 #include <string>
 #include <cstddef>
 #include <type_traits>
 
 #include <fl/util/traits.hpp>
+#include <fl/util/math/covariance_factorization.hpp>
 #include <fl/exception/exception.hpp>
 #include <fl/distribution/interface/moments.hpp>
 #include <fl/distribution/interface/evaluation.hpp>
@@ -122,6 +124,12 @@ public:
  * representation affects all remaining ones. If one of the representation is
  * modified, the other representations are only then updated when needed. This
  * minimizes redundant computation and increases efficienty.
+ *
+ * The dense covariance is decomposed at most once per change. The square
+ * root, the rank, the determinant and the log probability are all derived
+ * from this single factorization, which is the Cholesky decomposition or, if
+ * the covariance is not positive definite, an LDLT decomposition. The explicit
+ * precision matrix is only formed if it is requested.
  * \endcond
  */
 template <typename Variate>
@@ -151,6 +159,21 @@ public:
      */
     typedef typename StdGaussianMappingBase::StandardVariate StandardVariate;
 
+    /**
+     * \brief Batch of variates, one variate per column
+     */
+    typedef Eigen::Matrix<
+                typename Variate::Scalar,
+                SizeOf<Variate>::Value,
+                Eigen::Dynamic
+            > VariateMatrix;
+
+    /**
+     * \brief Batch of scalar values, one value per variate of a
+     *        \c VariateMatrix
+     */
+    typedef Eigen::Array<Real, Eigen::Dynamic, 1> ValueArray;
+
 protected:
     /** \cond internal */
     /**
@@ -170,6 +193,7 @@ protected:
         Rank,                     /**< Covariance Rank */
         Normalizer,               /**< Log probability normalizer */
         Determinant,              /**< Determinant of covariance */
+        Factorization,            /**< Cholesky or LDLT of the cov. mat. */
 
         Attributes                /**< Total number of attribute */
     };
@@ -363,7 +387,8 @@ public:
             {
             case CovarianceMatrix:
             case PrecisionMatrix:
-                fl::square_root(cov, square_root_);
+                factorize();
+                square_root_ = factorization_.square_root();
                 break;
 
             case DiagonalCovarianceMatrix:
@@ -395,8 +420,14 @@ public:
     {
         if (is_dirty(Rank))
         {
-            full_rank_ =
-               covariance().colPivHouseholderQr().rank() == covariance().rows();
+            // all pivots of the factorization must be significant
+            const auto pivots = factorization_pivots();
+            const Real threshold =
+                pivots.cwiseAbs().maxCoeff()
+                * Real(dimension())
+                * std::numeric_limits<Real>::epsilon();
+
+            full_rank_ = (pivots.array() > threshold).all();
 
             updated_internally(Rank);
         }
@@ -417,7 +448,7 @@ public:
             {
                 log_norm_ =
                     -0.5
-                    * (std::log(covariance_determinant())
+                    * (factorization_pivots().array().log().sum()
                        + Real(dimension()) * std::log(2.0 * M_PI));
             }
             else
@@ -440,7 +471,7 @@ public:
     {
         if (is_dirty(Determinant))
         {
-            determinant_ = covariance().determinant();
+            determinant_ = factorization_pivots().prod();
 
             updated_internally(Determinant);
         }
@@ -448,6 +479,36 @@ public:
         return determinant_;
     }
 
+    /**
+     * \return Squared Mahalanobis distance
+     *         \f$ (x - \mu)^T \Sigma^{-1} (x - \mu) \f$ of \a vector
+     *
+     * The difference \f$ x - \mu \f$ is whitened by a forward substitution
+     * with the cached Cholesky factor. The precision matrix is not formed.
+     *
+     * \throws see covariance()
+     */
+    virtual Real squared_mahalanobis_distance(const Variate& vector) const
+    {
+        Variate delta = vector - mean_;
+
+        return squared_mahalanobis_terms(delta)(0);
+    }
+
+    /**
+     * \return Squared Mahalanobis distances of all \a points, one point per
+     *         column, see squared_mahalanobis_distance()
+     *
+     * \throws see covariance()
+     */
+    virtual ValueArray squared_mahalanobis_distances(
+        const VariateMatrix& points) const
+    {
+        VariateMatrix deltas = points.colwise() - mean_;
+
+        return squared_mahalanobis_terms(deltas).transpose();
+    }
+
     /**
      * \return Log of the probability of the given sample \c vector
      *
@@ -461,15 +522,33 @@ public:
 
         if(has_full_rank())
         {
-            return log_normalizer() - 0.5
-                    * (vector - mean()).transpose()
-                    * precision()
-                    * (vector - mean());
+            return log_normalizer()
+                   - 0.5 * squared_mahalanobis_distance(vector);
         }
 
         return -std::numeric_limits<Real>::infinity();
     }
 
+    /**
+     * \return Log probabilities of all \a points, one point per column
+     *
+     * All points are whitened by a single triangular solve and the
+     * normalizer is evaluated once.
+     *
+     * \throws see has_full_rank()
+     */
+    virtual ValueArray log_probabilities(const VariateMatrix& points) const
+    {
+        if(has_full_rank())
+        {
+            return log_normalizer()
+                   - 0.5 * squared_mahalanobis_distances(points);
+        }
+
+        return ValueArray::Constant(
+                    points.cols(), -std::numeric_limits<Real>::infinity());
+    }
+
     /**
      * \return a Gaussian sample of the type \c Variate determined by mapping a
      * noise sample into the Gaussian sample space
@@ -552,6 +631,37 @@ public:
         updated_externally(CovarianceMatrix);
     }
 
+    /**
+     * Sets the covariance matrix along with an already computed square root
+     * \f$L\f$, \f$L L^T = \Sigma\f$, e.g. its Cholesky factor. Neither of the
+     * two has to be recomputed from the other.
+     *
+     * \param covariance    New covariance matrix
+     * \param square_root   Square root of \a covariance
+     *
+     * \throws WrongSizeException
+     */
+    virtual void covariance(const SecondMoment& covariance,
+                            const SecondMoment& square_root)
+    {
+        if (covariance_.size() != covariance.size())
+        {
+            fl_throw(fl::WrongSizeException(
+                         covariance.size(), covariance_.size()));
+        }
+
+        if (square_root_.size() != square_root.size())
+        {
+            fl_throw(fl::WrongSizeException(
+                         square_root.size(), square_root_.size()));
+        }
+
+        covariance_ = covariance;
+        square_root_ = square_root;
+        updated_externally(CovarianceMatrix);
+        updated_internally(SquareRootMatrix);
+    }
+
     /**
      * Sets the covariance matrix in the form of its square root (Cholesky f
      * actor)
@@ -723,6 +833,75 @@ protected:
         return dirty_[int(attribute)];
     }
 
+    /**
+     * Decomposes the covariance matrix if it has changed. The Cholesky
+     * decomposition is used unless the covariance is not positive definite,
+     * in which case an LDLT decomposition is used. Small fixed-size
+     * covariances are decomposed by unrolled closed-form kernels, see
+     * CovarianceFactorization.
+     */
+    void factorize() const
+    {
+        if (is_dirty(Factorization))
+        {
+            factorization_.compute(covariance());
+
+            updated_internally(Factorization);
+        }
+    }
+
+    /**
+     * \return Squared Mahalanobis terms of the columns of \a deltas which
+     *         are differences from the mean. \a deltas is used as workspace.
+     *
+     * Diagonal forms are scaled element-wise. Otherwise the deltas are
+     * whitened by the Cholesky factor \f$ L \f$, i.e. the terms are the
+     * squared column norms of \f$ L^{-1} \Delta \f$. An already available
+     * precision is used only if the covariance has not been factorized.
+     */
+    template <typename Deltas>
+    Eigen::Array<Real, 1, Deltas::ColsAtCompileTime>
+    squared_mahalanobis_terms(Deltas& deltas) const
+    {
+        if (!is_dirty(DiagonalCovarianceMatrix) ||
+            !is_dirty(DiagonalSquareRootMatrix) ||
+            !is_dirty(DiagonalPrecisionMatrix))
+        {
+            return (covariance().diagonal().cwiseInverse().asDiagonal()
+                    * deltas.cwiseAbs2()).colwise().sum().array();
+        }
+
+        if (!is_dirty(Factorization) || is_dirty(PrecisionMatrix))
+        {
+            factorize();
+
+            return factorization_.squared_norms(deltas);
+        }
+
+        return deltas.cwiseProduct(precision() * deltas)
+                     .colwise().sum().array();
+    }
+
+    /**
+     * \return Pivots of the covariance factorization, i.e. the squared
+     *         diagonal of the Cholesky factor or the diagonal of the LDLT.
+     *         Their product is the determinant of the covariance.
+     */
+    Eigen::Matrix<Real, SizeOf<Variate>::Value, 1> factorization_pivots() const
+    {
+        // diagonal forms need no decomposition
+        if (!is_dirty(DiagonalCovarianceMatrix) ||
+            !is_dirty(DiagonalSquareRootMatrix) ||
+            !is_dirty(DiagonalPrecisionMatrix))
+        {
+            return covariance().diagonal();
+        }
+
+        factorize();
+
+        return factorization_.pivots();
+    }
+
     /**
      * \return First representation ID that is available
      *
@@ -776,6 +955,9 @@ protected:
     mutable Real log_norm_;            /**< \brief log normalizing constant */
     mutable Real determinant_;         /**< \brief determinant of covariance */
     mutable FlagArray dirty_;          /**< \brief data validity flags */
+
+    /** \brief Cholesky or LDLT decomposition of the covariance */
+    mutable CovarianceFactorization<SecondMoment> factorization_;
     /** \endcond */
 };
 
@@ -0,0 +1,206 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file gaussian_batch.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Core>
+
+#include <fl/util/types.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/distribution/gaussian.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup distributions
+ *
+ * \brief Batch of independent Gaussians over \a Variate stored in a
+ *        structure of arrays layout.
+ *
+ * The means are stored as a \f$\dim \times N\f$ matrix, one column per
+ * Gaussian. The covariances are stored packed, i.e. only their lower
+ * triangles, as a \f$\dim(\dim + 1)/2 \times N\f$ matrix. The element
+ * \f$(i, j)\f$, \f$i \geq j\f$, of all covariances is the row
+ * packed_index(i, j). Both matrices are row-major such that a row, i.e.
+ * the same element of all Gaussians, is contiguous in memory. Operations
+ * on entire rows are thereby vectorized across the batch.
+ *
+ * This is the belief of the BatchGaussianFilter.
+ */
+template <typename Variate>
+class GaussianBatch
+{
+public:
+    typedef typename SecondMomentOf<Variate>::Type SecondMoment;
+
+    /**
+     * \brief Row-major matrix of one column per Gaussian
+     */
+    typedef Eigen::Matrix<
+                Real, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor
+            > BatchMatrix;
+
+public:
+    /**
+     * \brief Creates a batch of \a size standard Gaussians
+     *
+     * \param size        Number of Gaussians
+     * \param dimension   Dimension of the Gaussians
+     */
+    explicit GaussianBatch(int size = 0,
+                           int dimension = DimensionOf<Variate>())
+        : dimension_(dimension)
+    {
+        resize(size);
+    }
+
+    /**
+     * \brief Resizes the batch to \a size standard Gaussians
+     */
+    void resize(int size)
+    {
+        means_.setZero(dimension_, size);
+        covariances_.setZero(packed_size(dimension_), size);
+
+        for (int i = 0; i < dimension_; ++i)
+        {
+            covariances_.row(packed_index(i, i)).setOnes();
+        }
+    }
+
+    /**
+     * \return Number of Gaussians
+     */
+    int size() const
+    {
+        return means_.cols();
+    }
+
+    int dimension() const
+    {
+        return dimension_;
+    }
+
+    Variate mean(int k) const
+    {
+        return means_.col(k);
+    }
+
+    void mean(int k, const Variate& mean)
+    {
+        means_.col(k) = mean;
+    }
+
+    SecondMoment covariance(int k) const
+    {
+        SecondMoment covariance(dimension_, dimension_);
+        for (int i = 0; i < dimension_; ++i)
+        {
+            for (int j = 0; j <= i; ++j)
+            {
+                covariance(i, j) = covariances_(packed_index(i, j), k);
+                covariance(j, i) = covariance(i, j);
+            }
+        }
+        return covariance;
+    }
+
+    void covariance(int k, const SecondMoment& covariance)
+    {
+        for (int i = 0; i < dimension_; ++i)
+        {
+            for (int j = 0; j <= i; ++j)
+            {
+                covariances_(packed_index(i, j), k) = covariance(i, j);
+            }
+        }
+    }
+
+    /**
+     * \return The k-th Gaussian
+     */
+    Gaussian<Variate> gaussian(int k) const
+    {
+        Gaussian<Variate> gaussian(dimension_);
+        gaussian.mean(mean(k));
+        gaussian.covariance(covariance(k));
+        return gaussian;
+    }
+
+    /**
+     * \brief Sets the k-th Gaussian
+     */
+    void gaussian(int k, const Gaussian<Variate>& gaussian)
+    {
+        mean(k, gaussian.mean());
+        covariance(k, gaussian.covariance());
+    }
+
+    BatchMatrix& means()
+    {
+        return means_;
+    }
+
+    const BatchMatrix& means() const
+    {
+        return means_;
+    }
+
+    /**
+     * \return Packed lower triangles of the covariances, see packed_index()
+     */
+    BatchMatrix& covariances()
+    {
+        return covariances_;
+    }
+
+    const BatchMatrix& covariances() const
+    {
+        return covariances_;
+    }
+
+    /**
+     * \return Row of the covariance element \f$(i, j)\f$ in covariances().
+     *         The element \f$(j, i)\f$ shares the row.
+     */
+    static int packed_index(int i, int j)
+    {
+        return i >= j ? i * (i + 1) / 2 + j : j * (j + 1) / 2 + i;
+    }
+
+    /**
+     * \return Number of distinct elements of a symmetric matrix of the
+     *         given \a dimension
+     */
+    static int packed_size(int dimension)
+    {
+        return dimension * (dimension + 1) / 2;
+    }
+
+protected:
+    /** \cond internal */
+    int dimension_;
+    BatchMatrix means_;
+    BatchMatrix covariances_;
+    /** \endcond */
+};
+
+}
@@ -0,0 +1,612 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file lean_gaussian.hpp
+ * \date 2015
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include <fl/util/traits.hpp>
+#include <fl/util/math/covariance_factorization.hpp>
+#include <fl/exception/exception.hpp>
+#include <fl/distribution/gaussian.hpp>
+#include <fl/distribution/interface/moments.hpp>
+#include <fl/distribution/interface/evaluation.hpp>
+#include <fl/distribution/interface/standard_gaussian_mapping.hpp>
+
+namespace fl
+{
+
+/** \cond internal */
+namespace internal
+{
+
+/**
+ * \brief Heap slot of an object which is only allocated on first access.
+ *        Copies are deep, an unallocated slot copies as unallocated.
+ */
+template <typename T>
+class LazySlot
+{
+public:
+    LazySlot() { }
+
+    LazySlot(const LazySlot& other)
+        : object_(other.allocated() ? new T(*other.object_) : nullptr)
+    { }
+
+    LazySlot& operator=(const LazySlot& other)
+    {
+        if (this == &other) return *this;
+
+        if (!other.allocated())
+        {
+            object_.reset();
+        }
+        else if (allocated())
+        {
+            *object_ = *other.object_;
+        }
+        else
+        {
+            object_.reset(new T(*other.object_));
+        }
+
+        return *this;
+    }
+
+    /**
+     * \return The object, allocated if necessary
+     */
+    T& get() const
+    {
+        if (!allocated()) object_.reset(new T());
+
+        return *object_;
+    }
+
+    bool allocated() const
+    {
+        return bool(object_);
+    }
+
+    void release()
+    {
+        object_.reset();
+    }
+
+private:
+    mutable std::unique_ptr<T> object_;
+};
+
+}
+/** \endcond */
+
+/**
+ * \ingroup distributions
+ *
+ * \brief Dense Gaussian \f${\cal N}(x; \mu, \Sigma)\f$ which stores only the
+ *        representation that was set.
+ *
+ * LeanGaussian offers the dense interface of Gaussian, i.e. the
+ * covariance, precision and square root representations, the log
+ * probability and sampling. Gaussian embeds all representations and the
+ * covariance factorization in every instance. LeanGaussian keeps each of
+ * them in a heap slot which is allocated on first request. A LeanGaussian
+ * whose covariance was set and which is only queried for its moments
+ * therefore holds the mean and a single matrix. This suits large arrays of
+ * Gaussians, e.g. the per-sensor body Gaussians of
+ * MultiRobustSensorFunction.
+ *
+ * Setting a representation invalidates the others without freeing them,
+ * so a filter cycle does not allocate again once all slots are in use.
+ * release_derived_representations() frees every slot except the one that
+ * was set.
+ *
+ * Diagonal representations are not supported, see DecorrelatedGaussian
+ * instead.
+ */
+template <typename Variate>
+class LeanGaussian
+    : public Moments<Variate>,
+      public Evaluation<Variate>,
+      public StandardGaussianMapping<Variate, SizeOf<Variate>::Value>
+{
+private:
+    typedef StandardGaussianMapping<
+                Variate,
+                SizeOf<Variate>::Value
+            > StdGaussianMappingBase;
+
+public:
+    /**
+     * \brief Second moment matrix type, i.e covariance matrix, precision
+     *        matrix and square root representation
+     */
+    typedef typename Moments<Variate>::SecondMoment SecondMoment;
+
+    /**
+     * \brief Represents the StandardGaussianMapping standard variate type
+     */
+    typedef typename StdGaussianMappingBase::StandardVariate StandardVariate;
+
+    /**
+     * \brief Batch of variates, one variate per column
+     */
+    typedef typename Gaussian<Variate>::VariateMatrix VariateMatrix;
+
+    /**
+     * \brief Batch of scalar values, one value per variate of a
+     *        \c VariateMatrix
+     */
+    typedef typename Gaussian<Variate>::ValueArray ValueArray;
+
+protected:
+    /** \cond internal */
+    /**
+     * \enum Attribute
+     * Representations and derived properties. The first three index the
+     * representation slots.
+     */
+    enum Attribute
+    {
+        CovarianceMatrix = 0,   /**< Covariance mat. */
+        PrecisionMatrix,        /**< Inverse of the cov. mat. */
+        SquareRootMatrix,       /**< Square root of the cov. mat. */
+        Factorization,          /**< Cholesky or LDLT of the cov. mat. */
+        Rank,                   /**< Covariance Rank */
+        Normalizer,             /**< Log probability normalizer */
+        Determinant,            /**< Determinant of covariance */
+
+        Representations = Factorization
+    };
+    /** \endcond */
+
+public:
+    /**
+     * Creates a dynamic or fixed size standard Gaussian.
+     *
+     * \param dimension Dimension of the Gaussian. For dynamic-sized Variate
+     *                  the dimension is initialized to 0.
+     */
+    explicit LeanGaussian(int dim = DimensionOf<Variate>())
+        : StdGaussianMappingBase(dim),
+          active_(CovarianceMatrix),
+          valid_(0)
+    {
+        static_assert(Variate::SizeAtCompileTime != 0,
+                      "Illegal static dimension");
+
+        set_standard();
+    }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~LeanGaussian() noexcept { }
+
+    /**
+     * \return Gaussian dimension
+     */
+    virtual int dimension() const
+    {
+        return StdGaussianMappingBase::standard_variate_dimension();
+    }
+
+    /**
+     * \return Gaussian first moment
+     */
+    virtual const Variate& mean() const
+    {
+        return mean_;
+    }
+
+    /**
+     * \return Covariance matrix, computed from the square root or the
+     *         precision if it has not been set
+     *
+     * \throws GaussianUninitializedException if the Gaussian is of dynamic-size
+     *         and has not been initialized using dimension(dimension).
+     */
+    virtual const SecondMoment& covariance() const
+    {
+        check_initialized();
+
+        if (!is_valid(CovarianceMatrix))
+        {
+            SecondMoment& covariance = slot(CovarianceMatrix);
+
+            if (is_valid(SquareRootMatrix))
+            {
+                const SecondMoment& square_root = slot(SquareRootMatrix);
+                covariance = square_root * square_root.transpose();
+            }
+            else
+            {
+                covariance = slot(PrecisionMatrix).inverse();
+            }
+
+            validate(CovarianceMatrix);
+        }
+
+        return slot(CovarianceMatrix);
+    }
+
+    /**
+     * \return Precision matrix, the inverse of the covariance
+     *
+     * \throws see covariance()
+     */
+    virtual const SecondMoment& precision() const
+    {
+        check_initialized();
+
+        if (!is_valid(PrecisionMatrix))
+        {
+            slot(PrecisionMatrix) = covariance().inverse();
+            validate(PrecisionMatrix);
+        }
+
+        return slot(PrecisionMatrix);
+    }
+
+    /**
+     * \return Square root of the covariance, the Cholesky factor unless the
+     *         square root has been set
+     *
+     * \throws see covariance()
+     */
+    virtual const SecondMoment& square_root() const
+    {
+        check_initialized();
+
+        if (!is_valid(SquareRootMatrix))
+        {
+            slot(SquareRootMatrix) = factorization().square_root();
+            validate(SquareRootMatrix);
+        }
+
+        return slot(SquareRootMatrix);
+    }
+
+    /**
+     * \return True if the covariance matrix has a full rank
+     *
+     * \throws see covariance()
+     */
+    virtual bool has_full_rank() const
+    {
+        if (!is_valid(Rank))
+        {
+            const auto pivots = factorization().pivots();
+            const Real threshold =
+                pivots.cwiseAbs().maxCoeff()
+                * Real(dimension())
+                * std::numeric_limits<Real>::epsilon();
+
+            full_rank_ = (pivots.array() > threshold).all();
+            validate(Rank);
+        }
+
+        return full_rank_;
+    }
+
+    /**
+     * \return Log normalizing constant
+     *
+     * \throws see has_full_rank()
+     */
+    virtual Real log_normalizer() const
+    {
+        if (!is_valid(Normalizer))
+        {
+            log_norm_ = 0.0;
+
+            if (has_full_rank())
+            {
+                log_norm_ =
+                    -0.5
+                    * (factorization().pivots().array().log().sum()
+                       + Real(dimension()) * std::log(2.0 * M_PI));
+            }
+
+            validate(Normalizer);
+        }
+
+        return log_norm_;
+    }
+
+    /**
+     * \return Covariance determinant
+     *
+     * \throws see covariance()
+     */
+    virtual Real covariance_determinant() const
+    {
+        if (!is_valid(Determinant))
+        {
+            determinant_ = factorization().pivots().prod();
+            validate(Determinant);
+        }
+
+        return determinant_;
+    }
+
+    /**
+     * \return Squared Mahalanobis distance of \a vector, see
+     *         Gaussian::squared_mahalanobis_distance()
+     *
+     * \throws see covariance()
+     */
+    virtual Real squared_mahalanobis_distance(const Variate& vector) const
+    {
+        Variate delta = vector - mean_;
+
+        return factorization().squared_norms(delta)(0);
+    }
+
+    /**
+     * \return Squared Mahalanobis distances of all \a points, one point per
+     *         column
+     *
+     * \throws see covariance()
+     */
+    virtual ValueArray squared_mahalanobis_distances(
+        const VariateMatrix& points) const
+    {
+        VariateMatrix deltas = points.colwise() - mean_;
+
+        return factorization().squared_norms(deltas).transpose();
+    }
+
+    /**
+     * \return Log of the probability of the given sample \c vector
+     *
+     * \throws see has_full_rank()
+     */
+    Real log_probability(const Variate& vector) const override
+    {
+        if (has_full_rank())
+        {
+            return log_normalizer()
+                   - 0.5 * squared_mahalanobis_distance(vector);
+        }
+
+        return -std::numeric_limits<Real>::infinity();
+    }
+
+    /**
+     * \return Log probabilities of all \a points, one point per column
+     *
+     * \throws see has_full_rank()
+     */
+    virtual ValueArray log_probabilities(const VariateMatrix& points) const
+    {
+        if (has_full_rank())
+        {
+            return log_normalizer()
+                   - 0.5 * squared_mahalanobis_distances(points);
+        }
+
+        return ValueArray::Constant(
+                    points.cols(), -std::numeric_limits<Real>::infinity());
+    }
+
+    /**
+     * \return A Gaussian sample determined by mapping a standard normal
+     *         \a sample into the Gaussian sample space
+     *
+     * \throws see square_root()
+     */
+    Variate map_standard_normal(const StandardVariate& sample) const override
+    {
+        return mean() + square_root() * sample;
+    }
+
+    /**
+     * Sets the Gaussian to a standard distribution with zero mean and identity
+     * covariance. All slots except the covariance are released.
+     */
+    virtual void set_standard()
+    {
+        release_derived_representations();
+
+        mean_ = Variate::Zero(dimension());
+        covariance(SecondMoment::Identity(dimension(), dimension()));
+    }
+
+    /**
+     * Changes the dimension of the dynamic-size Gaussian and sets it to a
+     * standard distribution with zero mean and identity covariance.
+     *
+     * \throws ResizingFixedSizeEntityException
+     */
+    virtual void dimension(int new_dimension)
+    {
+        StdGaussianMappingBase::standard_variate_dimension(new_dimension);
+        set_standard();
+    }
+
+    /**
+     * Sets the mean
+     *
+     * \throws WrongSizeException
+     */
+    virtual void mean(const Variate& mean)
+    {
+        if (mean_.size() != mean.size())
+        {
+            fl_throw(fl::WrongSizeException(mean.size(), mean_.size()));
+        }
+
+        mean_ = mean;
+    }
+
+    /**
+     * Sets the covariance matrix
+     *
+     * \throws WrongSizeException
+     */
+    virtual void covariance(const SecondMoment& covariance)
+    {
+        set_representation(CovarianceMatrix, covariance);
+    }
+
+    /**
+     * Sets the covariance matrix in the precision form
+     *
+     * \throws WrongSizeException
+     */
+    virtual void precision(const SecondMoment& precision)
+    {
+        set_representation(PrecisionMatrix, precision);
+    }
+
+    /**
+     * Sets the covariance matrix in the form of its square root
+     * \f$L\f$, \f$L L^T = \Sigma\f$
+     *
+     * \throws WrongSizeException
+     */
+    virtual void square_root(const SecondMoment& square_root)
+    {
+        set_representation(SquareRootMatrix, square_root);
+    }
+
+    /**
+     * Frees all representations and the factorization except for the
+     * representation that was set last. They are recomputed on the next
+     * request.
+     */
+    void release_derived_representations()
+    {
+        for (int i = 0; i < Representations; ++i)
+        {
+            if (i == active_) continue;
+
+            slots_[i].release();
+            valid_ &= ~flag(i);
+        }
+
+        factorization_.release();
+        valid_ &= ~flag(Factorization);
+    }
+
+    /**
+     * \return Number of allocated heap slots, i.e. representations and the
+     *         factorization, which currently occupy memory
+     */
+    int allocated_slots() const
+    {
+        int count = factorization_.allocated() ? 1 : 0;
+
+        for (int i = 0; i < Representations; ++i)
+        {
+            if (slots_[i].allocated()) ++count;
+        }
+
+        return count;
+    }
+
+protected:
+    /** \cond internal */
+    static unsigned flag(int attribute) noexcept
+    {
+        return 1u << attribute;
+    }
+
+    bool is_valid(Attribute attribute) const noexcept
+    {
+        return valid_ & flag(attribute);
+    }
+
+    void validate(Attribute attribute) const noexcept
+    {
+        valid_ |= flag(attribute);
+    }
+
+    SecondMoment& slot(Attribute representation) const
+    {
+        return slots_[representation].get();
+    }
+
+    void check_initialized() const
+    {
+        if (dimension() == 0)
+        {
+            fl_throw(GaussianUninitializedException());
+        }
+    }
+
+    /**
+     * Stores \a matrix as the only valid representation
+     */
+    void set_representation(Attribute representation,
+                            const SecondMoment& matrix)
+    {
+        if (matrix.rows() != dimension() || matrix.cols() != dimension())
+        {
+            fl_throw(fl::WrongSizeException(
+                         matrix.size(), dimension() * dimension()));
+        }
+
+        slot(representation) = matrix;
+        active_ = representation;
+        valid_ = flag(representation);
+    }
+
+    /**
+     * \return Factorization of the covariance, computed if it has changed
+     */
+    const CovarianceFactorization<SecondMoment>& factorization() const
+    {
+        if (!is_valid(Factorization))
+        {
+            factorization_.get().compute(covariance());
+            validate(Factorization);
+        }
+
+        return factorization_.get();
+    }
+    /** \endcond */
+
+protected:
+    /** \cond internal */
+    Variate mean_;                      /**< \brief first moment vector */
+    Attribute active_;                  /**< \brief representation set last */
+    mutable unsigned valid_;            /**< \brief valid attribute flags */
+    mutable bool full_rank_;            /**< \brief full rank flag */
+    mutable Real log_norm_;             /**< \brief log normalizing constant */
+    mutable Real determinant_;          /**< \brief determinant of covariance */
+
+    /** \brief lazily allocated representations indexed by Attribute */
+    internal::LazySlot<SecondMoment> slots_[Representations];
+
+    /** \brief lazily allocated covariance factorization */
+    internal::LazySlot<
+        CovarianceFactorization<SecondMoment>
+    > factorization_;
+    /** \endcond */
+};
+
+}
@@ -0,0 +1,594 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file low_rank_gaussian.hpp
+ * \date 2015
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include <fl/util/meta.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/util/math/linear_algebra.hpp>
+#include <fl/exception/exception.hpp>
+#include <fl/distribution/gaussian.hpp>
+#include <fl/distribution/interface/moments.hpp>
+#include <fl/distribution/interface/evaluation.hpp>
+#include <fl/distribution/interface/standard_gaussian_mapping.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup distributions
+ *
+ * \brief Gaussian \f${\cal N}(x; \mu, \Sigma)\f$ with a diagonal plus low-rank
+ *        covariance \f$ \Sigma = D + U U^T \f$
+ *
+ * \tparam Variate  Random variable type
+ * \tparam Rank     Number of columns \f$ k \f$ of the factor \f$ U \f$,
+ *                  Eigen::Dynamic by default
+ *
+ * \f$ D = diag(d_1, \ldots, d_n) \f$ is positive and \f$ U \f$ is an
+ * \f$ n \times k \f$ matrix with \f$ k \ll n \f$. Nothing of size
+ * \f$ n \times n \f$ is needed for sampling and evaluation:
+ *
+ *  - A sample is \f$ \mu + D^{1/2} z_1 + U z_2 \f$ with a standard normal
+ *    variate \f$ (z_1, z_2) \f$ of dimension \f$ n + k \f$, which costs
+ *    \f$ O(nk) \f$.
+ *  - The log probability uses the Woodbury identity
+ *    \f$ \Sigma^{-1} = D^{-1} - D^{-1} U C^{-1} U^T D^{-1} \f$ with the
+ *    \f$ k \times k \f$ capacitance \f$ C = I + U^T D^{-1} U \f$ and the
+ *    determinant lemma \f$ |\Sigma| = |D| |C| \f$. After an
+ *    \f$ O(nk^2) \f$ factorization of \f$ C \f$ each point costs
+ *    \f$ O(nk) \f$.
+ *
+ * The dense covariance, precision and square root are only formed on
+ * request, in \f$ O(n^2 k) \f$. The precision is obtained by smw_inverse(),
+ * the square root is the symmetric root
+ * \f$ D^{1/2} + U G U^T D^{-1/2} \f$ where \f$ G \f$ is a
+ * \f$ k \times k \f$ function of \f$ C \f$. The latter makes the distribution
+ * usable with the sigma point transforms, e.g. UnscentedTransform.
+ */
+template <typename Variate, int Rank = Eigen::Dynamic>
+class LowRankGaussian
+    : public Moments<Variate>,
+      public Evaluation<Variate>,
+      public StandardGaussianMapping<
+                Variate,
+                JoinSizes<SizeOf<Variate>::Value, Rank>::Value>
+{
+private:
+    typedef StandardGaussianMapping<
+                Variate,
+                JoinSizes<SizeOf<Variate>::Value, Rank>::Value
+            > StdGaussianMappingBase;
+
+public:
+    /**
+     * \brief Dense second moment matrix type
+     */
+    typedef typename Moments<Variate>::SecondMoment SecondMoment;
+
+    /**
+     * \brief Standard normal variate \f$ (z_1, z_2) \f$ of dimension
+     *        \f$ n + k \f$
+     */
+    typedef typename StdGaussianMappingBase::StandardVariate StandardVariate;
+
+    /**
+     * \brief Diagonal \f$ (d_1, \ldots, d_n) \f$ of \f$ D \f$
+     */
+    typedef Eigen::Matrix<Real, SizeOf<Variate>::Value, 1> DiagonalVector;
+
+    /**
+     * \brief Low-rank factor \f$ U \f$
+     */
+    typedef Eigen::Matrix<Real, SizeOf<Variate>::Value, Rank> LowRankFactor;
+
+    /**
+     * \brief Capacitance matrix \f$ C \f$ type
+     */
+    typedef Eigen::Matrix<Real, Rank, Rank> CapacitanceMatrix;
+
+    /**
+     * \brief Batch of variates, one variate per column
+     */
+    typedef typename Gaussian<Variate>::VariateMatrix VariateMatrix;
+
+    /**
+     * \brief Batch of scalar values, one value per variate of a
+     *        \c VariateMatrix
+     */
+    typedef typename Gaussian<Variate>::ValueArray ValueArray;
+
+protected:
+    /** \cond internal */
+    /**
+     * \enum Attribute
+     * Quantities derived from \f$ D \f$ and \f$ U \f$
+     */
+    enum Attribute
+    {
+        CovarianceMatrix = 0,   /**< Dense covariance */
+        PrecisionMatrix,        /**< Dense inverse of the covariance */
+        SquareRootMatrix,       /**< Dense square root */
+        Capacitance,            /**< Factorization of C and log. det. */
+
+        Attributes              /**< Total number of attribute */
+    };
+
+    typedef std::array<bool, Attributes> FlagArray;
+    /** \endcond */
+
+public:
+    /**
+     * Creates a dynamic or fixed size Gaussian with zero mean and identity
+     * covariance, i.e. \f$ D = I \f$ and \f$ U = 0 \f$.
+     *
+     * \param dim   Dimension \f$ n \f$. The default is defined by the
+     *              dimension of \c Variate, 0 for dynamic sizes.
+     * \param rank  Number of columns \f$ k \f$ of \f$ U \f$. The default is
+     *              \c Rank, 0 if it is dynamic.
+     */
+    explicit LowRankGaussian(int dim = DimensionOf<Variate>(),
+                             int rank = (Rank == Eigen::Dynamic ? 0 : Rank))
+        : StdGaussianMappingBase(dim + rank),
+          dimension_(dim),
+          rank_(rank)
+    {
+        static_assert(Variate::SizeAtCompileTime != 0,
+                      "Illegal static dimension");
+
+        set_standard();
+    }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~LowRankGaussian() noexcept { }
+
+    /**
+     * \return Gaussian dimension \f$ n \f$
+     */
+    virtual int dimension() const
+    {
+        return dimension_;
+    }
+
+    /**
+     * \return Number of columns \f$ k \f$ of the low-rank factor
+     */
+    virtual int rank() const
+    {
+        return rank_;
+    }
+
+    /**
+     * \return Gaussian first moment
+     */
+    virtual const Variate& mean() const
+    {
+        return mean_;
+    }
+
+    /**
+     * \return Diagonal \f$ (d_1, \ldots, d_n) \f$ of \f$ D \f$
+     */
+    virtual const DiagonalVector& diagonal() const
+    {
+        return diagonal_;
+    }
+
+    /**
+     * \return Low-rank factor \f$ U \f$
+     */
+    virtual const LowRankFactor& low_rank_factor() const
+    {
+        return factor_;
+    }
+
+    /**
+     * \return Dense covariance \f$ D + U U^T \f$, formed in \f$ O(n^2 k) \f$
+     *
+     * \throws GaussianUninitializedException if the Gaussian is of dynamic-size
+     *         and has not been initialized
+     */
+    virtual const SecondMoment& covariance() const
+    {
+        check_initialized();
+
+        if (is_dirty(CovarianceMatrix))
+        {
+            covariance_.noalias() = factor_ * factor_.transpose();
+            covariance_.diagonal() += diagonal_;
+
+            updated_internally(CovarianceMatrix);
+        }
+
+        return covariance_;
+    }
+
+    /**
+     * \return Dense precision
+     *         \f$ D^{-1} - D^{-1} U C^{-1} U^T D^{-1} \f$ obtained by
+     *         smw_inverse() of the augmented matrix
+     *         \f$ \begin{pmatrix} D & U \\ U^T & -I \end{pmatrix} \f$
+     *         whose upper left inverse block is \f$ \Sigma^{-1} \f$
+     *
+     * \throws see covariance()
+     */
+    virtual const SecondMoment& precision() const
+    {
+        check_initialized();
+
+        if (is_dirty(PrecisionMatrix))
+        {
+            if (rank_ == 0)
+            {
+                precision_ = diagonal_.cwiseInverse().asDiagonal();
+            }
+            else
+            {
+                SecondMoment inv_diagonal =
+                    diagonal_.cwiseInverse().asDiagonal();
+                LowRankFactor L_B;
+                Eigen::Matrix<Real, Rank, SizeOf<Variate>::Value> L_C;
+                CapacitanceMatrix L_D;
+
+                smw_inverse(inv_diagonal,
+                            factor_,
+                            factor_.transpose(),
+                            -CapacitanceMatrix::Identity(rank_, rank_),
+                            precision_, L_B, L_C, L_D);
+            }
+
+            updated_internally(PrecisionMatrix);
+        }
+
+        return precision_;
+    }
+
+    /**
+     * \return Dense square root
+     *         \f$ S = D^{1/2} + U G U^T D^{-1/2} \f$, \f$ S S^T = \Sigma \f$,
+     *         formed in \f$ O(n^2 k) \f$
+     *
+     * With the eigendecomposition \f$ C - I = E \Lambda E^T \f$,
+     * \f$ G = E\,diag(1 / (1 + \sqrt{1 + \lambda_i}))\,E^T \f$.
+     *
+     * \throws see covariance()
+     */
+    virtual const SecondMoment& square_root() const
+    {
+        check_initialized();
+
+        if (is_dirty(SquareRootMatrix))
+        {
+            square_root_ = diagonal_.cwiseSqrt().asDiagonal();
+
+            if (rank_ > 0)
+            {
+                capacitance();
+
+                Eigen::SelfAdjointEigenSolver<CapacitanceMatrix> eigen(
+                    scaled_factor_.transpose() * factor_);
+
+                const CapacitanceMatrix G =
+                    eigen.eigenvectors()
+                    * ((eigen.eigenvalues().cwiseMax(Real(0)).array() + 1)
+                           .sqrt() + 1).inverse().matrix().asDiagonal()
+                    * eigen.eigenvectors().transpose();
+
+                square_root_.noalias() +=
+                    factor_ * G
+                    * (factor_.transpose()
+                       * diagonal_.cwiseSqrt().cwiseInverse().asDiagonal());
+            }
+
+            updated_internally(SquareRootMatrix);
+        }
+
+        return square_root_;
+    }
+
+    /**
+     * \return True if the covariance has full rank, i.e. all diagonal
+     *         entries \f$ d_i \f$ are positive
+     */
+    virtual bool has_full_rank() const
+    {
+        return (diagonal_.array() > Real(0)).all();
+    }
+
+    /**
+     * \return Log normalizing constant
+     *         \f$ -\frac{1}{2}(\log|D| + \log|C| + n \log 2\pi) \f$
+     */
+    virtual Real log_normalizer() const
+    {
+        if (!has_full_rank()) return 0.0; // FIXME as in Gaussian
+
+        capacitance();
+
+        return -0.5 * (log_determinant_
+                       + Real(dimension_) * std::log(2.0 * M_PI));
+    }
+
+    /**
+     * \return Covariance determinant \f$ |D| |C| \f$
+     */
+    virtual Real covariance_determinant() const
+    {
+        if (!has_full_rank()) return diagonal_.prod();
+
+        capacitance();
+
+        return std::exp(log_determinant_);
+    }
+
+    /**
+     * \return Squared Mahalanobis distance of \a vector by the Woodbury
+     *         identity in \f$ O(nk) \f$
+     */
+    virtual Real squared_mahalanobis_distance(const Variate& vector) const
+    {
+        Variate delta = vector - mean_;
+
+        return squared_mahalanobis_terms(delta)(0);
+    }
+
+    /**
+     * \return Squared Mahalanobis distances of all \a points, one point per
+     *         column
+     */
+    virtual ValueArray squared_mahalanobis_distances(
+        const VariateMatrix& points) const
+    {
+        VariateMatrix deltas = points.colwise() - mean_;
+
+        return squared_mahalanobis_terms(deltas).transpose();
+    }
+
+    /**
+     * \return Log of the probability of the given sample \c vector
+     */
+    Real log_probability(const Variate& vector) const override
+    {
+        if (has_full_rank())
+        {
+            return log_normalizer()
+                   - 0.5 * squared_mahalanobis_distance(vector);
+        }
+
+        return -std::numeric_limits<Real>::infinity();
+    }
+
+    /**
+     * \return Log probabilities of all \a points, one point per column
+     */
+    virtual ValueArray log_probabilities(const VariateMatrix& points) const
+    {
+        if (has_full_rank())
+        {
+            return log_normalizer()
+                   - 0.5 * squared_mahalanobis_distances(points);
+        }
+
+        return ValueArray::Constant(
+                    points.cols(), -std::numeric_limits<Real>::infinity());
+    }
+
+    /**
+     * \return The sample \f$ \mu + D^{1/2} z_1 + U z_2 \f$ of the standard
+     *         normal \a sample \f$ (z_1, z_2) \f$ in \f$ O(nk) \f$
+     */
+    Variate map_standard_normal(const StandardVariate& sample) const override
+    {
+        assert(sample.size() == dimension_ + rank_);
+
+        Variate v = mean_;
+        v += diagonal_.cwiseSqrt().cwiseProduct(sample.topRows(dimension_));
+        v.noalias() += factor_ * sample.bottomRows(rank_);
+
+        return v;
+    }
+
+    /**
+     * Sets the Gaussian to a standard distribution with zero mean,
+     * \f$ D = I \f$ and \f$ U = 0 \f$.
+     */
+    virtual void set_standard()
+    {
+        mean_ = Variate::Zero(dimension_);
+        diagonal_ = DiagonalVector::Ones(dimension_);
+        factor_ = LowRankFactor::Zero(dimension_, rank_);
+
+        updated_externally();
+    }
+
+    /**
+     * Changes the dimension and the rank of the dynamic-size Gaussian and
+     * sets it to a standard distribution.
+     *
+     * \throws ResizingFixedSizeEntityException
+     */
+    virtual void dimension(int new_dimension, int new_rank)
+    {
+        StdGaussianMappingBase::standard_variate_dimension(
+            new_dimension + new_rank);
+
+        dimension_ = new_dimension;
+        rank_ = new_rank;
+        set_standard();
+    }
+
+    /**
+     * Changes the dimension of the dynamic-size Gaussian keeping its rank
+     */
+    virtual void dimension(int new_dimension)
+    {
+        dimension(new_dimension, rank_);
+    }
+
+    /**
+     * Sets the mean
+     *
+     * \throws WrongSizeException
+     */
+    virtual void mean(const Variate& mean)
+    {
+        if (mean_.size() != mean.size())
+        {
+            fl_throw(fl::WrongSizeException(mean.size(), mean_.size()));
+        }
+
+        mean_ = mean;
+    }
+
+    /**
+     * Sets the covariance \f$ D + U U^T \f$. The number of columns of
+     * \a factor may differ from the current rank if \c Rank is dynamic.
+     *
+     * \param diagonal  Positive diagonal \f$ (d_1, \ldots, d_n) \f$
+     * \param factor    Low-rank factor \f$ U \f$
+     *
+     * \throws WrongSizeException
+     */
+    virtual void covariance(const DiagonalVector& diagonal,
+                            const LowRankFactor& factor)
+    {
+        if (diagonal.size() != dimension_)
+        {
+            fl_throw(fl::WrongSizeException(diagonal.size(), dimension_));
+        }
+
+        if (factor.rows() != dimension_)
+        {
+            fl_throw(fl::WrongSizeException(factor.rows(), dimension_));
+        }
+
+        if (factor.cols() != rank_)
+        {
+            StdGaussianMappingBase::standard_variate_dimension(
+                dimension_ + factor.cols());
+            rank_ = factor.cols();
+        }
+
+        diagonal_ = diagonal;
+        factor_ = factor;
+
+        updated_externally();
+    }
+
+protected:
+    /** \cond internal */
+    void check_initialized() const
+    {
+        if (dimension_ == 0)
+        {
+            fl_throw(GaussianUninitializedException());
+        }
+    }
+
+    void updated_externally() const noexcept
+    {
+        std::fill(dirty_.begin(), dirty_.end(), true);
+    }
+
+    void updated_internally(Attribute attribute) const noexcept
+    {
+        dirty_[attribute] = false;
+    }
+
+    bool is_dirty(Attribute attribute) const noexcept
+    {
+        return dirty_[attribute];
+    }
+
+    /**
+     * Computes \f$ D^{-1} U \f$, the Cholesky decomposition of the
+     * capacitance \f$ C = I + U^T D^{-1} U \f$ and \f$ \log|\Sigma| \f$ in
+     * \f$ O(nk^2) \f$ if \f$ D \f$ or \f$ U \f$ have changed
+     */
+    void capacitance() const
+    {
+        if (!is_dirty(Capacitance)) return;
+
+        scaled_factor_ = diagonal_.cwiseInverse().asDiagonal() * factor_;
+
+        CapacitanceMatrix C = factor_.transpose() * scaled_factor_;
+        C.diagonal().array() += Real(1);
+        capacitance_.compute(C);
+
+        log_determinant_ =
+            diagonal_.array().log().sum()
+            + 2 * capacitance_.matrixLLT().diagonal().array().log().sum();
+
+        updated_internally(Capacitance);
+    }
+
+    /**
+     * \return \f$ \delta^T \Sigma^{-1} \delta \f$ of all columns of
+     *         \a deltas, which is not modified, by the Woodbury identity
+     *         \f$ \delta^T D^{-1} \delta - \|L_C^{-1} U^T D^{-1} \delta\|^2 \f$
+     */
+    template <typename Deltas>
+    Eigen::Array<Real, 1, Deltas::ColsAtCompileTime>
+    squared_mahalanobis_terms(const Deltas& deltas) const
+    {
+        Eigen::Array<Real, 1, Deltas::ColsAtCompileTime> terms =
+            (diagonal_.cwiseInverse().transpose() * deltas.cwiseAbs2())
+                .array();
+
+        if (rank_ == 0) return terms;
+
+        capacitance();
+
+        Eigen::Matrix<Real, Rank, Deltas::ColsAtCompileTime> projected =
+            scaled_factor_.transpose() * deltas;
+        capacitance_.matrixL().solveInPlace(projected);
+
+        return terms - projected.colwise().squaredNorm().array();
+    }
+    /** \endcond */
+
+protected:
+    /** \cond internal */
+    int dimension_;                      /**< \brief dimension n */
+    int rank_;                           /**< \brief columns k of U */
+    Variate mean_;                       /**< \brief first moment vector */
+    DiagonalVector diagonal_;            /**< \brief diagonal of D */
+    LowRankFactor factor_;               /**< \brief low-rank factor U */
+
+    mutable LowRankFactor scaled_factor_; /**< \brief \f$ D^{-1} U \f$ */
+    mutable Eigen::LLT<CapacitanceMatrix> capacitance_;
+    mutable Real log_determinant_;       /**< \brief \f$ \log|\Sigma| \f$ */
+
+    mutable SecondMoment covariance_;    /**< \brief dense cov. on request */
+    mutable SecondMoment precision_;     /**< \brief dense inv. on request */
+    mutable SecondMoment square_root_;   /**< \brief dense root on request */
+    mutable FlagArray dirty_;            /**< \brief data validity flags */
+    /** \endcond */
+};
+
+}
@@ -0,0 +1,292 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file rao_blackwellized_distribution.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Core>
+
+#include <fl/util/types.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/distribution/gaussian.hpp>
+#include <fl/distribution/discrete_distribution.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup distributions
+ *
+ * \brief Weighted particle set over \a Variate where each particle
+ *        additionally carries a Gaussian belief over \a SubVariate.
+ *
+ * This is the belief of the RaoBlackwellizedParticleFilter. The particles
+ * \f$x_i\f$ and their weights are managed by the underlying
+ * DiscreteDistribution. The Gaussian sub beliefs
+ * \f${\cal N}(z \mid \mu_i, \Sigma)\f$ are stored as a matrix of means
+ * \f$[\mu_1, \ldots, \mu_N]\f$, one column per particle, and a single
+ * conditional covariance \f$\Sigma\f$. The covariance is shared because the
+ * Kalman recursion of the sub state does not depend on the particle.
+ * Storing the means contiguously allows updating all of them by a single
+ * matrix product.
+ */
+template <typename Variate, typename SubVariate>
+class RaoBlackwellizedDistribution
+    : public DiscreteDistribution<Variate>
+{
+private:
+    /** \cond internal */
+    typedef DiscreteDistribution<Variate> Base;
+    /** \endcond */
+
+public:
+    typedef Gaussian<SubVariate> SubBelief;
+    typedef typename SubBelief::SecondMoment SubCovariance;
+
+    /**
+     * \brief Means of the sub beliefs, one column per particle
+     */
+    typedef Eigen::Matrix<
+                typename SubVariate::Scalar,
+                SizeOf<SubVariate>::Value,
+                Eigen::Dynamic
+            > SubMeans;
+
+public:
+    /**
+     * \param size           Number of particles
+     * \param sub_dimension  Dimension of the sub state
+     */
+    explicit
+    RaoBlackwellizedDistribution(int size = 1,
+                                 int sub_dimension = DimensionOf<SubVariate>())
+        : Base(size),
+          sub_means_(SubMeans::Zero(sub_dimension, size)),
+          conditional_sub_covariance_(
+              SubCovariance::Identity(sub_dimension, sub_dimension))
+    { }
+
+    virtual ~RaoBlackwellizedDistribution() noexcept { }
+
+    /**
+     * \copydoc DiscreteDistribution::log_unnormalized_prob_mass
+     *
+     * The sub means follow the number of particles, see set_uniform().
+     */
+    virtual void log_unnormalized_prob_mass(
+        const typename Base::Function& log_prob_mass)
+    {
+        resize_sub_means(log_prob_mass.size());
+        Base::log_unnormalized_prob_mass(log_prob_mass);
+    }
+
+    /**
+     * \copydoc DiscreteDistribution::delta_log_prob_mass
+     */
+    virtual void delta_log_prob_mass(const typename Base::Function& delta)
+    {
+        resize_sub_means(delta.size());
+        Base::delta_log_prob_mass(delta);
+    }
+
+    /**
+     * \brief Sets uniform weights over \a new_size particles. Particles
+     *        added at the end carry the sub mean of the current sub state
+     *        marginal, removed particles drop their sub means.
+     */
+    virtual void set_uniform(int new_size = -1)
+    {
+        if (new_size == -1) new_size = this->size();
+
+        resize_sub_means(new_size);
+        Base::set_uniform(new_size);
+    }
+
+    /**
+     * \brief Samples the particles from \a distribution. The sub belief of
+     *        every new particle is the Gaussian matching the moments of the
+     *        current sub state marginal, i.e. sub_mean() and
+     *        sub_covariance().
+     */
+    template <typename Distribution>
+    void from_distribution(const Distribution& distribution,
+                           const int& new_size)
+    {
+        const SubVariate mean = sub_mean();
+        const SubCovariance covariance = sub_covariance();
+
+        Base::from_distribution(distribution, new_size);
+
+        sub_means_.resize(sub_dimension(), new_size);
+        sub_means_.colwise() = mean;
+        conditional_sub_covariance_ = covariance;
+    }
+
+    /**
+     * \brief Resamples the particles of \a distribution along with their sub
+     *        beliefs using the given resampling policy.
+     *
+     * \param distribution   Source distribution. May be \c *this.
+     * \param new_size       Number of resampled particles
+     * \param resampling     Resampling policy
+     */
+    template <typename Resampling>
+    void from_distribution(const RaoBlackwellizedDistribution& distribution,
+                           const int& new_size,
+                           const Resampling& resampling)
+    {
+        this->resampled_indices_.resize(new_size);
+        resampling(distribution.cumulative_distribution(),
+                   this->resampled_indices_);
+
+        // the source must remain intact while gathering, see
+        // DiscreteDistribution::from_distribution
+        this->resampled_locations_.resize(new_size);
+        resampled_sub_means_.resize(distribution.sub_dimension(), new_size);
+
+        for(int i = 0; i < new_size; i++)
+        {
+            const int index = this->resampled_indices_[i];
+
+            this->resampled_locations_[i] = distribution.location(index);
+            resampled_sub_means_.col(i) = distribution.sub_means_.col(index);
+        }
+
+        this->locations_.swap(this->resampled_locations_);
+        sub_means_.swap(resampled_sub_means_);
+        conditional_sub_covariance_ = distribution.conditional_sub_covariance_;
+
+        this->set_uniform(new_size);
+    }
+
+    /**
+     * \brief Sets the sub belief of every particle to \a sub_belief
+     */
+    void sub_belief(const SubBelief& sub_belief)
+    {
+        sub_means_.resize(sub_belief.dimension(), this->size());
+        sub_means_.colwise() = sub_belief.mean();
+        conditional_sub_covariance_ = sub_belief.covariance();
+    }
+
+    /**
+     * \return Gaussian sub belief of the i-th particle
+     */
+    SubBelief sub_belief(int i) const
+    {
+        SubBelief belief(sub_dimension());
+        belief.mean(sub_means_.col(i));
+        belief.covariance(conditional_sub_covariance_);
+        return belief;
+    }
+
+    SubMeans& sub_means()
+    {
+        return sub_means_;
+    }
+
+    const SubMeans& sub_means() const
+    {
+        return sub_means_;
+    }
+
+    /**
+     * \return Covariance \f$\Sigma\f$ shared by all sub beliefs
+     */
+    const SubCovariance& conditional_sub_covariance() const
+    {
+        return conditional_sub_covariance_;
+    }
+
+    void conditional_sub_covariance(const SubCovariance& covariance)
+    {
+        conditional_sub_covariance_ = covariance;
+    }
+
+    int sub_dimension() const
+    {
+        return sub_means_.rows();
+    }
+
+    /**
+     * \return Mean \f$\sum_i w_i \mu_i\f$ of the sub state marginal
+     */
+    const SubVariate& sub_mean() const
+    {
+        sub_mean_.noalias() = sub_means_ * this->prob_mass_.matrix();
+
+        return sub_mean_;
+    }
+
+    /**
+     * \return Covariance of the sub state marginal, i.e. the shared
+     *         conditional covariance plus the spread of the means
+     */
+    const SubCovariance& sub_covariance() const
+    {
+        const SubVariate& mean = sub_mean();
+
+        sub_cov_ = conditional_sub_covariance_;
+        for(int i = 0; i < sub_means_.cols(); i++)
+        {
+            const SubVariate delta = sub_means_.col(i) - mean;
+            sub_cov_ += this->prob_mass_(i) * delta * delta.transpose();
+        }
+
+        return sub_cov_;
+    }
+
+protected:
+    /** \cond internal */
+    /**
+     * \brief Keeps one sub mean per particle when the number of particles
+     *        changes to \a new_size. Must be called while the weights still
+     *        refer to the current particles.
+     */
+    void resize_sub_means(int new_size)
+    {
+        const int size = sub_means_.cols();
+        if (new_size == size) return;
+
+        if (new_size < size)
+        {
+            sub_means_.conservativeResize(Eigen::NoChange, new_size);
+            return;
+        }
+
+        const SubVariate mean = sub_mean();
+        sub_means_.conservativeResize(Eigen::NoChange, new_size);
+        sub_means_.rightCols(new_size - size).colwise() = mean;
+    }
+    /** \endcond */
+
+protected:
+    /** \cond internal */
+    SubMeans sub_means_;
+    SubCovariance conditional_sub_covariance_;
+
+    mutable SubVariate sub_mean_;
+    mutable SubCovariance sub_cov_;
+
+    /* resampling buffer, see from_distribution(distribution, size, resampling) */
+    SubMeans resampled_sub_means_;
+    /** \endcond */
+};
+
+}
@@ -84,6 +84,27 @@ public:
         return gaussian_sample;
     }
 
+    /**
+     * \brief Fills each column of the preallocated \a samples with one
+     *        standard normal sample. The columns are drawn in order, i.e.
+     *        the result equals calling sample() once per column.
+     */
+    template <typename Samples>
+    void sample(const Eigen::MatrixBase<Samples>& samples) const
+    {
+        auto& block = const_cast<Eigen::MatrixBase<Samples>&>(samples);
+
+        assert(block.rows() == dimension_);
+
+        for (int j = 0; j < block.cols(); j++)
+        {
+            for (int i = 0; i < dimension_; i++)
+            {
+                block(i, j) = gaussian_distribution_(generator_);
+            }
+        }
+    }
+
     virtual int dimension() const
     {
         return dimension_;
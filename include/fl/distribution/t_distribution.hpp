@@ -74,6 +74,17 @@ public:
      */
     typedef typename StdGaussianMappingBase::StandardVariate StandardVariate;
 
+    /**
+     * \brief Batch of variates, one variate per column
+     */
+    typedef typename Gaussian<Variate>::VariateMatrix VariateMatrix;
+
+    /**
+     * \brief Batch of scalar values, one value per variate of a
+     *        \c VariateMatrix
+     */
+    typedef typename Gaussian<Variate>::ValueArray ValueArray;
+
 public:
     /**
      * \brief Creates a dynamic or fixed size t-distribution.
@@ -150,6 +161,20 @@ public:
         return cached_log_pdf_.log_probability(*this, x);
     }
 
+    /**
+     * \brief Returns the log. probabilities of all \a points, one point per
+     *        column
+     *
+     * The Mahalanobis terms of all points are obtained by a single
+     * triangular solve with the Cholesky factor of the scaling matrix.
+     *
+     * \throws See Gaussian<Variate>::squared_mahalanobis_distances()
+     */
+    virtual ValueArray log_probabilities(const VariateMatrix& points) const
+    {
+        return cached_log_pdf_.log_probabilities(*this, points);
+    }
+
     /**
      * \brief Returns the Gaussian variate dimension
      */
@@ -279,15 +304,32 @@ private:
         {
             if (dirty_) update(t_distr);
 
-            Variate z = x - t_distr.location();
             Real dof = t_distr.degrees_of_freedom();
 
-            Real quad_term = (z.transpose() * t_distr.normal_.precision() * z);
+            Real quad_term = t_distr.normal_.squared_mahalanobis_distance(x);
             Real ln_term = std::log(Real(1) + quad_term  / dof);
 
             return const_term_ - const_factor_ * ln_term;
         }
 
+        /**
+         * Evaluates the t-distribution pdf at all \c points
+         */
+        ValueArray log_probabilities(
+                const TDistribution<Variate>& t_distr,
+                const VariateMatrix& points)
+        {
+            if (dirty_) update(t_distr);
+
+            Real dof = t_distr.degrees_of_freedom();
+
+            ValueArray quad_terms =
+                t_distr.normal_.squared_mahalanobis_distances(points);
+
+            return const_term_
+                   - const_factor_ * (Real(1) + quad_terms / dof).log();
+        }
+
         void flag_dirty() { dirty_ = true; }
 
     private:
@@ -0,0 +1,222 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file weighted_moments.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Core>
+
+#include <cmath>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#include <fl/util/types.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/util/thread_pool.hpp>
+
+namespace fl
+{
+
+/**
+ * \internal
+ */
+namespace internal
+{
+
+/**
+ * \internal
+ * \ingroup distributions
+ *
+ * \brief Cached weighted mean and covariance of a set of locations,
+ *        computed in a single blocked pass.
+ *
+ * The locations \f$x_i\f$ are shifted by the first location \f$x_0\f$,
+ * which keeps the one-pass formula numerically sound if the spread is
+ * small compared to the magnitude of the locations. Blocks of Block
+ * locations are gathered into a matrix
+ * \f$X = [\sqrt{w_i}(x_i - x_0)]\f$. Each block contributes \f$X \sqrt{w}\f$
+ * to the first moment and the symmetric rank-k update \f$X X^T\f$ to the
+ * second moment. The covariance is then
+ *
+ * \f[ \Sigma = \sum_i w_i (x_i - x_0)(x_i - x_0)^T - \delta \delta^T,
+ *     \quad \delta = \mu - x_0 \f]
+ *
+ * If a ThreadPool is passed, each chunk of locations accumulates its own
+ * partial moments. The partial moments are reduced in chunk order, hence
+ * the result does not depend on the thread scheduling.
+ *
+ * The cache is invalidated by invalidate() which may be called concurrently,
+ * e.g. while the locations are written by several threads.
+ */
+template <typename Mean, typename Covariance>
+class WeightedMoments
+{
+public:
+    /**
+     * \brief Number of locations gathered per block
+     */
+    enum : int { Block = 128 };
+
+    WeightedMoments()
+        : outdated_(true)
+    { }
+
+    WeightedMoments(const WeightedMoments& other)
+        : mean_(other.mean_),
+          covariance_(other.covariance_),
+          outdated_(other.outdated())
+    { }
+
+    WeightedMoments& operator=(const WeightedMoments& other)
+    {
+        mean_ = other.mean_;
+        covariance_ = other.covariance_;
+        outdated_.store(other.outdated(), std::memory_order_relaxed);
+
+        return *this;
+    }
+
+    void invalidate()
+    {
+        outdated_.store(true, std::memory_order_relaxed);
+    }
+
+    bool outdated() const
+    {
+        return outdated_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Computes the moments of the \a weights.size() locations
+     *        \c location(i) with the normalized \a weights
+     *
+     * \param dimension    Dimension of the locations
+     * \param weights      Normalized weights
+     * \param location     Functor returning the i-th location
+     * \param thread_pool  Optional pool distributing the locations
+     */
+    template <typename Weights, typename Location>
+    void compute(int dimension,
+                 const Weights& weights,
+                 const Location& location,
+                 ThreadPool* thread_pool = nullptr)
+    {
+        const int size = weights.size();
+        const int chunks = thread_pool ? thread_pool->threads() : 1;
+
+        if (size == 0)
+        {
+            mean_.setZero(dimension);
+            covariance_.setZero(dimension, dimension);
+            outdated_.store(false, std::memory_order_relaxed);
+            return;
+        }
+
+        shift_ = location(0).template cast<Real>();
+
+        deltas_.resize(chunks);
+        second_moments_.resize(chunks);
+        blocks_.resize(chunks);
+
+        auto kernel = [&](int chunk, int begin, int end)
+        {
+            Mean& delta = deltas_[chunk];
+            Covariance& second_moment = second_moments_[chunk];
+            BlockMatrix& block = blocks_[chunk];
+
+            delta.setZero(dimension);
+            second_moment.setZero(dimension, dimension);
+            block.resize(dimension, int(Block));
+
+            for (int b = begin; b < end; b += Block)
+            {
+                const int length = std::min(int(Block), end - b);
+
+                for (int j = 0; j < length; ++j)
+                {
+                    const Real w = weights(b + j);
+
+                    block.col(j) = location(b + j).template cast<Real>();
+                    block.col(j) -= shift_;
+                    delta.noalias() += w * block.col(j);
+                    block.col(j) *= std::sqrt(w);
+                }
+
+                second_moment.template selfadjointView<Eigen::Lower>()
+                    .rankUpdate(block.leftCols(length));
+            }
+        };
+
+        if (thread_pool)
+        {
+            thread_pool->parallel_for(size, kernel);
+        }
+        else
+        {
+            kernel(0, 0, size);
+        }
+
+        for (int chunk = 1; chunk < chunks; ++chunk)
+        {
+            deltas_[0] += deltas_[chunk];
+            second_moments_[0] += second_moments_[chunk];
+        }
+
+        mean_ = shift_ + deltas_[0];
+        covariance_ =
+            second_moments_[0].template selfadjointView<Eigen::Lower>();
+        covariance_.noalias() -= deltas_[0] * deltas_[0].transpose();
+
+        outdated_.store(false, std::memory_order_relaxed);
+    }
+
+    const Mean& mean() const
+    {
+        return mean_;
+    }
+
+    const Covariance& covariance() const
+    {
+        return covariance_;
+    }
+
+protected:
+    /** \cond internal */
+    typedef Eigen::Matrix<
+                Real, Mean::RowsAtCompileTime, Eigen::Dynamic
+            > BlockMatrix;
+
+    Mean mean_;
+    Covariance covariance_;
+    std::atomic<bool> outdated_;
+
+    /* buffers, one per chunk */
+    Mean shift_;
+    std::vector<Mean, Eigen::aligned_allocator<Mean>> deltas_;
+    std::vector<
+        Covariance, Eigen::aligned_allocator<Covariance>
+    > second_moments_;
+    std::vector<BlockMatrix> blocks_;
+    /** \endcond */
+};
+
+}
+
+}
@@ -20,6 +20,10 @@
 #pragma once
 
 
+#include <Eigen/Core>
+
+#include <vector>
+
 #include <fl/util/traits.hpp>
 #include <fl/util/descriptor.hpp>
 
@@ -89,6 +93,11 @@ public:
      */
     typedef typename Traits<Derived>::Belief Belief;
 
+    /**
+     * \brief Sequence of observations, see batch_update()
+     */
+    typedef std::vector<Obsrv, Eigen::aligned_allocator<Obsrv>> Obsrvs;
+
     /**
      * Predicts the distribution over the state for the next time step
      *
@@ -110,6 +119,29 @@ public:
     virtual void update(const Belief& predicted_belief,
                         const Obsrv& obsrv,
                         Belief& posterior_belief) = 0;
+
+    /**
+     * Updates a predicted state given all observations which arrived since
+     * the last prediction. By default, the observations are incorporated
+     * one after another by update(). Filters which are able to fuse the
+     * observations in a single pass override this.
+     *
+     * \param predicted_belief    Predicted state distribution
+     * \param obsrvs              Observations in the order of arrival
+     * \param posterior_belief    Updated posterior state distribution
+     */
+    virtual void batch_update(const Belief& predicted_belief,
+                              const Obsrvs& obsrvs,
+                              Belief& posterior_belief)
+    {
+        posterior_belief = predicted_belief;
+
+        for (const Obsrv& obsrv : obsrvs)
+        {
+            const Belief belief = posterior_belief;
+            update(belief, obsrv, posterior_belief);
+        }
+    }
 };
 
 }
@@ -0,0 +1,409 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file batch_gaussian_filter.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Core>
+
+#include <string>
+#include <algorithm>
+
+#include <fl/util/types.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/util/descriptor.hpp>
+#include <fl/distribution/gaussian_batch.hpp>
+
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup linear_gaussian_filter
+ *
+ * \brief Runs a batch of independent Kalman filters sharing the same linear
+ *        models at once.
+ *
+ * The beliefs are stored in a GaussianBatch, i.e. in a structure of arrays
+ * layout with one column per filter. Each step of the Kalman recursion is
+ * expressed element by element of the small per-filter matrices, where each
+ * element operation is a vectorized operation on a contiguous row spanning
+ * all filters. Zero elements of the dynamics and sensor matrices are
+ * skipped. In contrast to running one GaussianFilter per belief, there are
+ * no virtual calls, no representation flags and no per-filter temporaries.
+ * The batch is processed in chunks of Chunk filters such that the
+ * intermediate rows of a chunk remain in cache.
+ *
+ * The update whitens with the Cholesky factor \f$S = L L^T\f$ of the
+ * innovation covariance, which is computed for all filters at once by the
+ * same element-wise recursion. With \f$\tilde{C} = \bar{\Sigma} H^T L^{-T}\f$
+ * and \f$\tilde{e} = L^{-1}(y - H \bar{x})\f$, the posterior is
+ *
+ * \f$ \hat{x} = \bar{x} + \tilde{C} \tilde{e}\f$ and
+ * \f$ \hat{\Sigma} = \bar{\Sigma} - \tilde{C} \tilde{C}^T \f$.
+ */
+template <typename LinearTransition, typename LinearSensor>
+class BatchGaussianFilter
+    : public Descriptor
+{
+public:
+    typedef typename LinearTransition::State State;
+    typedef typename LinearTransition::Input Input;
+    typedef typename LinearSensor::Obsrv Obsrv;
+
+    typedef GaussianBatch<State> Belief;
+    typedef typename Belief::BatchMatrix BatchMatrix;
+
+    /**
+     * \brief Number of filters processed at once. The buffers of a chunk
+     *        remain in cache.
+     */
+    enum : int { Chunk = 256 };
+
+public:
+    BatchGaussianFilter(const LinearTransition& transition,
+                        const LinearSensor& sensor)
+        : transition_(transition),
+          sensor_(sensor)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~BatchGaussianFilter() noexcept { }
+
+    /**
+     * \brief Predicts all beliefs without input
+     */
+    void predict(Belief& belief)
+    {
+        predict_batch(belief, static_cast<const BatchMatrix*>(nullptr));
+    }
+
+    /**
+     * \brief Predicts all beliefs
+     *
+     * \param belief  Batch of beliefs, predicted in place
+     * \param inputs  Inputs, one column per filter. A row-major matrix
+     *                avoids strided accesses.
+     */
+    template <typename Inputs>
+    void predict(Belief& belief, const Inputs& inputs)
+    {
+        predict_batch(belief, &inputs);
+    }
+
+    /**
+     * \brief Updates all beliefs
+     *
+     * \param belief  Batch of beliefs, updated in place
+     * \param y       Observations, one column per filter. A row-major matrix
+     *                avoids strided accesses.
+     */
+    template <typename Obsrvs>
+    void update(Belief& belief, const Obsrvs& y)
+    {
+        for (int c = 0; c < belief.size(); c += Chunk)
+        {
+            const int width = std::min(int(Chunk), belief.size() - c);
+
+            update_chunk(belief.means().middleCols(c, width),
+                         belief.covariances().middleCols(c, width),
+                         y.middleCols(c, width));
+        }
+    }
+
+    /**
+     * \return A batch of \a size standard Gaussian beliefs
+     */
+    Belief create_belief(int size) const
+    {
+        return Belief(size, transition_.state_dimension());
+    }
+
+    virtual std::string name() const
+    {
+        return "BatchGaussianFilter<"
+                + list_arguments(transition().name(), sensor().name())
+                + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Batch of linear Gaussian filters (Kalman filters) with"
+                + list_descriptions(transition().description(),
+                                    sensor().description());
+    }
+
+    LinearTransition& transition()
+    {
+        return transition_;
+    }
+
+    LinearSensor& sensor()
+    {
+        return sensor_;
+    }
+
+    const LinearTransition& transition() const
+    {
+        return transition_;
+    }
+
+    const LinearSensor& sensor() const
+    {
+        return sensor_;
+    }
+
+protected:
+    /** \cond internal */
+    template <typename Inputs>
+    void predict_batch(Belief& belief, const Inputs* inputs)
+    {
+        for (int c = 0; c < belief.size(); c += Chunk)
+        {
+            const int width = std::min(int(Chunk), belief.size() - c);
+
+            predict_chunk(belief.means().middleCols(c, width),
+                          belief.covariances().middleCols(c, width));
+
+            if (inputs)
+            {
+                add_inputs(belief.means().middleCols(c, width),
+                           inputs->middleCols(c, width));
+            }
+        }
+    }
+
+    /**
+     * \brief Predicts a chunk of means \f$x = A x\f$ and covariances
+     *        \f$P = A P A^T + Q\f$ in place
+     */
+    template <typename Means, typename Covariances>
+    void predict_chunk(Means means, Covariances P)
+    {
+        const auto& A = transition_.dynamics_matrix();
+        const auto& Q = transition_.noise_covariance();
+
+        const int dim = A.rows();
+        const int width = means.cols();
+
+        // T = A P
+        product_.setZero(dim * dim, width);
+        for (int i = 0; i < dim; ++i)
+        {
+            for (int k = 0; k < dim; ++k)
+            {
+                if (A(i, k) == Real(0)) continue;
+                for (int j = 0; j < dim; ++j)
+                {
+                    product_.row(i * dim + j) +=
+                        A(i, k) * P.row(Belief::packed_index(k, j));
+                }
+            }
+        }
+
+        // P = T A^T + Q, lower triangle
+        for (int i = 0; i < dim; ++i)
+        {
+            for (int j = 0; j <= i; ++j)
+            {
+                auto p = P.row(Belief::packed_index(i, j));
+                p.setConstant(Q(i, j));
+                for (int l = 0; l < dim; ++l)
+                {
+                    if (A(j, l) == Real(0)) continue;
+                    p += A(j, l) * product_.row(i * dim + l);
+                }
+            }
+        }
+
+        // x = A x
+        means_.setZero(dim, width);
+        for (int i = 0; i < dim; ++i)
+        {
+            for (int k = 0; k < dim; ++k)
+            {
+                if (A(i, k) == Real(0)) continue;
+                means_.row(i) += A(i, k) * means.row(k);
+            }
+        }
+        means = means_;
+    }
+
+    /**
+     * \brief Adds \f$B u\f$ to a chunk of means
+     */
+    template <typename Means, typename Inputs>
+    void add_inputs(Means means, const Inputs& inputs)
+    {
+        const auto& B = transition_.input_matrix();
+
+        for (int i = 0; i < B.rows(); ++i)
+        {
+            for (int k = 0; k < B.cols(); ++k)
+            {
+                if (B(i, k) == Real(0)) continue;
+                means.row(i) += B(i, k) * inputs.row(k);
+            }
+        }
+    }
+
+    /**
+     * \brief Updates a chunk of means and covariances in place
+     */
+    template <typename Means, typename Covariances, typename Obsrvs>
+    void update_chunk(Means means, Covariances P, const Obsrvs& y)
+    {
+        const auto& H = sensor_.sensor_matrix();
+        const auto R = sensor_.noise_covariance();
+
+        const int dim = H.cols();
+        const int obsrv_dim = H.rows();
+        const int width = means.cols();
+
+        // C = P H^T
+        cross_.setZero(dim * obsrv_dim, width);
+        for (int i = 0; i < dim; ++i)
+        {
+            for (int a = 0; a < obsrv_dim; ++a)
+            {
+                for (int k = 0; k < dim; ++k)
+                {
+                    if (H(a, k) == Real(0)) continue;
+                    cross_.row(i * obsrv_dim + a) +=
+                        H(a, k) * P.row(Belief::packed_index(i, k));
+                }
+            }
+        }
+
+        // S = H C + R, lower triangle
+        factor_.resize(Belief::packed_size(obsrv_dim), width);
+        for (int a = 0; a < obsrv_dim; ++a)
+        {
+            for (int b = 0; b <= a; ++b)
+            {
+                auto s = factor_.row(Belief::packed_index(a, b));
+                s.setConstant(R(a, b));
+                for (int k = 0; k < dim; ++k)
+                {
+                    if (H(a, k) == Real(0)) continue;
+                    s += H(a, k) * cross_.row(k * obsrv_dim + b);
+                }
+            }
+        }
+
+        // S = L L^T in place, storing the inverse diagonal of L
+        inverse_diagonal_.resize(obsrv_dim, width);
+        for (int j = 0; j < obsrv_dim; ++j)
+        {
+            auto l_jj = factor_.row(Belief::packed_index(j, j));
+            for (int k = 0; k < j; ++k)
+            {
+                l_jj.array() -=
+                    factor_.row(Belief::packed_index(j, k)).array().square();
+            }
+            l_jj = l_jj.array().sqrt().matrix();
+            inverse_diagonal_.row(j) = l_jj.array().inverse().matrix();
+
+            for (int i = j + 1; i < obsrv_dim; ++i)
+            {
+                auto l_ij = factor_.row(Belief::packed_index(i, j));
+                for (int k = 0; k < j; ++k)
+                {
+                    l_ij.array() -=
+                        factor_.row(Belief::packed_index(i, k)).array()
+                        * factor_.row(Belief::packed_index(j, k)).array();
+                }
+                l_ij.array() *= inverse_diagonal_.row(j).array();
+            }
+        }
+
+        // e = L^{-1} (y - H x)
+        innovation_.resize(obsrv_dim, width);
+        for (int a = 0; a < obsrv_dim; ++a)
+        {
+            auto e = innovation_.row(a);
+            e = y.row(a);
+            for (int k = 0; k < dim; ++k)
+            {
+                if (H(a, k) == Real(0)) continue;
+                e -= H(a, k) * means.row(k);
+            }
+            for (int b = 0; b < a; ++b)
+            {
+                e.array() -= factor_.row(Belief::packed_index(a, b)).array()
+                             * innovation_.row(b).array();
+            }
+            e.array() *= inverse_diagonal_.row(a).array();
+        }
+
+        // C = C L^{-T}
+        for (int i = 0; i < dim; ++i)
+        {
+            for (int a = 0; a < obsrv_dim; ++a)
+            {
+                auto c = cross_.row(i * obsrv_dim + a);
+                for (int b = 0; b < a; ++b)
+                {
+                    c.array() -= cross_.row(i * obsrv_dim + b).array()
+                                 * factor_.row(Belief::packed_index(a, b))
+                                       .array();
+                }
+                c.array() *= inverse_diagonal_.row(a).array();
+            }
+        }
+
+        // x = x + C e and P = P - C C^T
+        for (int i = 0; i < dim; ++i)
+        {
+            for (int a = 0; a < obsrv_dim; ++a)
+            {
+                means.row(i).array() += cross_.row(i * obsrv_dim + a).array()
+                                        * innovation_.row(a).array();
+            }
+
+            for (int j = 0; j <= i; ++j)
+            {
+                auto p = P.row(Belief::packed_index(i, j));
+                for (int a = 0; a < obsrv_dim; ++a)
+                {
+                    p.array() -= cross_.row(i * obsrv_dim + a).array()
+                                 * cross_.row(j * obsrv_dim + a).array();
+                }
+            }
+        }
+    }
+
+    LinearTransition transition_;
+    LinearSensor sensor_;
+
+    /* buffers, one row per element of the per-filter matrices */
+    BatchMatrix means_;
+    BatchMatrix product_;
+    BatchMatrix cross_;
+    BatchMatrix factor_;
+    BatchMatrix inverse_diagonal_;
+    BatchMatrix innovation_;
+    /** \endcond */
+};
+
+}
@@ -0,0 +1,174 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file gaussian_conditioning.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <fl/util/types.hpp>
+#include <fl/exception/exception.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Conditions the joint Gaussian of the state \f$x\f$ and the
+ *        observation \f$y\f$ on the innovation \f$e = y - E[y]\f$ without
+ *        forming an explicit inverse.
+ *
+ * With the Cholesky factor \f$\Sigma_{yy} = L L^T\f$, the whitened cross
+ * covariance \f$\tilde{C} = \Sigma_{xy} L^{-T}\f$ and the whitened innovation
+ * \f$\tilde{e} = L^{-1} e\f$, the posterior moments are
+ *
+ * \f$ \hat{x} = x + \tilde{C} \tilde{e} \f$ and
+ * \f$ \hat{\Sigma} = \Sigma_{xx} - \tilde{C} \tilde{C}^T \f$.
+ *
+ * The covariance is updated by a symmetric rank update of its lower triangle
+ * which is then mirrored, i.e. the result is exactly symmetric.
+ *
+ * \param [in]     cov_xy      Cross covariance \f$\Sigma_{xy}\f$
+ * \param [in]     cov_yy      Observation covariance \f$\Sigma_{yy}\f$
+ * \param [in]     innovation  \f$y - E[y]\f$
+ * \param [in,out] mean        Prior mean, replaced by the posterior mean
+ * \param [in,out] covariance  Prior covariance \f$\Sigma_{xx}\f$, replaced
+ *                             by the posterior covariance
+ *
+ * \throws Exception if \f$\Sigma_{yy}\f$ is not positive definite
+ */
+template <
+    typename CrossCovariance,
+    typename ObsrvCovariance,
+    typename Innovation,
+    typename Mean,
+    typename Covariance
+>
+void condition_gaussian(const CrossCovariance& cov_xy,
+                        const ObsrvCovariance& cov_yy,
+                        const Innovation& innovation,
+                        Mean& mean,
+                        Covariance& covariance)
+{
+    Eigen::LLT<typename ObsrvCovariance::PlainObject> llt(cov_yy);
+
+    if (llt.info() != Eigen::Success)
+    {
+        fl_throw(Exception("Observation covariance is not positive definite"));
+    }
+
+    auto whitened_cov_yx = cov_xy.transpose().eval();
+    auto whitened_innovation = innovation.eval();
+    llt.matrixL().solveInPlace(whitened_cov_yx);
+    llt.matrixL().solveInPlace(whitened_innovation);
+
+    mean.noalias() += whitened_cov_yx.transpose() * whitened_innovation;
+
+    covariance.template selfadjointView<Eigen::Lower>()
+        .rankUpdate(whitened_cov_yx.transpose(), Real(-1));
+    covariance.template triangularView<Eigen::StrictlyUpper>() =
+        covariance.transpose();
+}
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Sets the covariance of \a gaussian together with its square root,
+ *        such that subsequent sigma point transforms do not decompose it
+ *        again.
+ *
+ * If round-off has made the covariance slightly indefinite and the Cholesky
+ * decomposition fails, the negative pivots of an LDLT decomposition are
+ * clamped to zero. The covariance is then replaced by the positive
+ * semi-definite matrix reconstructed from the clamped factor.
+ */
+template <typename Belief, typename Covariance>
+void set_factorized_covariance(Belief& gaussian, const Covariance& covariance)
+{
+    typedef typename Belief::SecondMoment SecondMoment;
+
+    Eigen::LLT<SecondMoment> llt(covariance);
+
+    if (llt.info() == Eigen::Success)
+    {
+        gaussian.covariance(covariance, llt.matrixL());
+        return;
+    }
+
+    Eigen::LDLT<SecondMoment> ldlt(covariance);
+
+    SecondMoment square_root =
+        ldlt.transpositionsP().transpose()
+        * SecondMoment(ldlt.matrixL())
+        * ldlt.vectorD().cwiseMax(Real(0)).cwiseSqrt().asDiagonal();
+
+    gaussian.covariance(square_root * square_root.transpose(), square_root);
+}
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Sets the posterior \a gaussian of an update in the information
+ *        form, i.e. from the posterior precision \f$\Lambda\f$ and the
+ *        accumulated information \f$d\f$ such that
+ *        \f$\hat{x} = x + \Lambda^{-1} d\f$.
+ *
+ * The covariance is obtained from the Cholesky factor \f$\Lambda = U^T U\f$
+ * as \f$U^{-1} U^{-T}\f$ by triangular solves. \f$U^{-1}\f$ is passed to
+ * \a gaussian as the square root of its covariance. If \f$\Lambda\f$ is
+ * not positive definite due to round-off, the covariance is computed by an
+ * LDLT solve and factorized by set_factorized_covariance().
+ */
+template <
+    typename Belief,
+    typename Mean,
+    typename Precision,
+    typename Information
+>
+void set_information_posterior(const Mean& mean,
+                               const Precision& precision,
+                               const Information& information,
+                               Belief& gaussian)
+{
+    typedef typename Belief::SecondMoment SecondMoment;
+
+    const int dim = precision.rows();
+    const SecondMoment identity = SecondMoment::Identity(dim, dim);
+
+    Eigen::LLT<SecondMoment> llt(precision);
+
+    if (llt.info() == Eigen::Success)
+    {
+        SecondMoment square_root = llt.matrixU().solve(identity);
+        SecondMoment covariance = square_root * square_root.transpose();
+
+        gaussian.covariance(covariance, square_root);
+        gaussian.mean(mean + llt.solve(information));
+        return;
+    }
+
+    SecondMoment covariance = precision.ldlt().solve(identity);
+    covariance = (Real(0.5) * (covariance + covariance.transpose())).eval();
+
+    set_factorized_covariance(gaussian, covariance);
+    gaussian.mean(mean + covariance * information);
+}
+
+}
@@ -27,5 +27,6 @@
 #include "quadrature/unscented_quadrature.hpp"
 
 #include "gaussian_filter_linear.hpp"
+#include "square_root_gaussian_filter.hpp"
 #include "gaussian_filter_nonlinear.hpp"
 #include "gaussian_filter_nonlinear_generic.hpp"
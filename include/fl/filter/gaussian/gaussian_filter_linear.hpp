@@ -20,14 +20,21 @@
 #pragma once
 
 
+#include <Eigen/Dense>
+
+#include <cmath>
 #include <utility>
+#include <algorithm>
+#include <type_traits>
 
 #include <fl/util/meta.hpp>
 #include <fl/util/traits.hpp>
 #include <fl/util/profiling.hpp>
+#include <fl/util/math/block_structure.hpp>
 
 #include <fl/exception/exception.hpp>
 #include <fl/filter/filter_interface.hpp>
+#include <fl/filter/gaussian/gaussian_conditioning.hpp>
 
 #include <fl/model/transition/linear_transition.hpp>
 #include <fl/model/sensor/linear_gaussian_sensor.hpp>
@@ -90,6 +97,15 @@ class GaussianFilter<
             typename ForwardLinearModelOnly<LinearTransition>::Type,
             typename ForwardLinearModelOnly<LinearSensor>::Type>>
 {
+private:
+    /** \cond internal */
+    typedef FilterInterface<
+                GaussianFilter<
+                    typename ForwardLinearModelOnly<LinearTransition>::Type,
+                    typename ForwardLinearModelOnly<LinearSensor>::Type>
+            > Interface;
+    /** \endcond */
+
 public:
     typedef typename LinearTransition::State State;
     typedef typename LinearTransition::Input Input;
@@ -102,6 +118,18 @@ public:
      */
     typedef Gaussian<State> Belief;
 
+    /**
+     * \brief Sequence of observations, see batch_update()
+     */
+    typedef typename Interface::Obsrvs Obsrvs;
+
+    /**
+     * \brief Kalman gain matrix type
+     */
+    typedef Eigen::Matrix<
+                Real, SizeOf<State>::Value, SizeOf<Obsrv>::Value
+            > GainMatrix;
+
 public:
     /**
      * Creates a linear Gaussian filter (a KalmanFilter)
@@ -112,7 +140,9 @@ public:
     GaussianFilter(const LinearTransition& transition,
                    const LinearSensor& sensor)
         : transition_(transition),
-          sensor_(sensor)
+          sensor_(sensor),
+          steady_state_(false),
+          steady_state_solved_(false)
     { }
 
     /**
@@ -138,11 +168,29 @@ public:
      * \f$ \bar{x}_{t} =  A \hat{x}_t\f$ and
      *
      * \f$ \bar{\Sigma}_{t} = A\hat{\Sigma}_{t}A^T + Q \f$
+     *
+     * If the dynamics matrix is block diagonal, see
+     * LinearTransition::dynamics_blocks(), the covariance is propagated
+     * block-wise and identity blocks are skipped.
+     *
+     * In the steady state mode, the predicted covariance is the cached
+     * steady state covariance, see enable_steady_state().
      */
     virtual void predict(const Belief& prior_belief,
                          const Input& input,
                          Belief& predicted_belief)
     {
+        if (steady_state_)
+        {
+            solve_steady_state();
+
+            predicted_belief.mean(
+                transition_.dynamics_matrix() * prior_belief.mean()
+                + transition_.input_matrix() * input);
+            predicted_belief.covariance(steady_predicted_covariance_);
+            return;
+        }
+
         auto A = transition_.dynamics_matrix();
         auto B = transition_.input_matrix();
         auto Q = transition_.noise_covariance();
@@ -150,13 +198,107 @@ public:
         predicted_belief.mean(
             A * prior_belief.mean() + B * input);
 
-        predicted_belief.covariance(
-            A * prior_belief.covariance() * A.transpose() + Q);
+        const DiagonalBlocks& blocks = transition_.dynamics_blocks();
+        if (blocks.dense())
+        {
+            predicted_belief.covariance(
+                A * prior_belief.covariance() * A.transpose() + Q);
+        }
+        else
+        {
+            typename Belief::SecondMoment cov;
+            block_diagonal_congruence(
+                A, blocks, prior_belief.covariance(), cov);
+            cov += Q;
+            predicted_belief.covariance(cov);
+        }
     }
 
     /**
      * \copydoc FilterInterface::update
      *
+     * If the sensor noise is uncorrelated, i.e. the sensor is an
+     * \c AdditiveUncorrelated model such as the
+     * LinearDecorrelatedGaussianSensor, the observation is incorporated by
+     * sequential_update(). Otherwise, the update is performed in the
+     * covariance form if the observation dimension does not exceed the state
+     * dimension and in the information form otherwise. The former inverts the
+     * innovation covariance of dimension \f$\dim(y)\f$, the latter the
+     * posterior precision of dimension \f$\dim(x)\f$. Both forms yield the
+     * same posterior, see covariance_form_update() and
+     * information_form_update(). The information form is only used if the
+     * predicted covariance is positive definite, a predicted belief with a
+     * zero variance direction is updated in the covariance form.
+     *
+     * In the steady state mode, the mean is corrected by the cached steady
+     * state gain and the posterior covariance is the cached steady state
+     * covariance, see enable_steady_state().
+     */
+    virtual void update(const Belief& predicted_belief,
+                        const Obsrv& y,
+                        Belief& posterior_belief)
+    {
+        if (steady_state_)
+        {
+            solve_steady_state();
+
+            const auto& H = sensor_.sensor_matrix();
+            const auto& mean = predicted_belief.mean();
+
+            posterior_belief.mean(
+                mean + steady_state_gain_ * (y - H * mean));
+            posterior_belief.covariance(steady_posterior_covariance_);
+            return;
+        }
+
+        update(predicted_belief, y, posterior_belief,
+               std::integral_constant<
+                   bool, IsAdditiveUncorrelated<LinearSensor>::Value>());
+    }
+
+    /**
+     * \copydoc FilterInterface::batch_update
+     *
+     * The \f$N\f$ observations are independent given the state and share
+     * the sensor matrix. Their sample mean \f$\bar{y}\f$ is therefore a
+     * sufficient statistic with the noise covariance \f$R / N\f$. A single
+     * covariance_form_update() with \f$\bar{y}\f$ and \f$R / N\f$ yields
+     * the posterior of the \f$N\f$ sequential updates with one
+     * factorization.
+     *
+     * The observations are updated sequentially in the steady state mode,
+     * since the cached gain refers to a single observation, and if any of
+     * them contains invalid (NaN) components.
+     */
+    virtual void batch_update(const Belief& predicted_belief,
+                              const Obsrvs& obsrvs,
+                              Belief& posterior_belief)
+    {
+        const int count = obsrvs.size();
+
+        bool fusable = count > 1 && !steady_state_;
+        for (int i = 0; fusable && i < count; ++i)
+        {
+            fusable = obsrvs[i].allFinite();
+        }
+
+        if (!fusable)
+        {
+            Interface::batch_update(predicted_belief, obsrvs, posterior_belief);
+            return;
+        }
+
+        Obsrv y = obsrvs[0];
+        for (int i = 1; i < count; ++i) y += obsrvs[i];
+        y /= Real(count);
+
+        covariance_form_update(predicted_belief,
+                               y,
+                               sensor_.noise_covariance() / Real(count),
+                               posterior_belief);
+    }
+
+    /**
      * Given the following matrices
      *
      *  - \f$ H \f$: Sensor Matrix
@@ -174,22 +316,228 @@ public:
      * with the KalmanGain
      *
      * \f$ K = \bar{\Sigma}_{t}H^T (H\bar{\Sigma}_{t}H^T+R)^{-1}\f$.
+     *
+     * The products with \f$H\f$ are restricted to its non-zero column
+     * blocks, see LinearSensor::sensor_column_blocks(). The gain is applied
+     * through Cholesky solves with \f$H\bar{\Sigma}_{t}H^T+R\f$ and the
+     * posterior covariance is exactly symmetric, see condition_gaussian().
      */
-    virtual void update(const Belief& predicted_belief,
-                        const Obsrv& y,
-                        Belief& posterior_belief)
+    void covariance_form_update(const Belief& predicted_belief,
+                                const Obsrv& y,
+                                Belief& posterior_belief)
+    {
+        covariance_form_update(predicted_belief,
+                               y,
+                               sensor_.noise_covariance(),
+                               posterior_belief);
+    }
+
+    /**
+     * \brief covariance_form_update() with the noise covariance \a R in
+     *        place of the one of the sensor
+     */
+    template <typename NoiseCovariance>
+    void covariance_form_update(const Belief& predicted_belief,
+                                const Obsrv& y,
+                                const NoiseCovariance& R,
+                                Belief& posterior_belief)
+    {
+        auto H = sensor_.sensor_matrix();
+
+        auto mean = predicted_belief.mean();
+        auto cov_xx = predicted_belief.covariance();
+
+        // only the non-zero column blocks of H contribute to
+        // cov_xy = cov_xx H^T and S = H cov_xy + R
+        const ColumnBlocks& blocks = sensor_.sensor_column_blocks();
+        GainMatrix cov_xy = GainMatrix::Zero(cov_xx.rows(), H.rows());
+        auto S = R.eval();
+        for (int i = 0; i < blocks.count(); ++i)
+        {
+            const int o = blocks.offset(i);
+            const int s = blocks.size(i);
+
+            cov_xy.noalias() +=
+                cov_xx.middleCols(o, s) * H.middleCols(o, s).transpose();
+        }
+        for (int i = 0; i < blocks.count(); ++i)
+        {
+            const int o = blocks.offset(i);
+            const int s = blocks.size(i);
+
+            S.noalias() += H.middleCols(o, s) * cov_xy.middleRows(o, s);
+        }
+
+        auto innovation = (y - H * mean).eval();
+        condition_gaussian(cov_xy, S, innovation, mean, cov_xx);
+
+        posterior_belief.mean(mean);
+        posterior_belief.covariance(cov_xx);
+    }
+
+    /**
+     * Update in the information form operating on the precision
+     * \f$\bar{\Lambda}_t = \bar{\Sigma}_t^{-1}\f$ of the predicted belief.
+     * The observation is whitened by the Cholesky factor \f$R = L L^T\f$,
+     * i.e. \f$W = L^{-1} H\f$ and \f$e = L^{-1}(y - H\bar{x}_t)\f$. The
+     * information of the observation is then accumulated additively,
+     *
+     * \f$ \hat{\Lambda}_t = \bar{\Lambda}_t + W^T W \f$ and
+     *
+     * \f$ \hat{x}_t = \bar{x}_t + \hat{\Lambda}_t^{-1} W^T e \f$,
+     *
+     * where the latter is a Cholesky solve of dimension \f$\dim(x)\f$. The
+     * posterior belief is set in its precision form.
+     */
+    void information_form_update(const Belief& predicted_belief,
+                                 const Obsrv& y,
+                                 Belief& posterior_belief)
     {
         auto H = sensor_.sensor_matrix();
         auto R = sensor_.noise_covariance();
 
+        auto mean = predicted_belief.mean();
+        auto precision = predicted_belief.precision();
+
+        Eigen::LLT<decltype(R)> noise_llt(R);
+        auto W = noise_llt.matrixL().solve(H).eval();
+        auto e = noise_llt.matrixL().solve(y - H * mean).eval();
+
+        precision.template selfadjointView<Eigen::Lower>()
+            .rankUpdate(W.transpose());
+        precision.template triangularView<Eigen::StrictlyUpper>() =
+            precision.transpose();
+
+        posterior_belief.mean(mean + precision.llt().solve(W.transpose() * e));
+        posterior_belief.precision(precision);
+    }
+
+    /**
+     * \return Whether an observation of dimension \a obsrv_dimension is
+     *         incorporated more efficiently in the information form than in
+     *         the covariance form given the state dimension
+     *         \a state_dimension
+     */
+    static bool information_form_preferred(int obsrv_dimension,
+                                           int state_dimension)
+    {
+        return obsrv_dimension > state_dimension;
+    }
+
+    /**
+     * Update for sensors with uncorrelated noise, i.e. a diagonal noise
+     * covariance \f$R = \text{diag}(r_1, \ldots, r_m)\f$. The observation
+     * elements are incorporated one after another by the scalar updates
+     *
+     * \f$ s = h_i \Sigma h_i^T + r_i,\quad k = \Sigma h_i^T / s \f$,
+     *
+     * \f$ x \leftarrow x + k (y_i - h_i x),\quad
+     *     \Sigma \leftarrow \Sigma - s k k^T \f$,
+     *
+     * where \f$h_i\f$ is the i-th row of the sensor matrix. No matrix is
+     * inverted and the cost is \f$O(\dim(y) \dim(x)^2)\f$. Missing
+     * measurements, i.e. NaN elements of \a y, are skipped.
+     *
+     * \note Requires the sensor to provide noise_diagonal_covariance()
+     */
+    void sequential_update(const Belief& predicted_belief,
+                           const Obsrv& y,
+                           Belief& posterior_belief)
+    {
+        const auto& H = sensor_.sensor_matrix();
+        const auto R = sensor_.noise_diagonal_covariance();
+
         auto mean = predicted_belief.mean();
         auto cov_xx = predicted_belief.covariance();
 
-        auto S = (H * cov_xx * H.transpose() + R).eval();
-        auto K = (cov_xx * H.transpose() * S.inverse()).eval();
+        // only the lower triangle of cov_xx is maintained
+        for (int i = 0; i < H.rows(); ++i)
+        {
+            if (std::isnan(y(i))) continue;
+
+            const auto cov_xy = (cov_xx.template selfadjointView<Eigen::Lower>()
+                                 * H.row(i).transpose()).eval();
+            const Real s = H.row(i).dot(cov_xy) + R.diagonal()(i);
+            const Real innovation = y(i) - H.row(i).dot(mean);
+
+            mean += (innovation / s) * cov_xy;
+            cov_xx.template selfadjointView<Eigen::Lower>()
+                .rankUpdate(cov_xy, Real(-1) / s);
+        }
 
-        posterior_belief.mean(mean + K * (y - H * mean));
-        posterior_belief.covariance(cov_xx - K * H * cov_xx);
+        cov_xx.template triangularView<Eigen::StrictlyUpper>() =
+            cov_xx.transpose();
+
+        posterior_belief.mean(mean);
+        posterior_belief.covariance(cov_xx);
+    }
+
+    /**
+     * \brief Enables the steady state mode for time-invariant models.
+     *
+     * The covariance of the Kalman filter with constant models converges
+     * independently of the observations. In the steady state mode, the
+     * limit is obtained once by iterating the discrete algebraic Riccati
+     * equation
+     *
+     * \f$ \bar{\Sigma} = A (\bar{\Sigma} - K H \bar{\Sigma}) A^T + Q,
+     *     \quad K = \bar{\Sigma} H^T (H \bar{\Sigma} H^T + R)^{-1} \f$
+     *
+     * to convergence. The gain and the covariances are cached and each
+     * predict() and update() reduces to a matrix-vector product for the
+     * mean. The covariance of the beliefs passed to the filter is ignored.
+     *
+     * The cache is invalidated if the parameters of transition() or
+     * sensor() are modified. Missing measurements are not supported in this
+     * mode.
+     *
+     * \param tolerance       Convergence threshold of the maximum absolute
+     *                        change of \f$\bar{\Sigma}\f$ relative to its
+     *                        maximum absolute element
+     * \param max_iterations  Maximum number of Riccati iterations
+     *
+     * \throws Exception if the iteration does not converge within
+     *         \a max_iterations, e.g. if the system is not detectable
+     */
+    void enable_steady_state(Real tolerance = 1e-12,
+                             int max_iterations = 100000)
+    {
+        steady_state_ = true;
+        steady_state_solved_ = false;
+        steady_state_tolerance_ = tolerance;
+        steady_state_max_iterations_ = max_iterations;
+    }
+
+    void disable_steady_state()
+    {
+        steady_state_ = false;
+    }
+
+    bool steady_state_enabled() const
+    {
+        return steady_state_;
+    }
+
+    /**
+     * \return Steady state Kalman gain
+     *
+     * \throws see enable_steady_state()
+     */
+    const GainMatrix& steady_state_gain()
+    {
+        solve_steady_state();
+        return steady_state_gain_;
+    }
+
+    /**
+     * \return Steady state covariance of the posterior belief
+     *
+     * \throws see enable_steady_state()
+     */
+    const typename Belief::SecondMoment& steady_state_covariance()
+    {
+        solve_steady_state();
+        return steady_posterior_covariance_;
     }
 
     virtual Belief create_belief() const
@@ -237,8 +585,105 @@ public:
 
 protected:
     /** \cond internal */
+    /**
+     * \brief Solves the Riccati equation unless the cached solution is
+     *        still valid for the current models
+     */
+    void solve_steady_state()
+    {
+        if (steady_state_solved_ &&
+            transition_revision_ == transition_.revision() &&
+            sensor_revision_ == sensor_.revision())
+        {
+            return;
+        }
+
+        const auto& A = transition_.dynamics_matrix();
+        const auto& Q = transition_.noise_covariance();
+        const auto& H = sensor_.sensor_matrix();
+        const auto R = sensor_.noise_covariance();
+
+        auto& P = steady_predicted_covariance_;
+        auto& P_post = steady_posterior_covariance_;
+        auto& K = steady_state_gain_;
+
+        Eigen::LLT<typename std::decay<decltype(R)>::type> llt;
+        auto gain = [&]()
+        {
+            llt.compute(H * P * H.transpose() + R);
+            K = llt.solve(H * P).transpose();
+            P_post = P - K * H * P;
+            P_post = (0.5 * (P_post + P_post.transpose())).eval();
+        };
+
+        P = Q;
+        bool converged = false;
+        for (int i = 0; i < steady_state_max_iterations_ && !converged; ++i)
+        {
+            gain();
+
+            const typename Belief::SecondMoment P_next =
+                A * P_post * A.transpose() + Q;
+
+            converged = (P_next - P).cwiseAbs().maxCoeff()
+                        <= steady_state_tolerance_
+                           * std::max(Real(1), P.cwiseAbs().maxCoeff());
+            P = P_next;
+        }
+
+        if (!converged)
+        {
+            steady_state_solved_ = false;
+            fl_throw(Exception("Riccati iteration did not converge"));
+        }
+
+        gain();
+
+        transition_revision_ = transition_.revision();
+        sensor_revision_ = sensor_.revision();
+        steady_state_solved_ = true;
+    }
+
+    void update(const Belief& predicted_belief,
+                const Obsrv& y,
+                Belief& posterior_belief,
+                std::true_type /* uncorrelated noise */)
+    {
+        sequential_update(predicted_belief, y, posterior_belief);
+    }
+
+    void update(const Belief& predicted_belief,
+                const Obsrv& y,
+                Belief& posterior_belief,
+                std::false_type /* correlated noise */)
+    {
+        // the information form requires the predicted precision, hence a
+        // positive definite predicted covariance
+        if (information_form_preferred(sensor_.obsrv_dimension(),
+                                       predicted_belief.dimension()) &&
+            predicted_belief.covariance().llt().info() == Eigen::Success)
+        {
+            information_form_update(predicted_belief, y, posterior_belief);
+        }
+        else
+        {
+            covariance_form_update(predicted_belief, y, posterior_belief);
+        }
+    }
+
     LinearTransition transition_;
     LinearSensor sensor_;
+
+    /* steady state mode, see enable_steady_state() */
+    bool steady_state_;
+    bool steady_state_solved_;
+    Real steady_state_tolerance_;
+    int steady_state_max_iterations_;
+    std::size_t transition_revision_;
+    std::size_t sensor_revision_;
+    typename Belief::SecondMoment steady_predicted_covariance_;
+    typename Belief::SecondMoment steady_posterior_covariance_;
+    GainMatrix steady_state_gain_;
     /** \endcond */
 };
 
@@ -78,6 +78,25 @@ class GaussianFilter<TransitionFunction, SensorFunction, Quadrature>
                UpdatePolicy>
 #endif
 {
+private:
+    /** \cond internal */
+    typedef GaussianFilter<
+                typename RemoveAdditivityOf<TransitionFunction>::Type,
+                typename RemoveAdditivityOf<SensorFunction>::Type,
+                Quadrature,
+                SigmaPointPredictPolicy<
+                    Quadrature,
+                    typename AdditivityOf<TransitionFunction>::Type>,
+                SigmaPointUpdatePolicy<
+                    Quadrature,
+                    typename AdditivityOf<SensorFunction>::Type>
+            > Base;
+    /** \endcond */
+
+public:
+    typedef typename Base::Belief Belief;
+    typedef typename Base::Obsrvs Obsrvs;
+
 public:
     GaussianFilter(const TransitionFunction& transition,
                    const SensorFunction& sensor,
@@ -94,6 +113,23 @@ public:
                   typename AdditivityOf<SensorFunction>::Type>>
           (transition, sensor, quadrature)
     { }
+
+    /**
+     * \copydoc FilterInterface::batch_update
+     *
+     * For sensors with additive noise, the update policy fuses all
+     * observations in a single sigma point pass.
+     */
+    virtual void batch_update(const Belief& predicted_belief,
+                              const Obsrvs& obsrvs,
+                              Belief& posterior_belief)
+    {
+        this->update_policy_(this->sensor(),
+                             this->quadrature(),
+                             predicted_belief,
+                             obsrvs,
+                             posterior_belief);
+    }
 };
 
 
@@ -0,0 +1,482 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file gaussian_smoother.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <fl/util/types.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/util/descriptor.hpp>
+#include <fl/exception/exception.hpp>
+#include <fl/distribution/gaussian.hpp>
+#include <fl/filter/gaussian/transform/point_set.hpp>
+
+namespace fl
+{
+
+/**
+ * \defgroup gaussian_smoother Gaussian Smoothers
+ * \ingroup filters
+ */
+
+// Gaussian smoother forward declaration
+template <typename...> class GaussianSmoother;
+
+/**
+ * \internal
+ */
+namespace internal
+{
+
+/**
+ * \internal
+ * \ingroup gaussian_smoother
+ *
+ * \brief Rauch-Tung-Striebel backward recursion shared by the Gaussian
+ *        smoothers.
+ *
+ * Given the filtered belief \f${\cal N}(x_k \mid \mu_k, \Sigma_k)\f$, the
+ * predicted belief \f${\cal N}(x_{k+1} \mid \bar{\mu}_{k+1},
+ * \bar{\Sigma}_{k+1})\f$ and the cross covariance
+ * \f$C_{k+1} = \text{Cov}(x_k, x_{k+1})\f$, the smoothed belief is
+ *
+ * \f$ \mu_k^s = \mu_k + G_k (\mu_{k+1}^s - \bar{\mu}_{k+1}) \f$ and
+ *
+ * \f$ \Sigma_k^s = \Sigma_k
+ *          + G_k (\Sigma_{k+1}^s - \bar{\Sigma}_{k+1}) G_k^T \f$
+ *
+ * with the smoother gain \f$G_k = C_{k+1} \bar{\Sigma}_{k+1}^{-1}\f$
+ * obtained by a Cholesky solve. The derived smoothers provide the
+ * prediction and the cross covariance by implementing predict().
+ */
+template <typename Transition>
+class GaussianSmootherBase
+    : public Descriptor
+{
+public:
+    typedef typename Transition::State State;
+    typedef typename Transition::Input Input;
+    typedef Gaussian<State> Belief;
+    typedef typename Belief::SecondMoment SecondMoment;
+
+public:
+    explicit GaussianSmootherBase(const Transition& transition)
+        : transition_(transition)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~GaussianSmootherBase() noexcept { }
+
+    /**
+     * \brief Smoothes a sequence of filtered beliefs in a single backward
+     *        pass. The forward pass is not repeated.
+     *
+     * \param [in]  filtered_beliefs  Filtered beliefs \f$x_0, \ldots, x_T\f$,
+     *                                i.e. the posteriors of the filter
+     * \param [in]  inputs            Inputs, where inputs[k] is the input of
+     *                                the transition from \f$x_k\f$ to
+     *                                \f$x_{k+1}\f$. Requires at least
+     *                                \f$T\f$ elements.
+     * \param [out] smoothed_beliefs  Smoothed beliefs. May be the same
+     *                                object as \a filtered_beliefs.
+     *
+     * \throws Exception if there are not enough inputs
+     */
+    void smooth(const std::vector<Belief>& filtered_beliefs,
+                const std::vector<Input>& inputs,
+                std::vector<Belief>& smoothed_beliefs)
+    {
+        const int size = filtered_beliefs.size();
+
+        if (size > 1 && int(inputs.size()) < size - 1)
+        {
+            fl_throw(Exception("GaussianSmoother requires one input per "
+                               "transition"));
+        }
+
+        smoothed_beliefs = filtered_beliefs;
+
+        for (int k = size - 2; k >= 0; --k)
+        {
+            smooth_step(smoothed_beliefs[k],
+                        inputs[k],
+                        smoothed_beliefs[k + 1],
+                        smoothed_beliefs[k]);
+        }
+    }
+
+    /**
+     * \brief Single backward step of the recursion
+     *
+     * \param [in]  filtered_belief       Filtered belief at time k
+     * \param [in]  input                 Input of the transition to k + 1
+     * \param [in]  next_smoothed_belief  Smoothed belief at time k + 1
+     * \param [out] smoothed_belief       Smoothed belief at time k. May
+     *                                    alias any of the arguments.
+     */
+    void smooth_step(const Belief& filtered_belief,
+                     const Input& input,
+                     const Belief& next_smoothed_belief,
+                     Belief& smoothed_belief)
+    {
+        predict(filtered_belief, input, predicted_belief_, cross_covariance_);
+
+        llt_.compute(predicted_belief_.covariance());
+        gain_ = llt_.solve(cross_covariance_.transpose()).transpose();
+
+        mean_ = filtered_belief.mean()
+                + gain_ * (next_smoothed_belief.mean()
+                           - predicted_belief_.mean());
+
+        covariance_ = filtered_belief.covariance()
+                      + gain_ * (next_smoothed_belief.covariance()
+                                 - predicted_belief_.covariance())
+                              * gain_.transpose();
+
+        smoothed_belief.mean(mean_);
+        smoothed_belief.covariance(covariance_);
+    }
+
+    Transition& transition()
+    {
+        return transition_;
+    }
+
+    const Transition& transition() const
+    {
+        return transition_;
+    }
+
+protected:
+    /** \cond internal */
+    /**
+     * \brief Computes the predicted belief of the filtered belief and the
+     *        cross covariance \f$\text{Cov}(x_k, x_{k+1})\f$
+     */
+    virtual void predict(const Belief& filtered_belief,
+                         const Input& input,
+                         Belief& predicted_belief,
+                         SecondMoment& cross_covariance) = 0;
+
+    Transition transition_;
+
+    /* buffers */
+    Belief predicted_belief_;
+    SecondMoment cross_covariance_;
+    SecondMoment gain_;
+    State mean_;
+    SecondMoment covariance_;
+    Eigen::LLT<SecondMoment> llt_;
+    /** \endcond */
+};
+
+}
+
+/**
+ * \ingroup gaussian_smoother
+ *
+ * \brief Rauch-Tung-Striebel smoother of the linear GaussianFilter.
+ *
+ * The prediction is \f$\bar{\mu}_{k+1} = A \mu_k + B u_k\f$,
+ * \f$\bar{\Sigma}_{k+1} = A \Sigma_k A^T + Q\f$ and the cross covariance is
+ * \f$\Sigma_k A^T\f$, see internal::GaussianSmootherBase for the recursion.
+ */
+template <typename LinearTransition>
+class GaussianSmoother<LinearTransition>
+    : public internal::GaussianSmootherBase<LinearTransition>
+{
+private:
+    /** \cond internal */
+    typedef internal::GaussianSmootherBase<LinearTransition> Base;
+    /** \endcond */
+
+public:
+    typedef typename Base::Input Input;
+    typedef typename Base::Belief Belief;
+    typedef typename Base::SecondMoment SecondMoment;
+
+public:
+    explicit GaussianSmoother(const LinearTransition& transition)
+        : Base(transition)
+    { }
+
+    virtual std::string name() const
+    {
+        return "GaussianSmoother<"
+                + this->list_arguments(this->transition().name())
+                + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Rauch-Tung-Striebel smoother (linear Gaussian smoother) with"
+                + this->list_descriptions(this->transition().description());
+    }
+
+protected:
+    /** \cond internal */
+    void predict(const Belief& filtered_belief,
+                 const Input& input,
+                 Belief& predicted_belief,
+                 SecondMoment& cross_covariance) override
+    {
+        const auto& A = this->transition_.dynamics_matrix();
+        const auto& B = this->transition_.input_matrix();
+        const auto& Q = this->transition_.noise_covariance();
+
+        cross_covariance.noalias() =
+            filtered_belief.covariance() * A.transpose();
+
+        predicted_belief.dimension(filtered_belief.dimension());
+        predicted_belief.mean(A * filtered_belief.mean() + B * input);
+        predicted_belief.covariance(A * cross_covariance + Q);
+    }
+    /** \endcond */
+};
+
+/**
+ * \ingroup gaussian_smoother
+ *
+ * \brief Sigma point Rauch-Tung-Striebel smoother, e.g. the unscented
+ *        smoother if \a Quadrature is the UnscentedQuadrature.
+ *
+ * The smoother is the counterpart of the sigma point GaussianFilter for
+ * transitions with additive noise. The prediction and the cross covariance
+ * are computed from the sigma points \f$X_i\f$ of the filtered belief and
+ * their images \f$Z_i = f(X_i, u_k)\f$, i.e.
+ *
+ * \f$ \bar{\Sigma}_{k+1} = \sum_i w_i (Z_i - \bar{\mu})(Z_i - \bar{\mu})^T
+ *                         + Q \f$ and
+ * \f$ C_{k+1} = \sum_i w_i (X_i - \mu_k)(Z_i - \bar{\mu})^T \f$,
+ *
+ * see internal::GaussianSmootherBase for the recursion.
+ */
+template <typename Transition, typename Quadrature>
+class GaussianSmoother<Transition, Quadrature>
+    : public internal::GaussianSmootherBase<Transition>
+{
+private:
+    /** \cond internal */
+    typedef internal::GaussianSmootherBase<Transition> Base;
+    /** \endcond */
+
+public:
+    typedef typename Base::State State;
+    typedef typename Base::Input Input;
+    typedef typename Base::Belief Belief;
+    typedef typename Base::SecondMoment SecondMoment;
+
+public:
+    GaussianSmoother(const Transition& transition,
+                     const Quadrature& quadrature)
+        : Base(transition),
+          quadrature_(quadrature)
+    { }
+
+    Quadrature& quadrature()
+    {
+        return quadrature_;
+    }
+
+    const Quadrature& quadrature() const
+    {
+        return quadrature_;
+    }
+
+    virtual std::string name() const
+    {
+        return "GaussianSmoother<"
+                + this->list_arguments(this->transition().name(),
+                                       "Quadrature")
+                + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Sigma point Rauch-Tung-Striebel smoother with"
+                + this->list_descriptions(this->transition().description());
+    }
+
+protected:
+    /** \cond internal */
+    enum : signed int
+    {
+        NumberOfPoints = Quadrature::template Size<State>::Value
+    };
+
+    void predict(const Belief& filtered_belief,
+                 const Input& input,
+                 Belief& predicted_belief,
+                 SecondMoment& cross_covariance) override
+    {
+        auto f = [&](const State& x)
+        {
+            return this->transition_.expected_state(x, input);
+        };
+
+        quadrature_.propergate_gaussian(f, filtered_belief, X_, Z_);
+
+        auto X_c = X_.centered_points();
+        auto Z_c = Z_.centered_points();
+        auto W = X_.covariance_weights_vector();
+
+        cross_covariance.noalias() = X_c * W.asDiagonal() * Z_c.transpose();
+
+        predicted_belief.dimension(filtered_belief.dimension());
+        predicted_belief.mean(Z_.mean());
+        predicted_belief.covariance(
+            Z_c * W.asDiagonal() * Z_c.transpose()
+            + this->transition_.noise_covariance());
+    }
+
+    Quadrature quadrature_;
+    PointSet<State, NumberOfPoints> X_;
+    PointSet<State, NumberOfPoints> Z_;
+    /** \endcond */
+};
+
+/**
+ * \ingroup gaussian_smoother
+ *
+ * \brief Streaming fixed-lag smoother with bounded memory.
+ *
+ * The filtered beliefs are pushed as they are produced by the filter. Once
+ * \a lag newer beliefs are available, the belief of time \f$t - lag\f$ is
+ * smoothed over the window \f$t - lag, \ldots, t\f$ and emitted. Only the
+ * window of \f$lag + 1\f$ beliefs is stored.
+ *
+ * \tparam Smoother  GaussianSmoother providing smooth_step()
+ */
+template <typename Smoother>
+class FixedLagSmoother
+{
+public:
+    typedef typename Smoother::Input Input;
+    typedef typename Smoother::Belief Belief;
+
+public:
+    /**
+     * \param smoother  Smoother performing the backward steps
+     * \param lag       Number of time steps of the look ahead
+     *
+     * \throws Exception if \a lag is negative
+     */
+    FixedLagSmoother(const Smoother& smoother, int lag)
+        : smoother_(smoother),
+          lag_(lag)
+    {
+        if (lag < 0)
+        {
+            fl_throw(Exception("FixedLagSmoother lag must be non-negative"));
+        }
+    }
+
+    /**
+     * \brief Adds the next filtered belief
+     *
+     * \param [in]  filtered_belief  Filtered belief at time t
+     * \param [in]  input            Input of the transition from t - 1 to t.
+     *                               Ignored for the first belief.
+     * \param [out] smoothed_belief  Smoothed belief at time t - lag, if
+     *                               available
+     *
+     * \return True if \a smoothed_belief has been set
+     */
+    bool push(const Belief& filtered_belief,
+              const Input& input,
+              Belief& smoothed_belief)
+    {
+        if (!window_.empty()) inputs_.push_back(input);
+        window_.push_back(filtered_belief);
+
+        if (int(window_.size()) <= lag_) return false;
+
+        smoothed_belief = window_.back();
+        for (int k = int(window_.size()) - 2; k >= 0; --k)
+        {
+            smoother_.smooth_step(window_[k],
+                                  inputs_[k],
+                                  smoothed_belief,
+                                  smoothed_belief);
+        }
+
+        // with a zero lag the window never holds an input
+        window_.pop_front();
+        if (!inputs_.empty()) inputs_.pop_front();
+
+        return true;
+    }
+
+    /**
+     * \brief Smoothes and emits the remaining beliefs of the window, e.g. at
+     *        the end of a log, and resets the smoother
+     *
+     * \param [out] smoothed_beliefs  Smoothed beliefs in chronological order
+     */
+    void flush(std::vector<Belief>& smoothed_beliefs)
+    {
+        smoothed_beliefs.assign(window_.begin(), window_.end());
+
+        for (int k = int(smoothed_beliefs.size()) - 2; k >= 0; --k)
+        {
+            smoother_.smooth_step(smoothed_beliefs[k],
+                                  inputs_[k],
+                                  smoothed_beliefs[k + 1],
+                                  smoothed_beliefs[k]);
+        }
+
+        window_.clear();
+        inputs_.clear();
+    }
+
+    int lag() const
+    {
+        return lag_;
+    }
+
+    Smoother& smoother()
+    {
+        return smoother_;
+    }
+
+    const Smoother& smoother() const
+    {
+        return smoother_;
+    }
+
+protected:
+    /** \cond internal */
+    Smoother smoother_;
+    int lag_;
+
+    /* window of filtered beliefs and the inputs between them */
+    std::deque<Belief> window_;
+    std::deque<Input> inputs_;
+    /** \endcond */
+};
+
+}
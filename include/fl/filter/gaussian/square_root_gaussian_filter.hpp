@@ -0,0 +1,270 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file square_root_gaussian_filter.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <string>
+
+#include <fl/util/types.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/filter/filter_interface.hpp>
+#include <fl/distribution/gaussian.hpp>
+
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+namespace fl
+{
+
+// Forward declaration
+template <typename LinearTransition, typename LinearSensor>
+class SquareRootGaussianFilter;
+
+/**
+ * \internal
+ * \ingroup linear_gaussian_filter
+ *
+ * Traits of the square root Kalman filter
+ */
+template <typename LinearTransition, typename LinearSensor>
+struct Traits<SquareRootGaussianFilter<LinearTransition, LinearSensor>>
+{
+    typedef typename LinearTransition::State State;
+    typedef typename LinearTransition::Input Input;
+    typedef typename LinearSensor::Obsrv Obsrv;
+    typedef Gaussian<State> Belief;
+};
+
+/**
+ * \ingroup linear_gaussian_filter
+ *
+ * \brief Square root form of the Kalman filter.
+ *
+ * The filter propagates the lower triangular factor \f$L\f$ of the state
+ * covariance \f$\Sigma = L L^T\f$ instead of the covariance itself. The
+ * factor is read from and written to Gaussian::square_root(), hence the
+ * belief is never re-factorized once the filter runs on it. The covariance
+ * represented by the factor is symmetric and positive semi-definite by
+ * construction, irrespective of round-off errors.
+ *
+ * Both steps triangularize a pre-array by a QR decomposition. The prediction
+ * uses
+ *
+ * \f[ \begin{bmatrix} A L & N \end{bmatrix}^T = Q R,
+ *     \quad \bar{L} = R^T \f]
+ *
+ * with the transition noise matrix \f$N\f$, \f$Q_{noise} = N N^T\f$. The
+ * update triangularizes
+ *
+ * \f[ \begin{bmatrix} N_y & H \bar{L} \\ 0 & \bar{L} \end{bmatrix}
+ *     \Theta =
+ *     \begin{bmatrix} X & 0 \\ Y & \hat{L} \end{bmatrix} \f]
+ *
+ * with the sensor noise matrix \f$N_y\f$. The lower right block is the
+ * posterior factor \f$\hat{L}\f$ and the gain \f$K = Y X^{-1}\f$ is applied
+ * by a triangular solve, i.e.
+ * \f$\hat{x} = \bar{x} + Y X^{-1} (y - H \bar{x})\f$.
+ */
+template <typename LinearTransition, typename LinearSensor>
+class SquareRootGaussianFilter
+    : public FilterInterface<
+                 SquareRootGaussianFilter<LinearTransition, LinearSensor>>
+{
+public:
+    typedef typename LinearTransition::State State;
+    typedef typename LinearTransition::Input Input;
+    typedef typename LinearSensor::Obsrv Obsrv;
+    typedef Gaussian<State> Belief;
+
+public:
+    /**
+     * Creates a square root Kalman filter
+     *
+     * \param transition    Process model instance
+     * \param sensor        Obsrv model instance
+     */
+    SquareRootGaussianFilter(const LinearTransition& transition,
+                             const LinearSensor& sensor)
+        : transition_(transition),
+          sensor_(sensor)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~SquareRootGaussianFilter() noexcept { }
+
+    /**
+     * \copydoc FilterInterface::predict
+     *
+     * Computes \f$\bar{x} = A \hat{x} + B u\f$ and the predicted factor
+     * \f$\bar{L}\f$ from the QR decomposition of \f$[A \hat{L}, N]^T\f$.
+     */
+    virtual void predict(const Belief& prior_belief,
+                         const Input& input,
+                         Belief& predicted_belief)
+    {
+        const auto& A = transition_.dynamics_matrix();
+        const auto& B = transition_.input_matrix();
+        const auto& N = transition_.noise_matrix();
+
+        const int dim = A.rows();
+        const int noise_dim = N.cols();
+
+        pre_array_.resize(dim + noise_dim, dim);
+        pre_array_.topRows(dim).noalias() =
+            (A * prior_belief.square_root()).transpose();
+        pre_array_.bottomRows(noise_dim) = N.transpose();
+
+        triangularize(pre_array_, dim, factor_);
+
+        predicted_belief.mean(A * prior_belief.mean() + B * input);
+        predicted_belief.square_root(factor_);
+    }
+
+    /**
+     * \copydoc FilterInterface::update
+     *
+     * Triangularizes the joint pre-array of the observation and the state.
+     * The innovation is whitened by a triangular solve with the factor
+     * \f$X\f$ of the innovation covariance instead of inverting it.
+     */
+    virtual void update(const Belief& predicted_belief,
+                        const Obsrv& y,
+                        Belief& posterior_belief)
+    {
+        const auto& H = sensor_.sensor_matrix();
+        const auto N = sensor_.noise_matrix();
+        const auto& L = predicted_belief.square_root();
+
+        const int dim = L.rows();
+        const int obsrv_dim = H.rows();
+        const int noise_dim = N.cols();
+
+        // pre-array transposed, [N_y, H L; 0, L]^T
+        pre_array_.setZero(noise_dim + dim, obsrv_dim + dim);
+        pre_array_.topLeftCorner(noise_dim, obsrv_dim) = N.transpose();
+        pre_array_.bottomLeftCorner(dim, obsrv_dim).noalias() =
+            (H * L).transpose();
+        pre_array_.bottomRightCorner(dim, dim) = L.transpose();
+
+        triangularize(pre_array_, obsrv_dim + dim, post_array_);
+
+        innovation_ = y - H * predicted_belief.mean();
+        post_array_.topLeftCorner(obsrv_dim, obsrv_dim)
+            .template triangularView<Eigen::Lower>()
+            .solveInPlace(innovation_);
+
+        factor_ = post_array_.bottomRightCorner(dim, dim);
+
+        posterior_belief.mean(
+            predicted_belief.mean()
+            + post_array_.bottomLeftCorner(dim, obsrv_dim) * innovation_);
+        posterior_belief.square_root(factor_);
+    }
+
+    virtual Belief create_belief() const
+    {
+        auto belief = Belief(transition().state_dimension());
+        return belief;
+    }
+
+    virtual std::string name() const
+    {
+        return "SquareRootGaussianFilter<"
+                + this->list_arguments(
+                            transition().name(),
+                            sensor().name())
+                + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Square root form of the linear Gaussian filter (the Kalman "
+               "Filter) with"
+                + this->list_descriptions(
+                            transition().description(),
+                            sensor().description());
+    }
+
+    LinearTransition& transition()
+    {
+        return transition_;
+    }
+
+    LinearSensor& sensor()
+    {
+        return sensor_;
+    }
+
+    const LinearTransition& transition() const
+    {
+        return transition_;
+    }
+
+    const LinearSensor& sensor() const
+    {
+        return sensor_;
+    }
+
+protected:
+    /** \cond internal */
+    typedef Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic> DynamicMatrix;
+    typedef Eigen::Matrix<Real, Eigen::Dynamic, 1> DynamicVector;
+
+    /**
+     * \brief Computes the lower triangular \a size x \a size factor \f$L\f$
+     *        with \f$L L^T = M^T M\f$ of the transposed pre-array \f$M\f$,
+     *        i.e. the transposed R factor of its QR decomposition. The
+     *        columns are signed such that the diagonal is non-negative.
+     */
+    template <typename Factor>
+    void triangularize(const DynamicMatrix& pre_array,
+                       int size,
+                       Factor& factor)
+    {
+        qr_.compute(pre_array);
+
+        factor = qr_.matrixQR()
+                    .topLeftCorner(size, size)
+                    .template triangularView<Eigen::Upper>()
+                    .transpose();
+
+        for (int i = 0; i < size; ++i)
+        {
+            if (factor(i, i) < Real(0)) factor.col(i) *= Real(-1);
+        }
+    }
+
+    LinearTransition transition_;
+    LinearSensor sensor_;
+
+    /* buffers */
+    DynamicMatrix pre_array_;
+    DynamicMatrix post_array_;
+    DynamicVector innovation_;
+    typename Belief::SecondMoment factor_;
+    Eigen::HouseholderQR<DynamicMatrix> qr_;
+    /** \endcond */
+};
+
+}
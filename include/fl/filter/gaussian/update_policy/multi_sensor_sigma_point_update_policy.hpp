@@ -29,6 +29,7 @@
 #include <fl/model/sensor/joint_sensor_iid.hpp>
 #include <fl/filter/gaussian/transform/point_set.hpp>
 #include <fl/filter/gaussian/quadrature/sigma_point_quadrature.hpp>
+#include <fl/filter/gaussian/gaussian_conditioning.hpp>
 
 namespace fl
 {
@@ -161,7 +162,10 @@ public:
         auto W = p_X.covariance_weights_vector().asDiagonal();
         auto mu_x = p_X.mean();
         auto X = p_X.centered_points();
-        auto c_xx_inv = (X * W * X.transpose()).inverse().eval();
+        auto c_xx = (X * W * X.transpose()).eval();
+        auto c_xx_inv = c_xx.llt().solve(
+                            decltype(c_xx)::Identity(c_xx.rows(), c_xx.cols())
+                        ).eval();
 
         /* ------------------------------------------ */
         /* - Temporary accumulators which will be   - */
@@ -216,8 +220,7 @@ public:
         /* ------------------------------------------ */
         // make sure the posterior has the correct dimension
         posterior_belief.dimension(prior_belief.dimension());
-        posterior_belief.covariance(C.inverse());
-        posterior_belief.mean(mu_x + posterior_belief.covariance() * D);
+        set_information_posterior(mu_x, C, D, posterior_belief);
     }
 
     virtual std::string name() const
@@ -28,6 +28,7 @@
 #include <fl/model/sensor/joint_sensor_iid.hpp>
 #include <fl/filter/gaussian/transform/point_set.hpp>
 #include <fl/filter/gaussian/quadrature/sigma_point_quadrature.hpp>
+#include <fl/filter/gaussian/gaussian_conditioning.hpp>
 
 namespace fl
 {
@@ -132,7 +133,9 @@ public:
 
         auto W = p_X.covariance_weights_vector().asDiagonal();
         auto c_xx = (X * W * X.transpose()).eval();
-        auto c_xx_inv = c_xx.inverse().eval();
+        auto c_xx_inv = c_xx.llt().solve(
+                            decltype(c_xx)::Identity(c_xx.rows(), c_xx.cols())
+                        ).eval();
 
         auto C = c_xx_inv;
         auto D = State();
@@ -215,8 +218,7 @@ public:
         /* - Update belief according to PAPER REF   - */
         /* ------------------------------------------ */
         posterior_belief.dimension(prior_belief.dimension());
-        posterior_belief.covariance(C.inverse());
-        posterior_belief.mean(mu_x + posterior_belief.covariance() * D);
+        set_information_posterior(mu_x, C, D, posterior_belief);
     }
 
     virtual std::string name() const
@@ -22,11 +22,14 @@
 
 #include <Eigen/Dense>
 
+#include <vector>
+
 #include <fl/util/meta.hpp>
 #include <fl/util/traits.hpp>
 #include <fl/util/descriptor.hpp>
 #include <fl/filter/gaussian/transform/point_set.hpp>
 #include <fl/filter/gaussian/quadrature/sigma_point_quadrature.hpp>
+#include <fl/filter/gaussian/gaussian_conditioning.hpp>
 
 namespace fl
 {
@@ -66,6 +69,77 @@ public:
                     const Belief& prior_belief,
                     const Obsrv& obsrv,
                     Belief& posterior_belief)
+    {
+        update(obsrv_function,
+               quadrature,
+               prior_belief,
+               obsrv,
+               Real(1),
+               posterior_belief);
+    }
+
+    /**
+     * \brief Fuses the observations \a obsrvs of the sensor in a single
+     *        sigma point pass by updating once with their sample mean and the
+     *        noise variances divided by their number.
+     */
+    template <
+        typename Belief,
+        typename Allocator
+    >
+    void operator()(const AdditiveUncorrelatedObsrvFunction& obsrv_function,
+                    const SigmaPointQuadrature& quadrature,
+                    const Belief& prior_belief,
+                    const std::vector<Obsrv, Allocator>& obsrvs,
+                    Belief& posterior_belief)
+    {
+        if (obsrvs.empty())
+        {
+            posterior_belief = prior_belief;
+            return;
+        }
+
+        Obsrv obsrv = obsrvs[0];
+        for (std::size_t i = 1; i < obsrvs.size(); ++i) obsrv += obsrvs[i];
+        obsrv /= Real(obsrvs.size());
+
+        update(obsrv_function,
+               quadrature,
+               prior_belief,
+               obsrv,
+               Real(1) / Real(obsrvs.size()),
+               posterior_belief);
+    }
+
+    virtual std::string name() const
+    {
+        return "SigmaPointUpdatePolicy<"
+            + this->list_arguments(
+                 "SigmaPointQuadrature",
+                 "AdditiveUncorrelated<AdditiveUncorrelatedSensorFunction>")
+            + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Sigma Point based filter update policy for observation model"
+               " with additive uncorrelated noise";
+    }
+
+protected:
+    /**
+     * \brief Sigma point update with the noise variances of the sensor
+     *        scaled by \a noise_scale
+     */
+    template <
+        typename Belief
+    >
+    void update(const AdditiveUncorrelatedObsrvFunction& obsrv_function,
+                const SigmaPointQuadrature& quadrature,
+                const Belief& prior_belief,
+                const Obsrv& obsrv,
+                Real noise_scale,
+                Belief& posterior_belief)
     {
         auto&& h = [&](const State& x)
         {
@@ -80,6 +154,7 @@ public:
                 .diagonal()
                 .cwiseInverse()
                 .eval();
+        R_inv /= noise_scale;
 
         auto W_inv =
             X.covariance_weights_vector()
@@ -94,32 +169,22 @@ public:
 
         auto C = (Y_c.transpose() * R_inv.asDiagonal() * Y_c).eval();
         C += W_inv.asDiagonal();
-        C = C.inverse();
+
+        // C may be indefinite for negative sigma point weights
+        auto ldlt = C.ldlt();
 
         auto correction = (
-           X_c * C * Y_c.transpose() *  R_inv.asDiagonal() * innovation).eval();
+           X_c * ldlt.solve(
+                     Y_c.transpose() * R_inv.asDiagonal() * innovation)).eval();
+
+        auto cov_xx = (X_c * ldlt.solve(X_c.transpose())).eval();
+        cov_xx = (0.5 * (cov_xx + cov_xx.transpose())).eval();
 
         posterior_belief.dimension(prior_belief.dimension());
         posterior_belief.mean(X.mean() + correction);
-        posterior_belief.covariance(X_c * C * X_c.transpose());
+        set_factorized_covariance(posterior_belief, cov_xx);
     }
 
-    virtual std::string name() const
-    {
-        return "SigmaPointUpdatePolicy<"
-            + this->list_arguments(
-                 "SigmaPointQuadrature",
-                 "AdditiveUncorrelated<AdditiveUncorrelatedSensorFunction>")
-            + ">";
-    }
-
-    virtual std::string description() const
-    {
-        return "Sigma Point based filter update policy for observation model"
-               " with additive uncorrelated noise";
-    }
-
-protected:
     StatePointSet X;
     ObsrvPointSet Z;
 };
@@ -22,11 +22,14 @@
 
 #include <Eigen/Dense>
 
+#include <vector>
+
 #include <fl/util/meta.hpp>
 #include <fl/util/traits.hpp>
 #include <fl/util/descriptor.hpp>
 #include <fl/filter/gaussian/transform/point_set.hpp>
 #include <fl/filter/gaussian/quadrature/sigma_point_quadrature.hpp>
+#include <fl/filter/gaussian/gaussian_conditioning.hpp>
 
 namespace fl
 {
@@ -64,6 +67,80 @@ public:
                     const Belief& prior_belief,
                     const Obsrv& obsrv,
                     Belief& posterior_belief)
+    {
+        update(obsrv_function,
+               quadrature,
+               prior_belief,
+               obsrv,
+               Real(1),
+               posterior_belief);
+    }
+
+    /**
+     * \brief Fuses the observations \a obsrvs of the sensor in a single
+     *        sigma point pass.
+     *
+     * With additive noise, the sample mean of \f$N\f$ observations is
+     * \f$\bar{y} = h(x) + \bar{v}\f$ with \f$\bar{v} \sim {\cal N}(0, R/N)\f$.
+     * The belief is updated once with \f$\bar{y}\f$ and \f$R/N\f$.
+     */
+    template <
+        typename Belief,
+        typename Allocator
+    >
+    void operator()(const AdditiveSensorFunction& obsrv_function,
+                    const SigmaPointQuadrature& quadrature,
+                    const Belief& prior_belief,
+                    const std::vector<Obsrv, Allocator>& obsrvs,
+                    Belief& posterior_belief)
+    {
+        if (obsrvs.empty())
+        {
+            posterior_belief = prior_belief;
+            return;
+        }
+
+        Obsrv obsrv = obsrvs[0];
+        for (std::size_t i = 1; i < obsrvs.size(); ++i) obsrv += obsrvs[i];
+        obsrv /= Real(obsrvs.size());
+
+        update(obsrv_function,
+               quadrature,
+               prior_belief,
+               obsrv,
+               Real(1) / Real(obsrvs.size()),
+               posterior_belief);
+    }
+
+    virtual std::string name() const
+    {
+        return "SigmaPointUpdatePolicy<"
+                + this->list_arguments(
+                       "SigmaPointQuadrature",
+                       "Additive<AdditiveSensorFunction>")
+                + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Sigma Point based filter update policy for observation model"
+               " with additive noise";
+    }
+
+protected:
+    /**
+     * \brief Sigma point update with the noise covariance of the sensor
+     *        scaled by \a noise_scale
+     */
+    template <
+        typename Belief
+    >
+    void update(const AdditiveSensorFunction& obsrv_function,
+                const SigmaPointQuadrature& quadrature,
+                const Belief& prior_belief,
+                const Obsrv& obsrv,
+                Real noise_scale,
+                Belief& posterior_belief)
     {
         auto&& h = [&](const State& x)
         {
@@ -80,31 +157,17 @@ public:
         auto innovation = (obsrv - prediction).eval();
         auto cov_xx = (X_c * W.asDiagonal() * X_c.transpose()).eval();
         auto cov_yy = (Z_c * W.asDiagonal() * Z_c.transpose()
-                       + obsrv_function.noise_covariance()).eval();
+                       + noise_scale * obsrv_function.noise_covariance()).eval();
         auto cov_xy = (X_c * W.asDiagonal() * Z_c.transpose()).eval();
-        auto K = (cov_xy * cov_yy.inverse()).eval();
 
-        posterior_belief.dimension(prior_belief.dimension());
-        posterior_belief.mean(X.mean() + K * innovation);
-        posterior_belief.covariance(cov_xx - K * cov_yy * K.transpose());
-    }
+        auto mean = X.mean().eval();
+        condition_gaussian(cov_xy, cov_yy, innovation, mean, cov_xx);
 
-    virtual std::string name() const
-    {
-        return "SigmaPointUpdatePolicy<"
-                + this->list_arguments(
-                       "SigmaPointQuadrature",
-                       "Additive<AdditiveSensorFunction>")
-                + ">";
-    }
-
-    virtual std::string description() const
-    {
-        return "Sigma Point based filter update policy for observation model"
-               " with additive noise";
+        posterior_belief.dimension(prior_belief.dimension());
+        posterior_belief.mean(mean);
+        set_factorized_covariance(posterior_belief, cov_xx);
     }
 
-protected:
     StatePointSet X;
     ObsrvPointSet Z;
 };
@@ -22,11 +22,14 @@
 
 #include <Eigen/Dense>
 
+#include <vector>
+
 #include <fl/util/meta.hpp>
 #include <fl/util/traits.hpp>
 #include <fl/util/descriptor.hpp>
 #include <fl/filter/gaussian/transform/point_set.hpp>
 #include <fl/filter/gaussian/quadrature/sigma_point_quadrature.hpp>
+#include <fl/filter/gaussian/gaussian_conditioning.hpp>
 
 namespace fl
 {
@@ -104,18 +107,37 @@ public:
         auto cov_xx = (X_c * W.asDiagonal() * X_c.transpose()).eval();
         auto cov_yy = (Z_c * W.asDiagonal() * Z_c.transpose()).eval();
         auto cov_xy = (X_c * W.asDiagonal() * Z_c.transpose()).eval();
-        auto cov_yx = cov_xy.transpose().eval();
 
-        auto x_updated = (X.mean() + cov_xy * solve(cov_yy, innovation)).eval();
-        auto cov_xx_updated = (cov_xx - cov_xy * solve(cov_yy, cov_yx)).eval();
+        auto mean = X.mean().eval();
+        condition_gaussian(cov_xy, cov_yy, innovation, mean, cov_xx);
 
         posterior_belief.dimension(prior_belief.dimension());
-        posterior_belief.mean(x_updated);
-        posterior_belief.covariance(cov_xx_updated);
+        posterior_belief.mean(mean);
+        set_factorized_covariance(posterior_belief, cov_xx);
+    }
 
-        //        auto K = (cov_xy * cov_yy.inverse()).eval();
-        //        posterior_belief.mean(X.mean() + K * innovation);
-        //        posterior_belief.covariance(cov_xx - K * cov_yy * K.transpose());
+    /**
+     * \brief Updates the belief with the observations \a obsrvs one after
+     *        another. Non-additive noise does not admit fusing them into a
+     *        single observation.
+     */
+    template <
+        typename Belief,
+        typename Allocator
+    >
+    void operator()(const SensorFunction& obsrv_function,
+                    const SigmaPointQuadrature& quadrature,
+                    const Belief& prior_belief,
+                    const std::vector<Obsrv, Allocator>& obsrvs,
+                    Belief& posterior_belief)
+    {
+        posterior_belief = prior_belief;
+
+        for (const Obsrv& obsrv : obsrvs)
+        {
+            const Belief belief = posterior_belief;
+            (*this)(obsrv_function, quadrature, belief, obsrv, posterior_belief);
+        }
     }
 
     virtual std::string name() const
@@ -0,0 +1,290 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file out_of_sequence_filter.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Core>
+
+#include <string>
+#include <vector>
+
+#include <fl/util/traits.hpp>
+#include <fl/util/descriptor.hpp>
+#include <fl/exception/exception.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup filters
+ *
+ * \brief Runs a filter on measurements which may arrive out of sequence.
+ *
+ * The OutOfSequenceFilter keeps the history of the last \a capacity time
+ * steps of the wrapped filter in a ring buffer. Each step stores the input
+ * leading to it, the predicted belief, the observations of the step and the
+ * posterior belief. A delayed observation is inserted into the step it
+ * belongs to. The filter is then re-run from this step on, i.e. the
+ * posterior of the step is recomputed from its predicted belief by
+ * FilterInterface::batch_update() and all newer steps are predicted and
+ * updated again. Steps before the insertion point are not touched.
+ *
+ * All history storage is allocated in the constructor. Observations of a
+ * step are stored in a buffer with the reserved capacity
+ * \a obsrvs_per_step, which only grows if a step receives more
+ * observations.
+ *
+ * \tparam Filter  Filter implementing the FilterInterface
+ */
+template <typename Filter>
+class OutOfSequenceFilter
+    : public Descriptor
+{
+public:
+    typedef typename Filter::State State;
+    typedef typename Filter::Input Input;
+    typedef typename Filter::Obsrv Obsrv;
+    typedef typename Filter::Belief Belief;
+    typedef typename Filter::Obsrvs Obsrvs;
+
+public:
+    /**
+     * \param filter            Wrapped filter
+     * \param initial_belief    Belief of the first time step
+     * \param capacity          Number of time steps kept in the history. A
+     *                          delayed observation can be inserted up to
+     *                          \a capacity - 1 steps into the past.
+     * \param obsrvs_per_step   Number of observations per step for which
+     *                          storage is reserved
+     *
+     * \throws Exception if \a capacity is not positive
+     */
+    OutOfSequenceFilter(const Filter& filter,
+                        const Belief& initial_belief,
+                        int capacity,
+                        int obsrvs_per_step = 1)
+        : filter_(filter)
+    {
+        if (capacity < 1)
+        {
+            fl_throw(Exception("OutOfSequenceFilter capacity must be "
+                               "positive"));
+        }
+
+        history_.resize(capacity);
+        for (auto& step : history_)
+        {
+            step.predicted_belief = initial_belief;
+            step.posterior_belief = initial_belief;
+            step.obsrvs.reserve(obsrvs_per_step);
+        }
+
+        reset(initial_belief);
+    }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~OutOfSequenceFilter() noexcept { }
+
+    /**
+     * \brief Clears the history and restarts from \a initial_belief
+     */
+    void reset(const Belief& initial_belief)
+    {
+        newest_ = 0;
+        size_ = 1;
+
+        Step& step = history_[newest_];
+        step.predicted_belief = initial_belief;
+        step.posterior_belief = initial_belief;
+        step.obsrvs.clear();
+    }
+
+    /**
+     * \brief Starts the next time step by predicting the current belief.
+     *        The oldest step is dropped if the history is full.
+     *
+     * \param input  Control input leading to the new step
+     */
+    void predict(const Input& input)
+    {
+        const Step& previous = history_[newest_];
+
+        newest_ = index(-1);
+        if (size_ < capacity()) ++size_;
+
+        Step& step = history_[newest_];
+        step.input = input;
+        step.obsrvs.clear();
+        filter_.predict(previous.posterior_belief,
+                        input,
+                        step.predicted_belief);
+        step.posterior_belief = step.predicted_belief;
+    }
+
+    /**
+     * \brief Updates the current time step with an in-sequence observation
+     */
+    void update(const Obsrv& obsrv)
+    {
+        Step& step = history_[newest_];
+        step.obsrvs.push_back(obsrv);
+
+        const Belief& belief = step.posterior_belief;
+        filter_.update(belief, obsrv, step.posterior_belief);
+    }
+
+    /**
+     * \brief Inserts an observation of the time step \a delay steps before
+     *        the current one and re-runs the filter from that step on.
+     *
+     * \param obsrv  Delayed observation
+     * \param delay  Number of steps the observation is late. 0 is the
+     *               current step.
+     *
+     * \return False if the step of the observation is no longer part of the
+     *         history. The observation is discarded in this case.
+     */
+    bool update(const Obsrv& obsrv, int delay)
+    {
+        if (delay < 0 || delay >= size_) return false;
+        if (delay == 0)
+        {
+            update(obsrv);
+            return true;
+        }
+
+        Step& step = history_[index(delay)];
+        step.obsrvs.push_back(obsrv);
+        filter_.batch_update(step.predicted_belief,
+                             step.obsrvs,
+                             step.posterior_belief);
+
+        for (int k = delay - 1; k >= 0; --k)
+        {
+            const Step& previous = history_[index(k + 1)];
+            Step& next = history_[index(k)];
+
+            filter_.predict(previous.posterior_belief,
+                            next.input,
+                            next.predicted_belief);
+            filter_.batch_update(next.predicted_belief,
+                                 next.obsrvs,
+                                 next.posterior_belief);
+        }
+
+        return true;
+    }
+
+    /**
+     * \return Posterior belief of the current time step
+     */
+    const Belief& belief() const
+    {
+        return history_[newest_].posterior_belief;
+    }
+
+    /**
+     * \return Posterior belief of the time step \a delay steps before the
+     *         current one
+     *
+     * \throws Exception if the step is not part of the history
+     */
+    const Belief& belief(int delay) const
+    {
+        if (delay < 0 || delay >= size_)
+        {
+            fl_throw(Exception("Time step is not part of the history"));
+        }
+
+        return history_[index(delay)].posterior_belief;
+    }
+
+    /**
+     * \return Number of time steps in the history
+     */
+    int size() const
+    {
+        return size_;
+    }
+
+    /**
+     * \return Maximum number of time steps in the history
+     */
+    int capacity() const
+    {
+        return history_.size();
+    }
+
+    Filter& filter()
+    {
+        return filter_;
+    }
+
+    const Filter& filter() const
+    {
+        return filter_;
+    }
+
+    virtual std::string name() const
+    {
+        return "OutOfSequenceFilter<"
+                + this->list_arguments(filter_.name())
+                + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Out of sequence measurement filter with"
+                + this->list_descriptions(filter_.description());
+    }
+
+protected:
+    /** \cond internal */
+    /**
+     * \brief Time step of the history
+     */
+    struct Step
+    {
+        Input input;
+        Belief predicted_belief;
+        Belief posterior_belief;
+        Obsrvs obsrvs;
+    };
+
+    /**
+     * \return Ring buffer index of the step \a delay steps before the
+     *         current one
+     */
+    int index(int delay) const
+    {
+        const int n = capacity();
+        return ((newest_ - delay) % n + n) % n;
+    }
+
+    Filter filter_;
+    std::vector<Step, Eigen::aligned_allocator<Step>> history_;
+    int newest_;
+    int size_;
+    /** \endcond */
+};
+
+}
@@ -0,0 +1,252 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file auxiliary_particle_filter.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <fl/util/traits.hpp>
+#include <fl/filter/particle/particle_filter.hpp>
+
+namespace fl
+{
+
+// Auxiliary particle filter forward declaration
+template <typename...> class AuxiliaryParticleFilter;
+
+/**
+ * \internal
+ * \ingroup particle_filter
+ *
+ * AuxiliaryParticleFilter Traits. These are the traits of the underlying
+ * ParticleFilter.
+ */
+template <typename... Arguments>
+struct Traits<AuxiliaryParticleFilter<Arguments...>>
+    : Traits<ParticleFilter<Arguments...>>
+{ };
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Auxiliary particle filter (Pitt and Shephard) which selects the
+ *        particles to propagate by means of look-ahead weights.
+ *
+ * A plain ParticleFilter propagates the particles blindly and only weights
+ * them once the observation is taken into account. If the observation is
+ * informative, most propagated particles end up with a negligible weight.
+ * The auxiliary particle filter instead looks ahead within
+ * predict_and_update():
+ *
+ *  1. Each particle \f$x_i\f$ is moved to the noise-free prediction
+ *     \f$\mu_i = f(x_i, 0, u)\f$ of the transition.
+ *  2. The first stage weights are \f$\lambda_i \propto w_i\, p(y \mid
+ *     \mu_i)\f$. The particles to propagate, the ancestors \f$a_i\f$, are
+ *     selected according to \f$\lambda\f$ using the Resampling policy.
+ *  3. The selected particles are propagated with process noise,
+ *     \f$x'_i = f(x_{a_i}, v_i, u)\f$.
+ *  4. The second stage weights correct for the look-ahead,
+ *     \f$w'_i \propto p(y \mid x'_i) / p(y \mid \mu_{a_i})\f$.
+ *
+ * Hence, particles are only spent on regions of the state space which are
+ * consistent with the upcoming observation. The filter uses the same
+ * TransitionFunction and SensorDensity interfaces as the ParticleFilter.
+ * Separate predict() and update() calls behave like the ParticleFilter
+ * since the look-ahead requires both the input and the observation.
+ *
+ * \tparam Resampling      Policy selecting the ancestors in the first stage
+ * \tparam ParticleBelief  Particle storage, either DiscreteDistribution or
+ *                         DiscreteMatrixDistribution
+ */
+template<
+    typename TransitionFunction,
+    typename SensorDensity,
+    typename Resampling,
+    typename ParticleBelief
+>
+class AuxiliaryParticleFilter<
+          TransitionFunction, SensorDensity, Resampling, ParticleBelief>
+    : public ParticleFilter<
+                 TransitionFunction, SensorDensity, Resampling, ParticleBelief>
+{
+private:
+    /** \cond internal */
+    typedef ParticleFilter<
+                TransitionFunction, SensorDensity, Resampling, ParticleBelief
+            > Base;
+
+    typedef typename TransitionFunction::Noise StateNoise;
+    /** \endcond */
+
+public:
+    typedef typename Base::State  State;
+    typedef typename Base::Input  Input;
+    typedef typename Base::Obsrv  Obsrv;
+    typedef typename Base::Belief Belief;
+
+public:
+    AuxiliaryParticleFilter(const TransitionFunction& transition,
+                            const SensorDensity& sensor,
+                            const Real& max_kl_divergence = 1.0,
+                            const Resampling& resampling = Resampling())
+        : Base(transition, sensor, max_kl_divergence, resampling)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~AuxiliaryParticleFilter() noexcept { }
+
+    /**
+     * \brief Performs the auxiliary prediction and update step as described
+     *        in the class documentation. The \a posterior_belief may be the
+     *        same object as the \a prior_belief.
+     */
+    virtual void predict_and_update(const Belief& prior_belief,
+                                    const Input& input,
+                                    const Obsrv& obsrv,
+                                    Belief& posterior_belief)
+    {
+        const int size = prior_belief.size();
+
+        // noise-free predictions mu_i = f(x_i, 0, u)
+        zero_noise_.setZero(this->transition_.noise_dimension());
+
+        look_ahead_belief_ = prior_belief;
+        for(int i = 0; i < size; i++)
+        {
+            look_ahead_belief_.location(i) =
+                this->transition_.state(prior_belief.location(i),
+                                        zero_noise_,
+                                        input);
+        }
+
+        // first stage weights lambda_i ~ w_i p(y | mu_i)
+        this->log_likelihoods(obsrv, look_ahead_belief_, look_ahead_);
+        look_ahead_belief_.delta_log_prob_mass(look_ahead_);
+
+        // select the ancestors and gather their unpredicted states
+        ancestors_.resize(size);
+        ancestor_look_ahead_.resize(size);
+        this->resampling_(look_ahead_belief_.cumulative_distribution(),
+                          ancestors_);
+
+        for(int i = 0; i < size; i++)
+        {
+            look_ahead_belief_.location(i) =
+                prior_belief.location(ancestors_[i]);
+            ancestor_look_ahead_[i] = look_ahead_[ancestors_[i]];
+        }
+        look_ahead_belief_.set_uniform();
+
+        // propagate the ancestors with process noise
+        this->predict(look_ahead_belief_, input, posterior_belief);
+
+        // second stage weights w'_i ~ p(y | x'_i) / p(y | mu_{a_i})
+        this->log_likelihoods(obsrv, posterior_belief, this->log_likelihoods_);
+        this->log_likelihoods_ -= ancestor_look_ahead_;
+        posterior_belief.delta_log_prob_mass(this->log_likelihoods_);
+    }
+
+    virtual std::string name() const
+    {
+        return "AuxiliaryParticleFilter<"
+                + this->list_arguments(
+                            this->transition().name(),
+                            this->sensor().name(),
+                            this->resampling().name())
+                + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Auxiliary ParticleFilter with look-ahead weights and"
+                + this->list_descriptions(
+                            this->transition().description(),
+                            this->sensor().description(),
+                            this->resampling().description());
+    }
+
+protected:
+    /** \cond internal */
+    /* buffers reused across filter steps */
+    Belief look_ahead_belief_;
+    StateNoise zero_noise_;
+    typename Belief::Function look_ahead_;
+    typename Belief::Function ancestor_look_ahead_;
+    typename Belief::IndexArray ancestors_;
+    /** \endcond */
+};
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Auxiliary particle filter storing the particles in a
+ *        DiscreteDistribution
+ */
+template<
+    typename TransitionFunction,
+    typename SensorDensity,
+    typename Resampling
+>
+class AuxiliaryParticleFilter<TransitionFunction, SensorDensity, Resampling>
+    : public AuxiliaryParticleFilter<
+                 TransitionFunction,
+                 SensorDensity,
+                 Resampling,
+                 DiscreteDistribution<typename TransitionFunction::State>>
+{
+public:
+    AuxiliaryParticleFilter(const TransitionFunction& transition,
+                            const SensorDensity& sensor,
+                            const Real& max_kl_divergence = 1.0,
+                            const Resampling& resampling = Resampling())
+        : AuxiliaryParticleFilter<
+              TransitionFunction,
+              SensorDensity,
+              Resampling,
+              DiscreteDistribution<typename TransitionFunction::State>>(
+                  transition, sensor, max_kl_divergence, resampling)
+    { }
+};
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Auxiliary particle filter using systematic resampling to select the
+ *        ancestors
+ */
+template<
+    typename TransitionFunction,
+    typename SensorDensity
+>
+class AuxiliaryParticleFilter<TransitionFunction, SensorDensity>
+    : public AuxiliaryParticleFilter<
+                 TransitionFunction, SensorDensity, SystematicResampling>
+{
+public:
+    AuxiliaryParticleFilter(const TransitionFunction& transition,
+                            const SensorDensity& sensor,
+                            const Real& max_kl_divergence = 1.0)
+        : AuxiliaryParticleFilter<
+              TransitionFunction, SensorDensity, SystematicResampling>(
+                  transition, sensor, max_kl_divergence)
+    { }
+};
+
+}
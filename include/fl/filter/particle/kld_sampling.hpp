@@ -0,0 +1,300 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file kld_sampling.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#include <Eigen/Core>
+
+#include <fl/util/types.hpp>
+#include <fl/util/random.hpp>
+#include <fl/util/descriptor.hpp>
+#include <fl/util/math/general_functions.hpp>
+#include <fl/exception/exception.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief KLD-sampling (Fox, 2003) which adapts the number of particles to
+ *        the spread of the belief.
+ *
+ * Particles are drawn from the weighted belief one by one. Each draw is
+ * assigned to a cell of a regular grid with the edge length bin_size(). After
+ * each draw which occupies a new cell, the required number of particles is
+ * updated to the Wilson-Hilferty approximation of the chi-square quantile
+ *
+ * \f[
+ *   n(k) = \frac{k - 1}{2\epsilon}
+ *          \left(1 - \frac{2}{9(k - 1)}
+ *                + \sqrt{\frac{2}{9(k - 1)}}\, z_{1 - \delta}\right)^3
+ * \f]
+ *
+ * where \f$k\f$ is the number of occupied cells and \f$z_{1 - \delta}\f$ the
+ * upper \f$1 - \delta\f$ quantile of the standard normal distribution. With
+ * probability \f$1 - \delta\f$ the KL divergence between the sample based
+ * approximation and the belief then remains below \f$\epsilon\f$. Drawing
+ * stops once \f$n(k)\f$ draws are reached. The result is clamped to
+ * [min_particles(), max_particles()].
+ *
+ * A diffuse belief occupies many cells and hence requires many particles,
+ * whereas a concentrated belief is represented by few particles.
+ *
+ * The drawn particles are the resampled set the bound applies to. Their
+ * indices are kept, and KldSampling then acts as the resampling policy of
+ * from_distribution(distribution, size, resampling) which gathers exactly
+ * these particles. Hence the draws are multinomial.
+ *
+ * The occupied cells are tracked in an open addressing hash table of the
+ * cell coordinate hashes which is allocated once for max_particles() cells.
+ * Distinct cells with colliding hashes are counted once which can only
+ * underestimate \f$k\f$ marginally.
+ */
+class KldSampling
+    : public Descriptor
+{
+public:
+    /**
+     * \param bin_size       Edge length of the grid cells in state space
+     * \param min_particles  Lower bound of the particle count
+     * \param max_particles  Upper bound of the particle count
+     * \param epsilon        Bound on the KL divergence
+     * \param delta          Probability of exceeding the bound
+     *
+     * \throws Exception if the parameters are inconsistent
+     */
+    KldSampling(Real bin_size,
+                int min_particles,
+                int max_particles,
+                Real epsilon = 0.05,
+                Real delta = 0.01)
+        : bin_size_(bin_size),
+          min_particles_(min_particles),
+          max_particles_(max_particles),
+          epsilon_(epsilon),
+          delta_(delta),
+          drawn_count_(0),
+          generator_(fl::seed()),
+          uniform_distribution_(0.0, 1.0)
+    {
+        if (bin_size <= 0 || epsilon <= 0 || delta <= 0 || delta >= 1)
+        {
+            fl_throw(Exception("KldSampling requires bin_size > 0, "
+                               "epsilon > 0 and 0 < delta < 1"));
+        }
+
+        if (min_particles < 1 || max_particles < min_particles)
+        {
+            fl_throw(Exception("KldSampling requires "
+                               "1 <= min_particles <= max_particles"));
+        }
+
+        z_ = uniform_to_normal(1 - delta_);
+
+        drawn_indices_.resize(max_particles_);
+
+        // at most half of the table is ever occupied
+        std::size_t table_size = 1;
+        while (table_size < 2 * std::size_t(max_particles_)) table_size <<= 1;
+        bin_keys_.resize(table_size);
+        bin_occupied_.resize(table_size);
+    }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~KldSampling() noexcept { }
+
+    /**
+     * \brief Draws particles from the given particle \a belief until their
+     *        number suffices to represent it
+     *
+     * The indices of the drawn particles are kept until the next call, see
+     * operator()(cumulative_distribution, indices).
+     *
+     * \param belief  Weighted particle set, either a DiscreteDistribution or
+     *                a DiscreteMatrixDistribution
+     *
+     * \return Number of drawn particles within
+     *         [min_particles(), max_particles()]
+     */
+    template <typename Belief>
+    int operator()(const Belief& belief) const
+    {
+        const auto& cdf = belief.cumulative_distribution();
+        const int size = belief.size();
+        const Real total = cdf[size - 1];
+
+        std::fill(bin_occupied_.begin(), bin_occupied_.end(), false);
+        int occupied_bins = 0;
+
+        int required = min_particles_;
+        int count = 0;
+        while (count < max_particles_ && count < required)
+        {
+            const Real u = total * uniform_distribution_(generator_);
+            const int i = std::min(
+                int(std::lower_bound(cdf.data(), cdf.data() + size, u)
+                    - cdf.data()),
+                size - 1);
+
+            drawn_indices_[count] = i;
+
+            if (occupy(bin(belief.location(i))))
+            {
+                required = std::max(min_particles_,
+                                    required_particles(++occupied_bins));
+            }
+
+            ++count;
+        }
+
+        drawn_count_ = count;
+
+        return count;
+    }
+
+    /**
+     * \brief Resampling policy interface. Selects the particles drawn by the
+     *        last call of operator()(belief).
+     *
+     * \param [out] indices  Resampled particle indices. The size must be the
+     *                       number returned by operator()(belief).
+     */
+    template <typename CumulativeDistribution, typename IndexArray>
+    void operator()(const CumulativeDistribution& cumulative_distribution,
+                    IndexArray& indices) const
+    {
+        assert(indices.size() == drawn_count_);
+
+        indices = drawn_indices_.head(drawn_count_);
+    }
+
+    /**
+     * \return Number of particles \f$n(k)\f$ required for \a bins occupied
+     *         grid cells, not clamped to [min_particles(), max_particles()]
+     */
+    int required_particles(int bins) const
+    {
+        if (bins < 2) return 1;
+
+        const Real k = bins - 1;
+        const Real a = Real(2) / (Real(9) * k);
+        const Real b = 1 - a + std::sqrt(a) * z_;
+
+        return int(std::ceil(k / (2 * epsilon_) * b * b * b));
+    }
+
+    Real bin_size() const { return bin_size_; }
+    int min_particles() const { return min_particles_; }
+    int max_particles() const { return max_particles_; }
+    Real epsilon() const { return epsilon_; }
+    Real delta() const { return delta_; }
+
+    virtual std::string name() const
+    {
+        return "KldSampling";
+    }
+
+    virtual std::string description() const
+    {
+        return "KLD-sampling adapting the number of particles to the "
+               "spread of the belief";
+    }
+
+protected:
+    /** \cond internal */
+    /**
+     * \return Hash of the grid cell coordinates of the given state
+     */
+    template <typename State>
+    std::size_t bin(const State& state) const
+    {
+        std::hash<long> hash;
+        std::size_t key = 0;
+
+        for (int j = 0; j < state.size(); ++j)
+        {
+            const long cell = long(std::floor(state(j) / bin_size_));
+            key ^= hash(cell) + 0x9e3779b9 + (key << 6) + (key >> 2);
+        }
+
+        return key;
+    }
+
+    /**
+     * \brief Marks the cell with the hash \a key as occupied
+     *
+     * \return False if the cell was occupied already
+     */
+    bool occupy(std::size_t key) const
+    {
+        const std::size_t mask = bin_keys_.size() - 1;
+
+        // Fibonacci hashing spreads the cell hashes over the table
+        std::size_t slot =
+            std::size_t((std::uint64_t(key) * 0x9e3779b97f4a7c15ull) >> 32)
+            & mask;
+
+        while (bin_occupied_[slot])
+        {
+            if (bin_keys_[slot] == key) return false;
+            slot = (slot + 1) & mask;
+        }
+
+        bin_occupied_[slot] = true;
+        bin_keys_[slot] = key;
+        return true;
+    }
+    /** \endcond */
+
+protected:
+    /** \cond internal */
+    Real bin_size_;
+    int min_particles_;
+    int max_particles_;
+    Real epsilon_;
+    Real delta_;
+    Real z_;
+
+    /* indices drawn by the last operator()(belief) */
+    mutable Eigen::Array<int, Eigen::Dynamic, 1> drawn_indices_;
+    mutable int drawn_count_;
+
+    /* hash table of the occupied cells, allocated once */
+    mutable std::vector<std::size_t> bin_keys_;
+    mutable std::vector<char> bin_occupied_;
+
+    mutable fl::mt11213b generator_;
+    mutable std::uniform_real_distribution<Real> uniform_distribution_;
+    /** \endcond */
+};
+
+}
@@ -19,10 +19,23 @@
 #pragma once
 
 
+#include <Eigen/Core>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
 #include <fl/util/traits.hpp>
+#include <fl/util/thread_pool.hpp>
 #include <fl/filter/filter_interface.hpp>
 #include <fl/distribution/discrete_distribution.hpp>
+#include <fl/distribution/discrete_matrix_distribution.hpp>
 #include <fl/distribution/standard_gaussian.hpp>
+#include <fl/filter/particle/kld_sampling.hpp>
+#include <fl/filter/particle/resampling/multinomial_resampling.hpp>
+#include <fl/filter/particle/resampling/systematic_resampling.hpp>
+#include <fl/filter/particle/resampling/stratified_resampling.hpp>
+#include <fl/filter/particle/resampling/residual_resampling.hpp>
 
 namespace fl
 {
@@ -43,28 +56,82 @@ template <typename...> class ParticleFilter;
  */
 template <
     typename TransitionFunction,
-    typename SensorDensity
+    typename SensorDensity,
+    typename Resampling,
+    typename ParticleBelief
 >
-struct Traits<ParticleFilter<TransitionFunction, SensorDensity>>
+struct Traits<
+           ParticleFilter<
+               TransitionFunction, SensorDensity, Resampling, ParticleBelief>>
 {
     typedef typename TransitionFunction::State State;
     typedef typename TransitionFunction::Input Input;
     typedef typename SensorDensity::Obsrv      Obsrv;
-    typedef DiscreteDistribution<State>             Belief;
+    typedef ParticleBelief                     Belief;
 };
 
+/**
+ * \internal
+ * \ingroup particle_filter
+ *
+ * ParticleFilter Traits of the filter using the default particle belief
+ */
+template <
+    typename TransitionFunction,
+    typename SensorDensity,
+    typename Resampling
+>
+struct Traits<ParticleFilter<TransitionFunction, SensorDensity, Resampling>>
+    : Traits<
+          ParticleFilter<
+              TransitionFunction,
+              SensorDensity,
+              Resampling,
+              DiscreteDistribution<typename TransitionFunction::State>>>
+{ };
+
+/**
+ * \internal
+ * \ingroup particle_filter
+ *
+ * ParticleFilter Traits of the default multinomial resampling filter
+ */
+template <
+    typename TransitionFunction,
+    typename SensorDensity
+>
+struct Traits<ParticleFilter<TransitionFunction, SensorDensity>>
+    : Traits<
+          ParticleFilter<
+              TransitionFunction, SensorDensity, MultinomialResampling>>
+{ };
+
 /**
  * \ingroup particle_filter
  *
  * \brief Represents the general particle filter
+ *
+ * \tparam Resampling      Resampling policy which selects the surviving
+ *                         particles once the weights become too concentrated.
+ *                         See MultinomialResampling, SystematicResampling,
+ *                         StratifiedResampling and ResidualResampling.
+ * \tparam ParticleBelief  Particle storage, either DiscreteDistribution or
+ *                         the contiguous DiscreteMatrixDistribution
  */
 template<
     typename TransitionFunction,
-    typename SensorDensity
+    typename SensorDensity,
+    typename Resampling,
+    typename ParticleBelief
 >
-class ParticleFilter<TransitionFunction, SensorDensity>
+class ParticleFilter<
+          TransitionFunction, SensorDensity, Resampling, ParticleBelief>
     : public FilterInterface<
-                 ParticleFilter<TransitionFunction, SensorDensity>>
+                 ParticleFilter<
+                     TransitionFunction,
+                     SensorDensity,
+                     Resampling,
+                     ParticleBelief>>
 {
 private:
     /** \cond internal */
@@ -76,19 +143,80 @@ public:
     typedef typename TransitionFunction::State     State;
     typedef typename TransitionFunction::Input     Input;
     typedef typename SensorDensity::Obsrv          Obsrv;
-    typedef DiscreteDistribution<State>                 Belief;
+    typedef ParticleBelief                         Belief;
 
 public:
     ParticleFilter(const TransitionFunction& transition,
                    const SensorDensity& sensor,
-                   const Real& max_kl_divergence = 1.0)
+                   const Real& max_kl_divergence = 1.0,
+                   const Resampling& resampling = Resampling())
         : transition_(transition),
           sensor_(sensor),
+          resampling_(resampling),
           process_noise_(transition.noise_dimension()),
           obsrv_noise_(sensor.noise_dimension()),
-          max_kl_divergence_(max_kl_divergence)
+          max_kl_divergence_(max_kl_divergence),
+          thread_pool_(new ThreadPool(1))
+    { }
+
+    /**
+     * \brief Copies the models, the settings and the state of the noise
+     *        generators of \a other. The copy runs its own thread pool with
+     *        the same number of threads.
+     */
+    ParticleFilter(const ParticleFilter& other)
+        : FilterInterface<ParticleFilter>(other),
+          transition_(other.transition_),
+          sensor_(other.sensor_),
+          resampling_(other.resampling_),
+          process_noise_(other.process_noise_),
+          obsrv_noise_(other.obsrv_noise_),
+          max_kl_divergence_(other.max_kl_divergence_),
+          thread_pool_(new ThreadPool(other.threads())),
+          kld_sampling_(other.kld_sampling_
+                            ? new KldSampling(*other.kld_sampling_)
+                            : nullptr),
+          transitions_(other.transitions_),
+          sensors_(other.sensors_),
+          process_noises_(other.process_noises_),
+          noise_samples_(other.noise_samples_),
+          log_likelihoods_(other.log_likelihoods_)
     { }
 
+    /**
+     * \brief Assigns the models, the settings and the state of the noise
+     *        generators of \a other. The thread pool is only recreated if
+     *        the number of threads differs.
+     */
+    ParticleFilter& operator=(const ParticleFilter& other)
+    {
+        if (this == &other) return *this;
+
+        transition_ = other.transition_;
+        sensor_ = other.sensor_;
+        resampling_ = other.resampling_;
+        process_noise_ = other.process_noise_;
+        obsrv_noise_ = other.obsrv_noise_;
+        max_kl_divergence_ = other.max_kl_divergence_;
+
+        if (threads() != other.threads())
+        {
+            thread_pool_.reset(new ThreadPool(other.threads()));
+        }
+
+        kld_sampling_.reset(other.kld_sampling_
+                                ? new KldSampling(*other.kld_sampling_)
+                                : nullptr);
+
+        transitions_ = other.transitions_;
+        sensors_ = other.sensors_;
+        process_noises_ = other.process_noises_;
+        noise_samples_ = other.noise_samples_;
+        log_likelihoods_ = other.log_likelihoods_;
+
+        return *this;
+    }
+
     /**
      * \brief Overridable default destructor
      */
@@ -101,14 +229,47 @@ public:
                          const Input& input,
                          Belief& predicted_belief)
     {
-        predicted_belief = prior_belief;
-        for(int i = 0; i < predicted_belief.size(); i++)
+        if (&predicted_belief != &prior_belief)
+        {
+            predicted_belief = prior_belief;
+        }
+
+        noise_samples_.resize(transition_.noise_dimension(),
+                              predicted_belief.size());
+
+        if (threads() == 1)
         {
-            predicted_belief.location(i) =
-                    transition_.state(prior_belief.location(i),
-                                         process_noise_.sample(),
-                                         input);
+            process_noise_.sample(noise_samples_);
+
+            for(int i = 0; i < predicted_belief.size(); i++)
+            {
+                predicted_belief.location(i) =
+                        transition_.state(prior_belief.location(i),
+                                          noise_samples_.col(i),
+                                          input);
+            }
+            return;
         }
+
+        for (auto& transition: transitions_) transition = transition_;
+
+        thread_pool_->parallel_for(
+            predicted_belief.size(),
+            [&](int chunk, int begin, int end)
+            {
+                const TransitionFunction& transition = transitions_[chunk];
+
+                process_noises_[chunk].sample(
+                    noise_samples_.middleCols(begin, end - begin));
+
+                for(int i = begin; i < end; i++)
+                {
+                    predicted_belief.location(i) =
+                            transition.state(prior_belief.location(i),
+                                             noise_samples_.col(i),
+                                             input);
+                }
+            });
     }
 
     /**
@@ -119,19 +280,33 @@ public:
                         Belief& posterior_belief)
     {
         // if the samples are too concentrated then resample
-        if(predicted_belief.kl_given_uniform() > max_kl_divergence_)
+        if(predicted_belief.effective_sample_size() <
+           predicted_belief.size() * std::exp(-max_kl_divergence_))
         {
-            posterior_belief.from_distribution(predicted_belief,
-                                               predicted_belief.size());
+            if (kld_sampling_)
+            {
+                // the particles drawn by KLD-sampling are the resampled set
+                const int new_size = (*kld_sampling_)(predicted_belief);
+
+                posterior_belief.from_distribution(predicted_belief,
+                                                   new_size,
+                                                   *kld_sampling_);
+            }
+            else
+            {
+                posterior_belief.from_distribution(predicted_belief,
+                                                   predicted_belief.size(),
+                                                   resampling_);
+            }
         }
-        else
+        else if (&posterior_belief != &predicted_belief)
         {
             posterior_belief = predicted_belief;
         }
 
         // update the weights of the particles with the likelihoods
-        posterior_belief.delta_log_prob_mass(
-             sensor_.log_probabilities(obsrv, predicted_belief.locations()));
+        log_likelihoods(obsrv, posterior_belief, log_likelihoods_);
+        posterior_belief.delta_log_prob_mass(log_likelihoods_);
     }
 
     /**
@@ -173,12 +348,89 @@ public: /* accessors */
         return sensor_;
     }
 
+    Resampling& resampling()
+    {
+        return resampling_;
+    }
+
+    const Resampling& resampling() const
+    {
+        return resampling_;
+    }
+
+    /**
+     * \return Number of threads used to propagate and weight the particles
+     */
+    int threads() const
+    {
+        return thread_pool_->threads();
+    }
+
+    /**
+     * \brief Sets the number of threads used to propagate and weight the
+     *        particles. The default is a single thread, i.e. serial execution.
+     *
+     * The particles are split into fixed contiguous chunks, one per thread
+     * (see ThreadPool). Each chunk is processed with its own process noise
+     * generator and its own copy of the transition and sensor model, hence
+     * the models are not required to be thread-safe.
+     */
+    void threads(int count)
+    {
+        thread_pool_.reset(new ThreadPool(count));
+
+        const int chunks = thread_pool_->threads();
+
+        transitions_.assign(chunks, transition_);
+        sensors_.assign(chunks, sensor_);
+
+        process_noises_.clear();
+        for (int i = 0; i < chunks; ++i)
+        {
+            process_noises_.push_back(
+                StandardGaussian<StateNoise>(transition_.noise_dimension()));
+        }
+    }
+
+    /**
+     * \brief Enables adaptive particle counts. Whenever the particles are
+     *        resampled, the resampled set is drawn by \a kld_sampling until
+     *        its size suffices, instead of by the Resampling policy with a
+     *        constant size.
+     *
+     * The particle count only changes at resampling steps. A negative
+     * max_kl_divergence resamples in every update, hence adapts the count
+     * in every step.
+     */
+    void kld_sampling(const KldSampling& kld_sampling)
+    {
+        kld_sampling_.reset(new KldSampling(kld_sampling));
+    }
+
+    /**
+     * \brief Disables adaptive particle counts, the resampled set keeps the
+     *        size of the predicted belief
+     */
+    void disable_kld_sampling()
+    {
+        kld_sampling_.reset();
+    }
+
+    /**
+     * \return Whether the particle count is adapted by KLD-sampling
+     */
+    bool kld_sampling_enabled() const
+    {
+        return bool(kld_sampling_);
+    }
+
     virtual std::string name() const
     {
         return "ParticleFilter<"
                 + this->list_arguments(
                             transition().name(),
-                            sensor().name())
+                            sensor().name(),
+                            resampling().name())
                 + ">";
     }
 
@@ -187,22 +439,149 @@ public: /* accessors */
         return "Non-parametric ParticleFilter with"
                 + this->list_descriptions(
                             transition().description(),
-                            sensor().description());
+                            sensor().description(),
+                            resampling().description());
+    }
+protected:
+    /** \cond internal */
+    /**
+     * \brief Evaluates the log likelihoods \f$\log p(y \mid x_i)\f$ of all
+     *        particles \f$x_i\f$ of \a belief, using the batch interface of
+     *        the sensor or the thread pool if threads() > 1.
+     */
+    void log_likelihoods(const Obsrv& obsrv,
+                         const Belief& belief,
+                         typename Belief::Function& log_probs)
+    {
+        if (threads() == 1)
+        {
+            sensor_.log_probabilities(obsrv, belief.locations(), log_probs);
+            return;
+        }
+
+        for (auto& sensor: sensors_) sensor = sensor_;
+
+        log_probs.resize(belief.size());
+
+        thread_pool_->parallel_for(
+            belief.size(),
+            [&](int chunk, int begin, int end)
+            {
+                const SensorDensity& sensor = sensors_[chunk];
+
+                for(int i = begin; i < end; i++)
+                {
+                    log_probs[i] = sensor.log_probability(obsrv,
+                                                          belief.location(i));
+                }
+            });
     }
+    /** \endcond */
+
 protected:
     TransitionFunction transition_;
     SensorDensity sensor_;
+    Resampling resampling_;
 
     StandardGaussian<StateNoise> process_noise_;
     StandardGaussian<ObsrvNoise> obsrv_noise_;
 
     /**
-     * when the KL divergence KL(p||u), where p is the particle distribution
-     * and u is the uniform distribution, exceeds max_kl_divergence_, then there
-     * is a resampling step. can be understood as -log(f) where f is the
-     * fraction of nonzero particles.
+     * resampling threshold, can be understood as -log(f) where f is the
+     * fraction of nonzero particles. the particles are resampled once the
+     * fraction ESS/N of the effective sample size ESS falls below
+     * exp(-max_kl_divergence_). -log(ESS/N) is the collision (order 2 Renyi)
+     * counterpart of the divergence KL(p||u) between the particle
+     * distribution p and the uniform distribution u, but it is available
+     * from the weight normalization without an extra entropy pass.
      */
     fl::Real max_kl_divergence_;
+
+    /** \cond internal */
+    std::unique_ptr<ThreadPool> thread_pool_;
+
+    /* adaptive particle count, fixed count if not set */
+    std::unique_ptr<KldSampling> kld_sampling_;
+
+    /* per chunk copies of the models and process noise generators */
+    std::vector<
+        TransitionFunction,
+        Eigen::aligned_allocator<TransitionFunction>
+    > transitions_;
+    std::vector<
+        SensorDensity,
+        Eigen::aligned_allocator<SensorDensity>
+    > sensors_;
+    std::vector<
+        StandardGaussian<StateNoise>,
+        Eigen::aligned_allocator<StandardGaussian<StateNoise>>
+    > process_noises_;
+
+    /*
+     * buffers reused across filter steps. together with the buffers of the
+     * belief a predict/update cycle of a fixed-size model does not allocate
+     * once the number of particles is constant.
+     */
+    Eigen::Matrix<
+        typename StateNoise::Scalar, SizeOf<StateNoise>::Value, Eigen::Dynamic
+    > noise_samples_;
+    typename Belief::Function log_likelihoods_;
+    /** \endcond */
+};
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Particle filter storing the particles in a DiscreteDistribution
+ */
+template<
+    typename TransitionFunction,
+    typename SensorDensity,
+    typename Resampling
+>
+class ParticleFilter<TransitionFunction, SensorDensity, Resampling>
+    : public ParticleFilter<
+                 TransitionFunction,
+                 SensorDensity,
+                 Resampling,
+                 DiscreteDistribution<typename TransitionFunction::State>>
+{
+public:
+    ParticleFilter(const TransitionFunction& transition,
+                   const SensorDensity& sensor,
+                   const Real& max_kl_divergence = 1.0,
+                   const Resampling& resampling = Resampling())
+        : ParticleFilter<
+              TransitionFunction,
+              SensorDensity,
+              Resampling,
+              DiscreteDistribution<typename TransitionFunction::State>>(
+                  transition, sensor, max_kl_divergence, resampling)
+    { }
+};
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Particle filter using multinomial resampling, i.e. resampled
+ *        particles are drawn independently from the weighted particle set.
+ */
+template<
+    typename TransitionFunction,
+    typename SensorDensity
+>
+class ParticleFilter<TransitionFunction, SensorDensity>
+    : public ParticleFilter<
+                 TransitionFunction, SensorDensity, MultinomialResampling>
+{
+public:
+    ParticleFilter(const TransitionFunction& transition,
+                   const SensorDensity& sensor,
+                   const Real& max_kl_divergence = 1.0)
+        : ParticleFilter<
+              TransitionFunction, SensorDensity, MultinomialResampling>(
+                  transition, sensor, max_kl_divergence)
+    { }
 };
 
 }
@@ -0,0 +1,480 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file rao_blackwellized_particle_filter.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <cmath>
+
+#include <fl/util/math.hpp>
+#include <fl/util/traits.hpp>
+#include <fl/filter/filter_interface.hpp>
+#include <fl/distribution/gaussian.hpp>
+#include <fl/distribution/standard_gaussian.hpp>
+#include <fl/distribution/rao_blackwellized_distribution.hpp>
+#include <fl/filter/particle/resampling/systematic_resampling.hpp>
+
+namespace fl
+{
+
+// Rao-Blackwellized particle filter forward declaration
+template <typename...> class RaoBlackwellizedParticleFilter;
+
+/**
+ * \internal
+ * \ingroup particle_filter
+ *
+ * RaoBlackwellizedParticleFilter Traits
+ */
+template <
+    typename TransitionFunction,
+    typename SensorFunction,
+    typename LinearTransition,
+    typename LinearSensor,
+    typename Resampling
+>
+struct Traits<
+           RaoBlackwellizedParticleFilter<
+               TransitionFunction,
+               SensorFunction,
+               LinearTransition,
+               LinearSensor,
+               Resampling>>
+{
+    typedef typename TransitionFunction::State State;
+    typedef typename TransitionFunction::Input Input;
+    typedef typename LinearSensor::Obsrv       Obsrv;
+    typedef typename LinearTransition::State   SubState;
+    typedef RaoBlackwellizedDistribution<State, SubState> Belief;
+};
+
+/**
+ * \internal
+ * \ingroup particle_filter
+ *
+ * RaoBlackwellizedParticleFilter Traits of the filter using systematic
+ * resampling
+ */
+template <
+    typename TransitionFunction,
+    typename SensorFunction,
+    typename LinearTransition,
+    typename LinearSensor
+>
+struct Traits<
+           RaoBlackwellizedParticleFilter<
+               TransitionFunction,
+               SensorFunction,
+               LinearTransition,
+               LinearSensor>>
+    : Traits<
+          RaoBlackwellizedParticleFilter<
+              TransitionFunction,
+              SensorFunction,
+              LinearTransition,
+              LinearSensor,
+              SystematicResampling>>
+{ };
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Rao-Blackwellized (marginalized) particle filter for conditionally
+ *        linear Gaussian models.
+ *
+ * The state is split into a sampled part \f$x\f$ and a sub state \f$z\f$
+ * which is linear Gaussian given \f$x\f$,
+ *
+ * \f[
+ * \begin{aligned}
+ *   x_{t+1} &= f(x_t, v_t, u_t) \\
+ *   z_{t+1} &= A z_t + B u_t + w_t \\
+ *   y_t     &= h(x_t) + H z_t + e_t
+ * \end{aligned}
+ * \f]
+ *
+ * with \f$w_t \sim {\cal N}(0, Q)\f$ and \f$e_t \sim {\cal N}(0, R)\f$.
+ * Only \f$x\f$ is represented by particles. Each particle carries the exact
+ * Gaussian posterior of \f$z\f$, obtained by the equations of the linear
+ * GaussianFilter. Since the sub state is marginalized analytically, far
+ * fewer particles are needed than for sampling the full state.
+ *
+ * The Kalman recursion of \f$z\f$ does not depend on the particle, hence
+ * the covariance, the innovation covariance \f$S = H \Sigma H^T + R\f$ and
+ * the gain are computed once per step. The means of all particles are then
+ * predicted and updated by single matrix products, and the particle weights
+ * \f$p(y \mid x_i) = {\cal N}(y \mid h(x_i) + H \mu_i, S)\f$ are obtained
+ * with a single triangular solve for all innovations.
+ *
+ * \tparam TransitionFunction  Transition of the sampled state \f$f\f$
+ * \tparam SensorFunction      Provides \f$h(x)\f$ by means of
+ *                             <tt>expected_observation(x)</tt>. Its noise
+ *                             is not used, the observation noise \f$R\f$
+ *                             is the one of the LinearSensor.
+ * \tparam LinearTransition    LinearTransition of the sub state, \f$A, B,
+ *                             Q\f$. It receives the same input as the
+ *                             TransitionFunction.
+ * \tparam LinearSensor        Linear Gaussian sensor of the sub state,
+ *                             \f$H, R\f$
+ * \tparam Resampling          Resampling policy, see ParticleFilter
+ */
+template <
+    typename TransitionFunction,
+    typename SensorFunction,
+    typename LinearTransition,
+    typename LinearSensor,
+    typename Resampling
+>
+class RaoBlackwellizedParticleFilter<
+          TransitionFunction,
+          SensorFunction,
+          LinearTransition,
+          LinearSensor,
+          Resampling>
+    : public FilterInterface<
+                 RaoBlackwellizedParticleFilter<
+                     TransitionFunction,
+                     SensorFunction,
+                     LinearTransition,
+                     LinearSensor,
+                     Resampling>>
+{
+private:
+    /** \cond internal */
+    typedef typename TransitionFunction::Noise StateNoise;
+    /** \endcond */
+
+public:
+    typedef typename TransitionFunction::State State;
+    typedef typename TransitionFunction::Input Input;
+    typedef typename LinearSensor::Obsrv       Obsrv;
+    typedef typename LinearTransition::State   SubState;
+    typedef RaoBlackwellizedDistribution<State, SubState> Belief;
+
+    typedef typename Belief::SubMeans      SubMeans;
+    typedef typename Belief::SubCovariance SubCovariance;
+
+public:
+    RaoBlackwellizedParticleFilter(const TransitionFunction& transition,
+                                   const SensorFunction& sensor,
+                                   const LinearTransition& sub_transition,
+                                   const LinearSensor& sub_sensor,
+                                   const Real& max_kl_divergence = 1.0,
+                                   const Resampling& resampling = Resampling())
+        : transition_(transition),
+          sensor_(sensor),
+          sub_transition_(sub_transition),
+          sub_sensor_(sub_sensor),
+          resampling_(resampling),
+          process_noise_(transition.noise_dimension()),
+          max_kl_divergence_(max_kl_divergence)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~RaoBlackwellizedParticleFilter() noexcept { }
+
+    /**
+     * \copydoc FilterInterface::predict
+     *
+     * The particles are propagated through the TransitionFunction. The sub
+     * beliefs are predicted by the Kalman prediction
+     * \f$\mu_i \leftarrow A \mu_i + B u\f$,
+     * \f$\Sigma \leftarrow A \Sigma A^T + Q\f$.
+     */
+    virtual void predict(const Belief& prior_belief,
+                         const Input& input,
+                         Belief& predicted_belief)
+    {
+        if (&predicted_belief != &prior_belief)
+        {
+            predicted_belief = prior_belief;
+        }
+
+        noise_samples_.resize(transition_.noise_dimension(),
+                              predicted_belief.size());
+        process_noise_.sample(noise_samples_);
+
+        for(int i = 0; i < predicted_belief.size(); i++)
+        {
+            predicted_belief.location(i) =
+                    transition_.state(prior_belief.location(i),
+                                      noise_samples_.col(i),
+                                      input);
+        }
+
+        auto&& A = sub_transition_.dynamics_matrix();
+        auto&& B = sub_transition_.input_matrix();
+        auto&& Q = sub_transition_.noise_covariance();
+
+        // all means at once, the buffer avoids aliasing
+        sub_means_.noalias() = A * prior_belief.sub_means();
+        sub_means_.colwise() += B * input;
+        predicted_belief.sub_means().swap(sub_means_);
+
+        predicted_belief.conditional_sub_covariance(
+            A * prior_belief.conditional_sub_covariance() * A.transpose() + Q);
+    }
+
+    /**
+     * \copydoc FilterInterface::update
+     *
+     * The particles are resampled first if their weights are too
+     * concentrated, see ParticleFilter::update. With the innovations
+     * \f$e_i = y - h(x_i) - H \mu_i\f$ and the gain
+     * \f$K = \Sigma H^T S^{-1}\f$, the weights are multiplied by
+     * \f${\cal N}(e_i \mid 0, S)\f$ and the sub beliefs are updated to
+     * \f$\mu_i \leftarrow \mu_i + K e_i\f$,
+     * \f$\Sigma \leftarrow \Sigma - K H \Sigma\f$.
+     */
+    virtual void update(const Belief& predicted_belief,
+                        const Obsrv& obsrv,
+                        Belief& posterior_belief)
+    {
+        // if the samples are too concentrated then resample
+        if(predicted_belief.effective_sample_size() <
+           predicted_belief.size() * std::exp(-max_kl_divergence_))
+        {
+            posterior_belief.from_distribution(predicted_belief,
+                                               predicted_belief.size(),
+                                               resampling_);
+        }
+        else if (&posterior_belief != &predicted_belief)
+        {
+            posterior_belief = predicted_belief;
+        }
+
+        auto&& H = sub_sensor_.sensor_matrix();
+        auto&& R = sub_sensor_.noise_covariance();
+
+        const SubCovariance& cov = posterior_belief.conditional_sub_covariance();
+        SubMeans& means = posterior_belief.sub_means();
+
+        // quantities shared by all particles
+        cov_zy_.noalias() = cov * H.transpose();
+        innovation_cholesky_.compute(H * cov_zy_ + R);
+        gain_ = innovation_cholesky_.solve(cov_zy_.transpose()).transpose();
+
+        // innovations of all particles
+        innovations_.noalias() = -H * means;
+        innovations_.colwise() += obsrv;
+        for(int i = 0; i < posterior_belief.size(); i++)
+        {
+            innovations_.col(i) -=
+                sensor_.expected_observation(posterior_belief.location(i));
+        }
+
+        means.noalias() += gain_ * innovations_;
+        posterior_belief.conditional_sub_covariance(
+            cov - gain_ * cov_zy_.transpose());
+
+        // weights N(e_i | 0, S) by means of S = L L^T
+        innovation_cholesky_.matrixL().solveInPlace(innovations_);
+
+        const Real log_normalizer =
+            - Real(0.5) * innovations_.rows() * std::log(2.0 * M_PI)
+            - innovation_cholesky_.matrixLLT().diagonal().array().log().sum();
+
+        log_likelihoods_ = log_normalizer
+                           - Real(0.5) * innovations_.colwise().squaredNorm()
+                                                     .transpose().array();
+
+        posterior_belief.delta_log_prob_mass(log_likelihoods_);
+    }
+
+    /**
+     * \copydoc FilterInterface::predict_and_update
+     */
+    virtual void predict_and_update(const Belief& prior_belief,
+                                    const Input& input,
+                                    const Obsrv& observation,
+                                    Belief& posterior_belief)
+    {
+        predict(prior_belief, input, posterior_belief);
+        update(posterior_belief, observation, posterior_belief);
+    }
+
+public: /* factory functions */
+    virtual Belief create_belief() const
+    {
+        auto belief = Belief(1, sub_transition().state_dimension());
+        return belief;
+    }
+
+public: /* accessors */
+    TransitionFunction& transition()
+    {
+        return transition_;
+    }
+
+    SensorFunction& sensor()
+    {
+        return sensor_;
+    }
+
+    LinearTransition& sub_transition()
+    {
+        return sub_transition_;
+    }
+
+    LinearSensor& sub_sensor()
+    {
+        return sub_sensor_;
+    }
+
+    const TransitionFunction& transition() const
+    {
+        return transition_;
+    }
+
+    const SensorFunction& sensor() const
+    {
+        return sensor_;
+    }
+
+    const LinearTransition& sub_transition() const
+    {
+        return sub_transition_;
+    }
+
+    const LinearSensor& sub_sensor() const
+    {
+        return sub_sensor_;
+    }
+
+    Resampling& resampling()
+    {
+        return resampling_;
+    }
+
+    const Resampling& resampling() const
+    {
+        return resampling_;
+    }
+
+    virtual std::string name() const
+    {
+        return "RaoBlackwellizedParticleFilter<"
+                + this->list_arguments(
+                            transition().name(),
+                            sensor().name(),
+                            sub_transition().name(),
+                            sub_sensor().name(),
+                            resampling().name())
+                + ">";
+    }
+
+    virtual std::string description() const
+    {
+        return "Rao-Blackwellized ParticleFilter with a Kalman filter per "
+               "particle with"
+                + this->list_descriptions(
+                            transition().description(),
+                            sensor().description(),
+                            sub_transition().description(),
+                            sub_sensor().description(),
+                            resampling().description());
+    }
+
+protected:
+    TransitionFunction transition_;
+    SensorFunction sensor_;
+    LinearTransition sub_transition_;
+    LinearSensor sub_sensor_;
+    Resampling resampling_;
+
+    StandardGaussian<StateNoise> process_noise_;
+
+    /**
+     * resampling threshold, see ParticleFilter::max_kl_divergence_
+     */
+    fl::Real max_kl_divergence_;
+
+    /** \cond internal */
+    /* buffers reused across filter steps */
+    Eigen::Matrix<
+        typename StateNoise::Scalar, SizeOf<StateNoise>::Value, Eigen::Dynamic
+    > noise_samples_;
+
+    SubMeans sub_means_;
+
+    Eigen::Matrix<
+        Real, SizeOf<Obsrv>::Value, Eigen::Dynamic
+    > innovations_;
+    Eigen::Matrix<
+        Real, SizeOf<SubState>::Value, SizeOf<Obsrv>::Value
+    > cov_zy_;
+    Eigen::Matrix<
+        Real, SizeOf<SubState>::Value, SizeOf<Obsrv>::Value
+    > gain_;
+    Eigen::LLT<
+        Eigen::Matrix<Real, SizeOf<Obsrv>::Value, SizeOf<Obsrv>::Value>
+    > innovation_cholesky_;
+
+    typename Belief::Function log_likelihoods_;
+    /** \endcond */
+};
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Rao-Blackwellized particle filter using systematic resampling
+ */
+template <
+    typename TransitionFunction,
+    typename SensorFunction,
+    typename LinearTransition,
+    typename LinearSensor
+>
+class RaoBlackwellizedParticleFilter<
+          TransitionFunction,
+          SensorFunction,
+          LinearTransition,
+          LinearSensor>
+    : public RaoBlackwellizedParticleFilter<
+                 TransitionFunction,
+                 SensorFunction,
+                 LinearTransition,
+                 LinearSensor,
+                 SystematicResampling>
+{
+public:
+    RaoBlackwellizedParticleFilter(const TransitionFunction& transition,
+                                   const SensorFunction& sensor,
+                                   const LinearTransition& sub_transition,
+                                   const LinearSensor& sub_sensor,
+                                   const Real& max_kl_divergence = 1.0)
+        : RaoBlackwellizedParticleFilter<
+              TransitionFunction,
+              SensorFunction,
+              LinearTransition,
+              LinearSensor,
+              SystematicResampling>(
+                  transition,
+                  sensor,
+                  sub_transition,
+                  sub_sensor,
+                  max_kl_divergence)
+    { }
+};
+
+}
@@ -0,0 +1,101 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file multinomial_resampling.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <random>
+#include <string>
+#include <algorithm>
+
+#include <fl/util/types.hpp>
+#include <fl/util/random.hpp>
+#include <fl/util/descriptor.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Multinomial resampling policy.
+ *
+ * Each index is drawn independently, i.e. \f$u_k \sim U[0, 1)\f$ for all
+ * \f$k\f$. This is statistically equivalent to drawing
+ * \c DiscreteDistribution::sample() \f$N\f$ times. Every draw is located by
+ * a binary search in the cumulative distribution which results in
+ * \f$O(N \log N)\f$.
+ */
+class MultinomialResampling
+    : public Descriptor
+{
+public:
+    MultinomialResampling()
+        : generator_(fl::seed()),
+          uniform_distribution_(0.0, 1.0)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~MultinomialResampling() noexcept { }
+
+    /**
+     * \brief Draws <tt>indices.size()</tt> indices from the given cumulative
+     *        distribution
+     *
+     * \param [in]  cdf      Cumulative distribution of the particle weights
+     * \param [out] indices  Resampled particle indices
+     */
+    template <typename CumulativeDistribution, typename IndexArray>
+    void operator()(const CumulativeDistribution& cdf,
+                    IndexArray& indices) const
+    {
+        const Real* begin = cdf.data();
+        const Real* end = cdf.data() + cdf.size();
+        const Real total = cdf[cdf.size() - 1];
+
+        for (int k = 0; k < indices.size(); ++k)
+        {
+            const Real u = total * uniform_distribution_(generator_);
+
+            indices[k] = std::min(int(std::lower_bound(begin, end, u) - begin),
+                                  int(cdf.size()) - 1);
+        }
+    }
+
+    virtual std::string name() const
+    {
+        return "MultinomialResampling";
+    }
+
+    virtual std::string description() const
+    {
+        return "Multinomial resampling with independent draws";
+    }
+
+protected:
+    /** \cond internal */
+    mutable fl::mt11213b generator_;
+    mutable std::uniform_real_distribution<Real> uniform_distribution_;
+    /** \endcond */
+};
+
+}
@@ -0,0 +1,77 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file resampling_sweep.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <fl/util/types.hpp>
+
+namespace fl
+{
+
+/**
+ * \internal
+ */
+namespace internal
+{
+
+/**
+ * \internal
+ * \ingroup particle_filter
+ *
+ * \brief Maps the stratified positions \f$u_k = (k + o_k) / N\f$,
+ *        \f$k = 0, \ldots, N-1\f$, onto the indices of the cumulative
+ *        distribution \a cdf in a single forward sweep.
+ *
+ * Since the positions are monotonically increasing, the index into the
+ * cumulative distribution never moves backwards. Hence, the total cost is
+ * \f$O(N + M)\f$ where \f$M\f$ is the number of locations.
+ *
+ * \param [in]  cdf      Cumulative distribution. The positions are scaled
+ *                       with its last element so round-off in the sum never
+ *                       leads to an index past the end.
+ * \param [in]  offset   Functor returning \f$o_k \in [0, 1)\f$ for each
+ *                       stratum \f$k\f$
+ * \param [out] indices  Resulting indices. The number of strata \f$N\f$ is
+ *                       given by the size of this array.
+ */
+template <typename CumulativeDistribution, typename IndexArray, typename Offset>
+void sweep_cumulative_distribution(const CumulativeDistribution& cdf,
+                                   Offset offset,
+                                   IndexArray& indices)
+{
+    const int new_size = indices.size();
+    const int last = cdf.size() - 1;
+    const Real scale = cdf[last] / Real(new_size);
+
+    int j = 0;
+    for (int k = 0; k < new_size; ++k)
+    {
+        const Real u = scale * (Real(k) + offset(k));
+
+        while (j < last && cdf[j] < u) ++j;
+
+        indices[k] = j;
+    }
+}
+
+}
+
+}
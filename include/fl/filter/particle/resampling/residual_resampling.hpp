@@ -0,0 +1,127 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file residual_resampling.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+#include <fl/util/types.hpp>
+#include <fl/util/random.hpp>
+#include <fl/util/descriptor.hpp>
+#include <fl/filter/particle/resampling/resampling_sweep.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Residual resampling policy.
+ *
+ * Each particle \f$i\f$ is first copied deterministically
+ * \f$\lfloor N w_i \rfloor\f$ times. The remaining
+ * \f$R = N - \sum_i \lfloor N w_i \rfloor\f$ indices are drawn from the
+ * residual weights \f$N w_i - \lfloor N w_i \rfloor\f$ using a systematic
+ * sweep. Both passes are linear, hence the policy is \f$O(N)\f$.
+ */
+class ResidualResampling
+    : public Descriptor
+{
+public:
+    ResidualResampling()
+        : generator_(fl::seed()),
+          uniform_distribution_(0.0, 1.0)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~ResidualResampling() noexcept { }
+
+    /**
+     * \brief Draws <tt>indices.size()</tt> indices from the given cumulative
+     *        distribution
+     *
+     * \param [in]  cdf      Cumulative distribution of the particle weights
+     * \param [out] indices  Resampled particle indices
+     */
+    template <typename CumulativeDistribution, typename IndexArray>
+    void operator()(const CumulativeDistribution& cdf,
+                    IndexArray& indices) const
+    {
+        const int new_size = indices.size();
+        const int locations = cdf.size();
+        const Real scale = Real(new_size) / cdf[locations - 1];
+
+        residual_cdf_.resize(locations);
+
+        // deterministic copies
+        int k = 0;
+        Real previous = 0;
+        Real residual_sum = 0;
+        for (int i = 0; i < locations; ++i)
+        {
+            const Real expected = scale * (cdf[i] - previous);
+            const Real copies = std::floor(expected);
+            previous = cdf[i];
+
+            for (int c = 0; c < int(copies) && k < new_size; ++c)
+            {
+                indices[k++] = i;
+            }
+
+            residual_sum += expected - copies;
+            residual_cdf_[i] = residual_sum;
+        }
+
+        if (k == new_size) return;
+
+        // remaining draws on the residual weights
+        auto remaining = indices.segment(k, new_size - k);
+        const Real offset = uniform_distribution_(generator_);
+
+        internal::sweep_cumulative_distribution(
+            residual_cdf_, [offset](int) { return offset; }, remaining);
+    }
+
+    virtual std::string name() const
+    {
+        return "ResidualResampling";
+    }
+
+    virtual std::string description() const
+    {
+        return "Residual resampling with systematic draws on the residuals";
+    }
+
+protected:
+    /** \cond internal */
+    mutable Eigen::Array<Real, Eigen::Dynamic, 1> residual_cdf_;
+    mutable fl::mt11213b generator_;
+    mutable std::uniform_real_distribution<Real> uniform_distribution_;
+    /** \endcond */
+};
+
+}
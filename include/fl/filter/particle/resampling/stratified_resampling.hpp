@@ -0,0 +1,94 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file stratified_resampling.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <random>
+#include <string>
+
+#include <fl/util/types.hpp>
+#include <fl/util/random.hpp>
+#include <fl/util/descriptor.hpp>
+#include <fl/filter/particle/resampling/resampling_sweep.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Stratified resampling policy.
+ *
+ * The unit interval is divided into \f$N\f$ equally sized strata and one
+ * position is drawn uniformly within each stratum, i.e.
+ * \f$u_k = (k + o_k) / N\f$ with independent \f$o_k \sim U[0, 1)\f$. Since the
+ * positions are ordered by construction, all indices are obtained in a single
+ * \f$O(N)\f$ sweep over the cumulative distribution.
+ */
+class StratifiedResampling
+    : public Descriptor
+{
+public:
+    StratifiedResampling()
+        : generator_(fl::seed()),
+          uniform_distribution_(0.0, 1.0)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~StratifiedResampling() noexcept { }
+
+    /**
+     * \brief Draws <tt>indices.size()</tt> indices from the given cumulative
+     *        distribution
+     *
+     * \param [in]  cdf      Cumulative distribution of the particle weights
+     * \param [out] indices  Resampled particle indices
+     */
+    template <typename CumulativeDistribution, typename IndexArray>
+    void operator()(const CumulativeDistribution& cdf,
+                    IndexArray& indices) const
+    {
+        internal::sweep_cumulative_distribution(
+            cdf,
+            [this](int) { return uniform_distribution_(generator_); },
+            indices);
+    }
+
+    virtual std::string name() const
+    {
+        return "StratifiedResampling";
+    }
+
+    virtual std::string description() const
+    {
+        return "Stratified resampling with one uniform draw per stratum";
+    }
+
+protected:
+    /** \cond internal */
+    mutable fl::mt11213b generator_;
+    mutable std::uniform_real_distribution<Real> uniform_distribution_;
+    /** \endcond */
+};
+
+}
@@ -0,0 +1,94 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file systematic_resampling.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <random>
+#include <string>
+
+#include <fl/util/types.hpp>
+#include <fl/util/random.hpp>
+#include <fl/util/descriptor.hpp>
+#include <fl/filter/particle/resampling/resampling_sweep.hpp>
+
+namespace fl
+{
+
+/**
+ * \ingroup particle_filter
+ *
+ * \brief Systematic resampling policy.
+ *
+ * A single uniform offset \f$o \sim U[0, 1)\f$ is shared by all \f$N\f$
+ * strata, i.e. the positions are \f$u_k = (k + o) / N\f$. The number of
+ * copies of each particle \f$i\f$ deviates from its expectation \f$N w_i\f$
+ * by less than one. All indices are obtained in a single \f$O(N)\f$ sweep
+ * over the cumulative distribution.
+ */
+class SystematicResampling
+    : public Descriptor
+{
+public:
+    SystematicResampling()
+        : generator_(fl::seed()),
+          uniform_distribution_(0.0, 1.0)
+    { }
+
+    /**
+     * \brief Overridable default destructor
+     */
+    virtual ~SystematicResampling() noexcept { }
+
+    /**
+     * \brief Draws <tt>indices.size()</tt> indices from the given cumulative
+     *        distribution
+     *
+     * \param [in]  cdf      Cumulative distribution of the particle weights
+     * \param [out] indices  Resampled particle indices
+     */
+    template <typename CumulativeDistribution, typename IndexArray>
+    void operator()(const CumulativeDistribution& cdf,
+                    IndexArray& indices) const
+    {
+        const Real offset = uniform_distribution_(generator_);
+
+        internal::sweep_cumulative_distribution(
+            cdf, [offset](int) { return offset; }, indices);
+    }
+
+    virtual std::string name() const
+    {
+        return "SystematicResampling";
+    }
+
+    virtual std::string description() const
+    {
+        return "Systematic resampling with a single uniform offset";
+    }
+
+protected:
+    /** \cond internal */
+    mutable fl::mt11213b generator_;
+    mutable std::uniform_real_distribution<Real> uniform_distribution_;
+    /** \endcond */
+};
+
+}
@@ -20,6 +20,8 @@
 #pragma once
 
 
+#include <limits>
+#include <algorithm>
 #include <type_traits>
 #include <fl/util/meta.hpp>
 #include <fl/util/traits.hpp>
@@ -151,6 +153,9 @@ public:
      */
     typedef TailModel TailSensor;
 
+    typedef typename Traits<This>::ObsrvDensity::StateMatrix StateMatrix;
+    typedef typename Traits<This>::ObsrvDensity::ValueArray ValueArray;
+
 public:
     /**
      * \brief Creates a BodyTailSensor
@@ -242,6 +247,44 @@ public:
         return std::log(probability(obsrv, state));
     }
 
+    using Traits<This>::ObsrvDensity::log_probabilities;
+
+    /**
+     * \brief Evaluates the log. probabilities of all \a states, one state
+     *        per column, at once.
+     *
+     * Both models evaluate the whole batch using their own batch
+     * implementation, e.g. LinearGaussianSensor::log_probabilities. The
+     * mixture is then combined in the log-domain,
+     *
+     * \f$ m + \log((1-w) e^{l_b - m} + w e^{l_t - m}) \f$,
+     * \f$ m = \max(l_b, l_t) \f$,
+     *
+     * which, unlike log_probability(), does not underflow for states far
+     * from the observation.
+     */
+    void log_probabilities(const Obsrv& obsrv,
+                           const StateMatrix& states,
+                           ValueArray& log_probs) override
+    {
+        body_.log_probabilities(obsrv, states, body_log_probs_);
+        tail_.log_probabilities(obsrv, states, log_probs);
+
+        const Real body_weight = Real(1) - tail_weight_;
+
+        for (int i = 0; i < log_probs.size(); ++i)
+        {
+            const Real l_body = body_log_probs_[i];
+            const Real l_tail = log_probs[i];
+            const Real m = std::max(l_body, l_tail);
+
+            if (m == -std::numeric_limits<Real>::infinity()) continue;
+
+            log_probs[i] = m + std::log(body_weight * std::exp(l_body - m) +
+                                        tail_weight_ * std::exp(l_tail - m));
+        }
+    }
+
     /**
      * \brief Returns the dimension of the measurement \f$h(x, w)\f$
      */
@@ -357,6 +400,11 @@ protected:
      */
     Real tail_weight_;
 
+    /**
+     * \brief Body model batch buffer, see log_probabilities()
+     */
+    ValueArray body_log_probs_;
+
     /** \endcond */
 };
 
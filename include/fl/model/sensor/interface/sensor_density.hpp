@@ -38,6 +38,15 @@ public:
     typedef Eigen::Array<State, BatchSize, 1> StateArray;
     typedef Eigen::Array<Real,  BatchSize, 1> ValueArray;
 
+    /**
+     * \brief Batch of states stored contiguously, one state per column
+     */
+    typedef Eigen::Matrix<
+                typename State::Scalar,
+                SizeOf<State>::Value,
+                BatchSize
+            > StateMatrix;
+
 public:
     /**
      * \brief Overridable default destructor
@@ -69,17 +78,67 @@ public:
                                          const StateArray& states)
     {
         auto probs = ValueArray(states.size());
+        log_probabilities(obsrv, states, probs);
+
+        return probs;
+    }
+
+    /**
+     * \brief Evaluates the log probabilities of all \a states into
+     *        \a log_probs. No memory is allocated if \a log_probs already
+     *        has the size of the batch.
+     */
+    virtual void log_probabilities(const Obsrv& obsrv,
+                                   const StateArray& states,
+                                   ValueArray& log_probs)
+    {
+        log_probs.resize(states.size());
 
         for (int i = 0; i < states.size(); ++i)
         {
-            probs[i] = log_probability(obsrv, states[i]);
+            log_probs[i] = log_probability(obsrv, states[i]);
         }
+    }
+
+    virtual ValueArray probabilities(const Obsrv& obsrv,
+                                     const StateArray& states)
+    {
+        return log_probabilities(obsrv, states).exp();
+    }
+
+    /**
+     * \brief Evaluates the log probabilities of all states given as the
+     *        columns of \a states. Specializations may override this to
+     *        evaluate the entire batch at once.
+     */
+    virtual ValueArray log_probabilities(const Obsrv& obsrv,
+                                         const StateMatrix& states)
+    {
+        auto probs = ValueArray(states.cols());
+        log_probabilities(obsrv, states, probs);
 
         return probs;
     }
 
+    /**
+     * \brief Column-wise counterpart of
+     *        log_probabilities(obsrv, states, log_probs). Specializations may
+     *        override this to evaluate the entire batch at once.
+     */
+    virtual void log_probabilities(const Obsrv& obsrv,
+                                   const StateMatrix& states,
+                                   ValueArray& log_probs)
+    {
+        log_probs.resize(states.cols());
+
+        for (int i = 0; i < states.cols(); ++i)
+        {
+            log_probs[i] = log_probability(obsrv, states.col(i));
+        }
+    }
+
     virtual ValueArray probabilities(const Obsrv& obsrv,
-                                     const StateArray& states)
+                                     const StateMatrix& states)
     {
         return log_probabilities(obsrv, states).exp();
     }
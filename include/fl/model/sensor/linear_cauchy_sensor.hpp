@@ -47,6 +47,9 @@ public:
     typedef typename CauchyDistribution<Obsrv>::StandardVariate Noise;
     typedef typename CauchyDistribution<Obsrv>::SecondMoment NoiseMatrix;
 
+    typedef typename SensorDensity<Obsrv, State>::StateMatrix StateMatrix;
+    typedef typename SensorDensity<Obsrv, State>::ValueArray ValueArray;
+
     /**
      * Observation model sensor matrix \f$H_t\f$ use in
      *
@@ -92,6 +95,42 @@ public:
         return density_.log_probability(obsrv);
     }
 
+    using SensorDensity<Obsrv, State>::log_probabilities;
+
+    /**
+     * \brief Evaluates the log probabilities of all \a states, one state per
+     *        column, at once.
+     *
+     * The residuals \f$ H X - y 1^T \f$ are obtained by one matrix product
+     * and whitened by a single triangular solve with the Cholesky factor of
+     * the scaling matrix. Unlike log_probability(), the location of the
+     * density is not moved for every state, hence the normalizing constant
+     * is evaluated only once.
+     */
+    void log_probabilities(const Obsrv& obsrv,
+                           const StateMatrix& states,
+                           ValueArray& log_probs) override
+    {
+        const Real dof = density_.degrees_of_freedom();
+        const Real dim = obsrv_dimension();
+
+        // at its location the quadratic term of the density vanishes and
+        // only the normalizing constant remains
+        const Real log_normalizer =
+            density_.log_probability(density_.location());
+
+        residuals_.noalias() = sensor_matrix_ * states;
+        residuals_.colwise() -= obsrv;
+
+        scaling_cholesky_.compute(density_.covariance());
+        scaling_cholesky_.matrixL().solveInPlace(residuals_);
+
+        log_probs = log_normalizer
+                    - Real(0.5) * (dof + dim)
+                      * (Real(1) + residuals_.colwise().squaredNorm()
+                                             .transpose().array() / dof).log();
+    }
+
     const SensorMatrix& sensor_matrix() const override
     {
         return sensor_matrix_;
@@ -147,6 +186,12 @@ public:
 private:
     SensorMatrix sensor_matrix_;
     mutable CauchyDistribution<Obsrv> density_;
+
+    /* batch evaluation buffers, see log_probabilities() */
+    Eigen::Matrix<
+        typename Obsrv::Scalar, SizeOf<Obsrv>::Value, Eigen::Dynamic
+    > residuals_;
+    Eigen::LLT<NoiseMatrix> scaling_cholesky_;
 };
 
 }
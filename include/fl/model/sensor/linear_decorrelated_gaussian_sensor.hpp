@@ -20,9 +20,12 @@
 #pragma once
 
 
+#include <limits>
+
 #include <fl/util/traits.hpp>
 #include <fl/util/types.hpp>
 #include <fl/util/descriptor.hpp>
+#include <fl/util/math/block_structure.hpp>
 #include <fl/distribution/decorrelated_gaussian.hpp>
 #include <fl/model/sensor/linear_sensor.hpp>
 #include <fl/model/sensor/interface/additive_uncorrelated_sensor_function.hpp>
@@ -59,6 +62,9 @@ public:
     typedef
     typename AdditiveUncorrelatedInterface::NoiseMatrix NoiseDiagonalMatrix;
 
+    typedef typename SensorDensity<Obsrv, State>::StateMatrix StateMatrix;
+    typedef typename SensorDensity<Obsrv, State>::ValueArray ValueArray;
+
     /**
      * Observation model sensor matrix \f$H_t\f$ use in
      *
@@ -81,8 +87,11 @@ public:
         int obsrv_dim = DimensionOf<Obsrv>(),
         int state_dim = DimensionOf<State>())
         : sensor_matrix_(SensorMatrix::Identity(obsrv_dim, state_dim)),
-          density_(obsrv_dim)
+          density_(obsrv_dim),
+          revision_(0)
     {
+        sensor_column_blocks_.detect(sensor_matrix_);
+
         assert(obsrv_dim > 0);
         assert(state_dim > 0);
     }
@@ -109,11 +118,53 @@ public:
         return density_.log_probability(obsrv);
     }
 
+    using SensorDensity<Obsrv, State>::log_probabilities;
+
+    /**
+     * \brief Evaluates the log probabilities of all \a states, one state per
+     *        column, at once.
+     *
+     * The residuals of the batch are obtained by one matrix product
+     * \f$ H X - y 1^T \f$. Since the noise covariance is diagonal, the
+     * triangular solve whitening the residuals reduces to a row-wise
+     * scaling by the inverse noise standard deviations.
+     */
+    void log_probabilities(const Obsrv& obsrv,
+                           const StateMatrix& states,
+                           ValueArray& log_probs) override
+    {
+        log_probs.resize(states.cols());
+
+        if (!density_.has_full_rank())
+        {
+            log_probs.setConstant(-std::numeric_limits<Real>::infinity());
+            return;
+        }
+
+        residuals_.noalias() = sensor_matrix_ * states;
+        residuals_.colwise() -= obsrv;
+        residuals_.array().colwise() /=
+            density_.square_root().diagonal().array();
+
+        log_probs = density_.log_normalizer()
+                    - Real(0.5) * residuals_.colwise().squaredNorm()
+                                            .transpose().array();
+    }
+
     const SensorMatrix& sensor_matrix() const override
     {
         return sensor_matrix_;
     }
 
+    /**
+     * \return Non-zero column blocks of the sensor matrix. Allows
+     *         skipping the state components which are not observed.
+     */
+    const ColumnBlocks& sensor_column_blocks() const
+    {
+        return sensor_column_blocks_;
+    }
+
     NoiseMatrix noise_matrix() const override
     {
         return density_.square_root();
@@ -149,31 +200,47 @@ public:
         return sensor_matrix_.cols();
     }
 
+    /**
+     * \return Number of modifications of the model parameters. Allows
+     *         detecting changes of the model, e.g. to invalidate quantities
+     *         cached by a filter.
+     */
+    std::size_t revision() const
+    {
+        return revision_;
+    }
+
     virtual void sensor_matrix(const SensorMatrix& sensor_mat)
     {
         sensor_matrix_ = sensor_mat;
+        sensor_column_blocks_.detect(sensor_matrix_);
+        ++revision_;
     }
 
     virtual void noise_matrix(const NoiseMatrix& noise_mat)
     {
         density_.square_root(noise_mat.diagonal().asDiagonal());
+        ++revision_;
     }
 
     virtual void noise_covariance(const NoiseMatrix& noise_mat_squared)
     {
         density_.covariance(noise_mat_squared.diagonal().asDiagonal());
+        ++revision_;
     }
 
     virtual void noise_diagonal_matrix(
         const NoiseDiagonalMatrix& noise_mat)
     {
         density_.square_root(noise_mat);
+        ++revision_;
     }
 
     virtual void noise_diagonal_covariance(
         const NoiseDiagonalMatrix& noise_mat_squared)
     {
         density_.covariance(noise_mat_squared);
+        ++revision_;
     }
 
     virtual SensorMatrix create_sensor_matrix() const
@@ -224,7 +291,14 @@ public:
 
 private:
     SensorMatrix sensor_matrix_;
+    ColumnBlocks sensor_column_blocks_;
     mutable DecorrelatedGaussian<Obsrv> density_;
+    std::size_t revision_;
+
+    /* batch evaluation buffer, see log_probabilities() */
+    Eigen::Matrix<
+        typename Obsrv::Scalar, SizeOf<Obsrv>::Value, Eigen::Dynamic
+    > residuals_;
 };
 
 }
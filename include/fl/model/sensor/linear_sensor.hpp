@@ -20,9 +20,14 @@
 #pragma once
 
 
+#include <Eigen/Dense>
+
+#include <limits>
+
 #include <fl/util/traits.hpp>
 #include <fl/util/types.hpp>
 #include <fl/util/descriptor.hpp>
+#include <fl/util/math/block_structure.hpp>
 #include <fl/distribution/gaussian.hpp>
 #include <fl/distribution/decorrelated_gaussian.hpp>
 #include <fl/model/adaptive_model.hpp>
@@ -79,6 +84,18 @@ public:
      */
     typedef typename AdditiveInterface::NoiseMatrix NoiseMatrix;
 
+    typedef typename DensityInterface::StateMatrix StateMatrix;
+    typedef typename DensityInterface::ValueArray ValueArray;
+
+    /**
+     * \brief Batch of observations, one observation per column
+     */
+    typedef Eigen::Matrix<
+                typename Obsrv::Scalar,
+                SizeOf<Obsrv>::Value,
+                Eigen::Dynamic
+            > ObsrvMatrix;
+
 public:
     /**
      * Constructs a linear gaussian observation model
@@ -89,8 +106,11 @@ public:
     LinearSensor(int obsrv_dim = DimensionOf<Obsrv>(),
                            int state_dim = DimensionOf<State>())
         : sensor_matrix_(SensorMatrix::Identity(obsrv_dim, state_dim)),
-          density_(obsrv_dim)
+          density_(obsrv_dim),
+          revision_(0)
     {
+        sensor_column_blocks_.detect(sensor_matrix_);
+
         assert(obsrv_dim > 0);
         assert(state_dim > 0);
     }
@@ -117,11 +137,56 @@ public:
         return density_.log_probability(obsrv);
     }
 
+    using DensityInterface::log_probabilities;
+
+    /**
+     * \brief Evaluates the log probabilities of all \a states, one state per
+     *        column, at once.
+     *
+     * The residuals \f$ H X - y 1^T \f$ of the entire batch are obtained by
+     * a single matrix product. They are whitened by a single triangular
+     * solve with the Cholesky factor \f$ L \f$ of the noise covariance,
+     * i.e. the Mahalanobis terms are the squared column norms of
+     * \f$ L^{-1}(H X - y 1^T) \f$. The density mean is not touched and the
+     * normalizer is evaluated once.
+     */
+    void log_probabilities(const Obsrv& obsrv,
+                           const StateMatrix& states,
+                           ValueArray& log_probs) override
+    {
+        log_probs.resize(states.cols());
+
+        if (!density_.has_full_rank())
+        {
+            log_probs.setConstant(-std::numeric_limits<Real>::infinity());
+            return;
+        }
+
+        residuals_.noalias() = sensor_matrix_ * states;
+        residuals_.colwise() -= obsrv;
+
+        noise_cholesky_.compute(density_.covariance());
+        noise_cholesky_.matrixL().solveInPlace(residuals_);
+
+        log_probs = density_.log_normalizer()
+                    - Real(0.5) * residuals_.colwise().squaredNorm()
+                                            .transpose().array();
+    }
+
     const SensorMatrix& sensor_matrix() const override
     {
         return sensor_matrix_;
     }
 
+    /**
+     * \return Non-zero column blocks of the sensor matrix. Allows
+     *         skipping the state components which are not observed.
+     */
+    const ColumnBlocks& sensor_column_blocks() const
+    {
+        return sensor_column_blocks_;
+    }
+
     NoiseMatrix noise_matrix() const override
     {
         return density_.square_root();
@@ -147,19 +212,33 @@ public:
         return sensor_matrix_.cols();
     }
 
+    /**
+     * \return Number of modifications of the model parameters. Allows
+     *         detecting changes of the model, e.g. to invalidate quantities
+     *         cached by a filter.
+     */
+    std::size_t revision() const
+    {
+        return revision_;
+    }
+
     virtual void sensor_matrix(const SensorMatrix& sensor_mat)
     {
         sensor_matrix_ = sensor_mat;
+        sensor_column_blocks_.detect(sensor_matrix_);
+        ++revision_;
     }
 
     virtual void noise_matrix(const NoiseMatrix& noise_mat)
     {
         density_.square_root(noise_mat);
+        ++revision_;
     }
 
     virtual void noise_covariance(const NoiseMatrix& noise_mat_squared)
     {
         density_.covariance(noise_mat_squared);
+        ++revision_;
     }
 
     virtual SensorMatrix create_sensor_matrix() const
@@ -178,7 +257,15 @@ public:
 
 protected:
     SensorMatrix sensor_matrix_;
+    ColumnBlocks sensor_column_blocks_;
     mutable NoiseDensity density_;
+    std::size_t revision_;
+
+    /** \cond internal */
+    /* batch evaluation buffers, see log_probabilities() */
+    ObsrvMatrix residuals_;
+    Eigen::LLT<typename NoiseDensity::SecondMoment> noise_cholesky_;
+    /** \endcond */
 };
 
 }
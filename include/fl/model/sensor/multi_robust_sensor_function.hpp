@@ -23,7 +23,7 @@
 #include <fl/util/traits.hpp>
 #include <fl/util/types.hpp>
 #include <fl/util/descriptor.hpp>
-#include <fl/distribution/gaussian.hpp>
+#include <fl/distribution/lean_gaussian.hpp>
 #include <fl/model/sensor/robust_sensor_function.hpp>
 
 namespace fl
@@ -152,19 +152,19 @@ public:
             body_gaussians_(id_).covariance());
     }
 
-    Eigen::Array<Gaussian<InputObsrv>, SensorsCount, 1>& body_gaussians()
+    Eigen::Array<LeanGaussian<InputObsrv>, SensorsCount, 1>& body_gaussians()
     {
         return body_gaussians_;
     }
 
-    Gaussian<InputObsrv>& body_gaussian()
+    LeanGaussian<InputObsrv>& body_gaussian()
     {
         return body_gaussians_(id_);
     }
 
 protected:
     /** \cond internal */
-    Eigen::Array<Gaussian<InputObsrv>, SensorsCount, 1> body_gaussians_;
+    Eigen::Array<LeanGaussian<InputObsrv>, SensorsCount, 1> body_gaussians_;
     int id_;
     /** \endcond */
 };
@@ -22,6 +22,7 @@
 
 #include <fl/util/traits.hpp>
 #include <fl/util/descriptor.hpp>
+#include <fl/util/math/block_structure.hpp>
 #include <fl/distribution/gaussian.hpp>
 #include <fl/model/transition/interface/transition_function.hpp>
 
@@ -93,9 +94,11 @@ public:
           noise_matrix_(NoiseMatrix::Identity(state_dim, noise_dim)),
           input_matrix_(InputMatrix::Identity(state_dim, input_dim)),
           density_(state_dim),
-          discretization_time_step_(1)
+          discretization_time_step_(1),
+          revision_(0)
     {
         density_.covariance(noise_matrix() * noise_matrix().transpose());
+        dynamics_blocks_.detect(dynamics_matrix_);
 
         assert(state_dim > 0);
         assert(input_dim > 0);
@@ -149,6 +152,16 @@ public: /* accessors & mutators */
         return dynamics_matrix_;
     }
 
+    /**
+     * \return Diagonal block structure of the dynamics matrix. Allows
+     *         skipping zero and identity blocks, e.g. of joint states of
+     *         independent objects.
+     */
+    const DiagonalBlocks& dynamics_blocks() const
+    {
+        return dynamics_blocks_;
+    }
+
     virtual const InputMatrix& input_matrix() const
     {
         return input_matrix_;
@@ -184,20 +197,34 @@ public: /* accessors & mutators */
         return discretization_time_step_;
     }
 
+    /**
+     * \return Number of modifications of the model parameters. Allows
+     *         detecting changes of the model, e.g. to invalidate quantities
+     *         cached by a filter.
+     */
+    std::size_t revision() const
+    {
+        return revision_;
+    }
+
     virtual void dynamics_matrix(const DynamicsMatrix& dynamics_mat)
     {
         dynamics_matrix_ = dynamics_mat;
+        dynamics_blocks_.detect(dynamics_matrix_);
+        ++revision_;
     }
 
     virtual void input_matrix(const InputMatrix& input_mat)
     {
         input_matrix_ = input_mat;
+        ++revision_;
     }
 
     virtual void noise_matrix(const NoiseMatrix& noise_mat)
     {
         noise_matrix_ = noise_mat;
         density_.covariance(noise_matrix() * noise_matrix().transpose());
+        ++revision_;
     }
 
     /// \todo is this required? remove if not!
@@ -220,10 +247,12 @@ public: /* accessors & mutators */
 
 protected:
     DynamicsMatrix dynamics_matrix_;
+    DiagonalBlocks dynamics_blocks_;
     NoiseMatrix noise_matrix_;
     InputMatrix input_matrix_;
     mutable Density density_;
     Real discretization_time_step_;
+    std::size_t revision_;
 };
 
 }
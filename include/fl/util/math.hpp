@@ -23,5 +23,6 @@
 #include "math/general_functions.hpp"
 #include "math/special_functions.hpp"
 #include "math/linear_algebra.hpp"
+#include "math/covariance_factorization.hpp"
 
 
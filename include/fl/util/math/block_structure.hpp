@@ -0,0 +1,293 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file block_structure.hpp
+ * \date 2015
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <vector>
+#include <algorithm>
+
+namespace fl
+{
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Partition of a square matrix into contiguous diagonal blocks such
+ *        that all elements outside of the blocks are zero.
+ *
+ * The partition is the finest one, i.e. a dense matrix consists of a single
+ * block and a diagonal matrix of one block per row. Blocks which are
+ * identity matrices are flagged, such that products with them can be
+ * skipped. The structure is detected from a dense matrix in
+ * \f$O(n^2)\f$.
+ */
+class DiagonalBlocks
+{
+public:
+    DiagonalBlocks()
+        : dimension_(0)
+    { }
+
+    /**
+     * \brief Detects the block structure of the square \a matrix
+     */
+    template <typename Matrix>
+    explicit DiagonalBlocks(const Eigen::MatrixBase<Matrix>& matrix)
+    {
+        detect(matrix);
+    }
+
+    /**
+     * \brief Detects the block structure of the square \a matrix
+     */
+    template <typename Matrix>
+    void detect(const Eigen::MatrixBase<Matrix>& matrix)
+    {
+        dimension_ = matrix.rows();
+
+        // reach(i) is the largest index coupled to i by a non-zero element
+        reach_.resize(dimension_);
+        for (int i = 0; i < dimension_; ++i) reach_[i] = i;
+
+        for (int j = 0; j < dimension_; ++j)
+        {
+            for (int i = 0; i < dimension_; ++i)
+            {
+                if (matrix(i, j) != 0)
+                {
+                    reach_[i] = std::max(reach_[i], j);
+                    reach_[j] = std::max(reach_[j], i);
+                }
+            }
+        }
+
+        offsets_.clear();
+        identity_.clear();
+
+        int begin = 0;
+        int end = -1;
+        for (int i = 0; i < dimension_; ++i)
+        {
+            end = std::max(end, reach_[i]);
+
+            if (end == i)
+            {
+                const int size = i + 1 - begin;
+                offsets_.push_back(begin);
+                identity_.push_back(
+                    matrix.block(begin, begin, size, size).isIdentity(0));
+                begin = i + 1;
+            }
+        }
+        offsets_.push_back(dimension_);
+    }
+
+    /**
+     * \return Number of blocks
+     */
+    int count() const
+    {
+        return int(identity_.size());
+    }
+
+    int offset(int i) const
+    {
+        return offsets_[i];
+    }
+
+    int size(int i) const
+    {
+        return offsets_[i + 1] - offsets_[i];
+    }
+
+    /**
+     * \return Whether the i-th block is an identity matrix
+     */
+    bool identity(int i) const
+    {
+        return identity_[i];
+    }
+
+    /**
+     * \return True if the matrix does not exhibit any exploitable structure,
+     *         i.e. it consists of a single non-identity block
+     */
+    bool dense() const
+    {
+        return count() <= 1 && !(count() == 1 && identity(0));
+    }
+
+    int dimension() const
+    {
+        return dimension_;
+    }
+
+protected:
+    /** \cond internal */
+    int dimension_;
+    std::vector<int> offsets_;
+    std::vector<bool> identity_;
+    std::vector<int> reach_;
+    /** \endcond */
+};
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Contiguous ranges of columns of a matrix containing non-zero
+ *        elements. All other columns are zero.
+ *
+ * A product \f$M X\f$ reduces to the sum of the products of the column
+ * blocks of \f$M\f$ with the corresponding row blocks of \f$X\f$.
+ */
+class ColumnBlocks
+{
+public:
+    ColumnBlocks()
+        : dimension_(0)
+    { }
+
+    /**
+     * \brief Detects the non-zero columns of \a matrix
+     */
+    template <typename Matrix>
+    explicit ColumnBlocks(const Eigen::MatrixBase<Matrix>& matrix)
+    {
+        detect(matrix);
+    }
+
+    /**
+     * \brief Detects the non-zero columns of \a matrix
+     */
+    template <typename Matrix>
+    void detect(const Eigen::MatrixBase<Matrix>& matrix)
+    {
+        dimension_ = matrix.cols();
+
+        offsets_.clear();
+        sizes_.clear();
+
+        for (int j = 0; j < dimension_; ++j)
+        {
+            if (matrix.col(j).isZero(0)) continue;
+
+            if (!offsets_.empty() && offsets_.back() + sizes_.back() == j)
+            {
+                ++sizes_.back();
+            }
+            else
+            {
+                offsets_.push_back(j);
+                sizes_.push_back(1);
+            }
+        }
+    }
+
+    /**
+     * \return Number of blocks
+     */
+    int count() const
+    {
+        return int(offsets_.size());
+    }
+
+    int offset(int i) const
+    {
+        return offsets_[i];
+    }
+
+    int size(int i) const
+    {
+        return sizes_[i];
+    }
+
+    /**
+     * \return Total number of columns of the matrix
+     */
+    int dimension() const
+    {
+        return dimension_;
+    }
+
+protected:
+    /** \cond internal */
+    int dimension_;
+    std::vector<int> offsets_;
+    std::vector<int> sizes_;
+    /** \endcond */
+};
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Computes \f$A P A^T\f$ for a matrix \f$A\f$ with the diagonal
+ *        block structure \a blocks.
+ *
+ * The cost is \f$O(n^2 b)\f$ for blocks of size \f$b\f$ instead of
+ * \f$O(n^3)\f$. Identity blocks are copied without any product.
+ *
+ * \param [in]  A       Block diagonal matrix
+ * \param [in]  blocks  Structure of \a A
+ * \param [in]  P       Dense square matrix
+ * \param [out] result  \f$A P A^T\f$. Must not alias \a P.
+ */
+template <typename MatrixA, typename MatrixP, typename Result>
+void block_diagonal_congruence(const MatrixA& A,
+                               const DiagonalBlocks& blocks,
+                               const MatrixP& P,
+                               Result& result)
+{
+    const int dim = P.rows();
+
+    result.resize(dim, dim);
+
+    // result = A P
+    for (int i = 0; i < blocks.count(); ++i)
+    {
+        const int o = blocks.offset(i);
+        const int s = blocks.size(i);
+
+        if (blocks.identity(i))
+        {
+            result.middleRows(o, s) = P.middleRows(o, s);
+        }
+        else
+        {
+            result.middleRows(o, s).noalias() =
+                A.block(o, o, s, s) * P.middleRows(o, s);
+        }
+    }
+
+    // result = (A P) A^T, block columns are independent
+    for (int i = 0; i < blocks.count(); ++i)
+    {
+        if (blocks.identity(i)) continue;
+
+        const int o = blocks.offset(i);
+        const int s = blocks.size(i);
+
+        result.middleCols(o, s) =
+            (result.middleCols(o, s) * A.block(o, o, s, s).transpose()).eval();
+    }
+}
+
+}
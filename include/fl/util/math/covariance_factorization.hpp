@@ -0,0 +1,321 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file covariance_factorization.hpp
+ * \date 2015
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#pragma once
+
+
+#include <Eigen/Dense>
+
+#include <cmath>
+
+namespace fl
+{
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Largest compile-time dimension for which CovarianceFactorization
+ *        uses the unrolled closed-form Cholesky decomposition
+ */
+enum : signed int { UnrolledFactorizationMaxSize = 12 };
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Whether a matrix of the compile-time size \a Size is factorized by
+ *        the unrolled closed-form kernels
+ */
+template <int Size>
+struct IsUnrolledFactorizationSize
+{
+    enum : bool
+    {
+        Value = Size > 0 && Size <= UnrolledFactorizationMaxSize
+    };
+};
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief Factorization of a symmetric positive semi-definite matrix
+ *        \f$\Sigma\f$, i.e. its Cholesky decomposition \f$ \Sigma = L L^T \f$
+ *        or, if \f$\Sigma\f$ is not positive definite, its pivoted LDLT
+ *        decomposition.
+ *
+ * The factorization provides everything a Gaussian needs from its covariance
+ * apart from the explicit inverse: the pivots (whose product is the
+ * determinant), a square root and the quadratic forms
+ * \f$ \delta^T \Sigma^{-1} \delta \f$.
+ *
+ * \tparam Matrix   Square matrix type
+ * \tparam Unrolled Selects the closed-form kernels for small fixed sizes
+ */
+template <
+    typename Matrix,
+    bool Unrolled = IsUnrolledFactorizationSize<
+                        Matrix::RowsAtCompileTime
+                    >::Value
+>
+class CovarianceFactorization
+{
+public:
+    typedef typename Matrix::Scalar Scalar;
+    typedef Eigen::Matrix<Scalar, Matrix::RowsAtCompileTime, 1> Pivots;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    CovarianceFactorization()
+        : positive_definite_(true)
+    { }
+
+    /**
+     * \brief Decomposes the symmetric matrix \a covariance. Only its lower
+     *        triangular part is accessed.
+     */
+    void compute(const Matrix& covariance)
+    {
+        llt_.compute(covariance);
+        positive_definite_ = (llt_.info() == Eigen::Success);
+
+        if (!positive_definite_) ldlt_.compute(covariance);
+    }
+
+    /**
+     * \return True if the matrix has been decomposed by a Cholesky
+     *         decomposition
+     */
+    bool positive_definite() const
+    {
+        return positive_definite_;
+    }
+
+    /**
+     * \return Squared diagonal of the Cholesky factor or the diagonal of the
+     *         LDLT. Their product is the determinant.
+     */
+    Pivots pivots() const
+    {
+        if (positive_definite_)
+        {
+            return llt_.matrixLLT().diagonal().array().square();
+        }
+
+        return ldlt_.vectorD();
+    }
+
+    /**
+     * \return Square root \f$ L \f$, \f$ L L^T = \Sigma \f$. Negative LDLT
+     *         pivots, which are due to round-off, are clamped to zero.
+     */
+    Matrix square_root() const
+    {
+        if (positive_definite_)
+        {
+            return llt_.matrixL();
+        }
+
+        return ldlt_.transpositionsP().transpose()
+               * Matrix(ldlt_.matrixL())
+               * ldlt_.vectorD().cwiseMax(Scalar(0)).cwiseSqrt().asDiagonal();
+    }
+
+    /**
+     * \return Quadratic forms \f$ \delta^T \Sigma^{-1} \delta \f$ of all
+     *         columns \f$ \delta \f$ of \a deltas which is used as workspace
+     *
+     * The columns are whitened by a forward substitution with \f$ L \f$,
+     * i.e. the forms are the squared column norms of \f$ L^{-1} \Delta \f$.
+     */
+    template <typename Deltas>
+    Eigen::Array<Scalar, 1, Deltas::ColsAtCompileTime>
+    squared_norms(Deltas& deltas) const
+    {
+        if (positive_definite_)
+        {
+            llt_.matrixL().solveInPlace(deltas);
+            return deltas.colwise().squaredNorm().array();
+        }
+
+        return deltas.cwiseProduct(ldlt_.solve(deltas))
+                     .colwise().sum().array();
+    }
+
+protected:
+    /** \cond internal */
+    Eigen::LLT<Matrix> llt_;
+    Eigen::LDLT<Matrix> ldlt_;
+    bool positive_definite_;
+    /** \endcond */
+};
+
+/**
+ * \ingroup linear_algebra
+ *
+ * \brief CovarianceFactorization of small fixed-size matrices.
+ *
+ * The Cholesky factor is computed in closed form by loops over compile-time
+ * bounds which the compiler unrolls completely, e.g. for \f$ 2\times 2 \f$
+ *
+ * \f$ l_{00} = \sqrt{a_{00}},\ l_{10} = a_{10} / l_{00},\
+ *     l_{11} = \sqrt{a_{11} - l_{10}^2} \f$.
+ *
+ * The forward substitution is unrolled the same way. The LDLT decomposition
+ * is only used if a pivot is not positive.
+ */
+template <typename Matrix>
+class CovarianceFactorization<Matrix, true>
+{
+public:
+    typedef typename Matrix::Scalar Scalar;
+    typedef Eigen::Matrix<Scalar, Matrix::RowsAtCompileTime, 1> Pivots;
+
+    enum : signed int { Size = Matrix::RowsAtCompileTime };
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    CovarianceFactorization()
+        : positive_definite_(true)
+    { }
+
+    /**
+     * \brief Decomposes the symmetric matrix \a covariance. Only its lower
+     *        triangular part is accessed.
+     */
+    void compute(const Matrix& covariance)
+    {
+        positive_definite_ = cholesky(covariance);
+
+        if (!positive_definite_) ldlt_.compute(covariance);
+    }
+
+    /**
+     * \copydoc CovarianceFactorization::positive_definite()
+     */
+    bool positive_definite() const
+    {
+        return positive_definite_;
+    }
+
+    /**
+     * \copydoc CovarianceFactorization::pivots()
+     */
+    Pivots pivots() const
+    {
+        if (positive_definite_)
+        {
+            return L_.diagonal().array().square();
+        }
+
+        return ldlt_.vectorD();
+    }
+
+    /**
+     * \copydoc CovarianceFactorization::square_root()
+     */
+    Matrix square_root() const
+    {
+        if (positive_definite_)
+        {
+            return L_;
+        }
+
+        return ldlt_.transpositionsP().transpose()
+               * Matrix(ldlt_.matrixL())
+               * ldlt_.vectorD().cwiseMax(Scalar(0)).cwiseSqrt().asDiagonal();
+    }
+
+    /**
+     * \copydoc CovarianceFactorization::squared_norms()
+     */
+    template <typename Deltas>
+    Eigen::Array<Scalar, 1, Deltas::ColsAtCompileTime>
+    squared_norms(Deltas& deltas) const
+    {
+        if (!positive_definite_)
+        {
+            return deltas.cwiseProduct(ldlt_.solve(deltas))
+                         .colwise().sum().array();
+        }
+
+        Eigen::Array<Scalar, 1, Deltas::ColsAtCompileTime>
+            norms(1, deltas.cols());
+
+        for (int c = 0; c < deltas.cols(); ++c)
+        {
+            Scalar z[Size];
+            Scalar norm = Scalar(0);
+
+            for (int i = 0; i < Size; ++i)
+            {
+                Scalar sum = deltas(i, c);
+                for (int k = 0; k < i; ++k) sum -= L_(i, k) * z[k];
+
+                z[i] = sum / L_(i, i);
+                norm += z[i] * z[i];
+            }
+
+            norms(c) = norm;
+        }
+
+        return norms;
+    }
+
+protected:
+    /** \cond internal */
+    /**
+     * \brief Closed-form Cholesky decomposition into \c L_
+     *
+     * \return False if a pivot is not positive
+     */
+    bool cholesky(const Matrix& A)
+    {
+        L_.setZero();
+
+        for (int j = 0; j < Size; ++j)
+        {
+            Scalar pivot = A(j, j);
+            for (int k = 0; k < j; ++k) pivot -= L_(j, k) * L_(j, k);
+
+            if (!(pivot > Scalar(0))) return false;
+
+            L_(j, j) = std::sqrt(pivot);
+            const Scalar inv_ljj = Scalar(1) / L_(j, j);
+
+            for (int i = j + 1; i < Size; ++i)
+            {
+                Scalar sum = A(i, j);
+                for (int k = 0; k < j; ++k) sum -= L_(i, k) * L_(j, k);
+
+                L_(i, j) = sum * inv_ljj;
+            }
+        }
+
+        return true;
+    }
+    /** \endcond */
+
+protected:
+    /** \cond internal */
+    Matrix L_;
+    Eigen::LDLT<Matrix> ldlt_;
+    bool positive_definite_;
+    /** \endcond */
+};
+
+}
@@ -0,0 +1,205 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file thread_pool.hpp
+ * \date 2015
+ * \author Jan Issac (jan.issac@gmail.com)
+ * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ */
+
+#pragma once
+
+
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace fl
+{
+
+/**
+ * \ingroup util
+ *
+ * \brief Fixed-size pool of worker threads executing chunked loops.
+ *
+ * A loop over \f$[0, N)\f$ is split into threads() contiguous chunks. The
+ * chunk boundaries only depend on \f$N\f$ and the number of threads, and
+ * chunk \f$c\f$ is always executed with the chunk index \f$c\f$. Hence, a
+ * loop body which keeps per-chunk state (e.g. one random number generator per
+ * chunk) yields the same result regardless of the thread scheduling.
+ *
+ * The calling thread executes the first chunk itself, i.e. a pool of \f$T\f$
+ * threads spawns \f$T-1\f$ workers. A pool with a single thread runs entirely
+ * on the calling thread.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * \brief Creates a pool with \a threads threads including the calling
+     *        thread
+     */
+    explicit ThreadPool(int threads = 1)
+        : threads_(threads < 1 ? 1 : threads),
+          generation_(0),
+          pending_(0),
+          shutdown_(false)
+    {
+        for (int chunk = 1; chunk < threads_; ++chunk)
+        {
+            workers_.emplace_back(&ThreadPool::work, this, chunk);
+        }
+    }
+
+    /**
+     * \brief Joins all worker threads
+     */
+    ~ThreadPool() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+        }
+        start_.notify_all();
+
+        for (auto& worker: workers_) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * \return Number of threads including the calling thread
+     */
+    int threads() const
+    {
+        return threads_;
+    }
+
+    /**
+     * \return First index of the chunk \a chunk of a loop of size \a size
+     */
+    int chunk_begin(int chunk, int size) const
+    {
+        return int((long(chunk) * size) / threads_);
+    }
+
+    /**
+     * \brief Executes \c body(chunk, begin, end) for each of the threads()
+     *        chunks of \f$[0, size)\f$ in parallel and blocks until all chunks
+     *        are done. An exception thrown within a chunk is rethrown here.
+     */
+    template <typename Body>
+    void parallel_for(int size, const Body& body)
+    {
+        if (threads_ == 1)
+        {
+            body(0, 0, size);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = [this, size, &body](int chunk)
+            {
+                body(chunk,
+                     chunk_begin(chunk, size),
+                     chunk_begin(chunk + 1, size));
+            };
+            error_ = nullptr;
+            pending_ = threads_ - 1;
+            ++generation_;
+        }
+        start_.notify_all();
+
+        std::exception_ptr error;
+        try
+        {
+            task_(0);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+
+        if (!error) error = error_;
+        task_ = nullptr;
+
+        if (error) std::rethrow_exception(error);
+    }
+
+protected:
+    /** \cond internal */
+    void work(int chunk)
+    {
+        long generation = 0;
+
+        while (true)
+        {
+            std::function<void(int)> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_.wait(lock, [&]
+                {
+                    return shutdown_ || generation_ != generation;
+                });
+
+                if (shutdown_) return;
+
+                generation = generation_;
+                task = task_;
+            }
+
+            std::exception_ptr error;
+            try
+            {
+                task(chunk);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (error && !error_) error_ = error;
+                --pending_;
+            }
+            done_.notify_one();
+        }
+    }
+    /** \endcond */
+
+protected:
+    /** \cond internal */
+    int threads_;
+    long generation_;
+    int pending_;
+    bool shutdown_;
+    std::function<void(int)> task_;
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    std::vector<std::thread> workers_;
+    /** \endcond */
+};
+
+}
@@ -223,12 +223,39 @@ TYPED_TEST_P(DecorrelatedGaussianTests, gaussian_covariance_constructor_init)
     EXPECT_NO_THROW(This::test_gaussian_covariance(gaussian));
 }
 
+TYPED_TEST_P(DecorrelatedGaussianTests, log_probabilities)
+{
+    typedef TestFixture This;
+    typedef fl::DecorrelatedGaussian<typename This::Vector> Gaussian;
+
+    if (This::Dim > 1000) return;
+
+    auto gaussian = Gaussian(This::Dim);
+    gaussian.mean(This::Vector::Random(This::Dim));
+    gaussian.covariance(
+        (This::Vector::Random(This::Dim).array() + 2.0).matrix().asDiagonal());
+
+    typename Gaussian::VariateMatrix points =
+        Gaussian::VariateMatrix::Random(This::Dim, 20);
+    typename Gaussian::ValueArray log_probs =
+        gaussian.log_probabilities(points);
+
+    ASSERT_EQ(log_probs.size(), 20);
+    for (int i = 0; i < points.cols(); ++i)
+    {
+        EXPECT_NEAR(log_probs(i),
+                    gaussian.log_probability(points.col(i)),
+                    1e-9);
+    }
+}
+
 REGISTER_TYPED_TEST_CASE_P(DecorrelatedGaussianTests,
                            dimension,
                            standard_covariance,
                            dynamic_uninitialized_gaussian,
                            gaussian_covariance_dimension_init,
-                           gaussian_covariance_constructor_init);
+                           gaussian_covariance_constructor_init,
+                           log_probabilities);
 
 template <int Dimension>
 struct TestConfiguration
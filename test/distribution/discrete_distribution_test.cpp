@@ -24,6 +24,7 @@
 #include <fl/distribution/discrete_distribution.hpp>
 #include <fl/distribution/gaussian.hpp>
 #include <fl/util/types.hpp>
+#include <fl/util/thread_pool.hpp>
 
 #include <Eigen/Core>
 #include <Eigen/Eigenvalues>
@@ -217,3 +218,142 @@ TEST(discrete_distribution, sampling_index)
 
 
 
+
+TEST(discrete_distribution, effective_sample_size)
+{
+    typedef Eigen::Vector3d Variate;
+    typedef fl::DiscreteDistribution<Variate> DiscreteDistribution;
+    typedef DiscreteDistribution::Function Function;
+
+    int N = 1000;
+
+    DiscreteDistribution discrete_distribution;
+    discrete_distribution.log_unnormalized_prob_mass(Function::Zero(N));
+    EXPECT_NEAR(discrete_distribution.effective_sample_size(), N, 1e-9);
+
+    // half of the locations carry all mass
+    Function log_pmf = Function::Zero(N);
+    log_pmf.tail(N / 2).setConstant(-1000);
+    discrete_distribution.log_unnormalized_prob_mass(log_pmf);
+    EXPECT_NEAR(discrete_distribution.effective_sample_size(), N / 2, 1e-9);
+
+    // matches 1 / sum(w^2) after a weight update
+    discrete_distribution.delta_log_prob_mass(Function::Random(N));
+    EXPECT_NEAR(discrete_distribution.effective_sample_size(),
+                1.0 / discrete_distribution.prob_mass().square().sum(),
+                1e-9);
+}
+
+TEST(discrete_distribution, lazy_cumulative_distribution)
+{
+    typedef Eigen::Vector3d Variate;
+    typedef fl::DiscreteDistribution<Variate> DiscreteDistribution;
+    typedef DiscreteDistribution::Function Function;
+
+    int N = 1000;
+
+    DiscreteDistribution discrete_distribution;
+    discrete_distribution.log_unnormalized_prob_mass(Function::Random(N));
+    discrete_distribution.delta_log_prob_mass(Function::Random(N));
+
+    Function pmf = discrete_distribution.prob_mass();
+    const Function& cdf = discrete_distribution.cumulative_distribution();
+
+    EXPECT_EQ(cdf.size(), N);
+    EXPECT_NEAR(cdf(0), pmf(0), 1e-12);
+    for(int i = 1; i < N; i++)
+    {
+        EXPECT_NEAR(cdf(i) - cdf(i - 1), pmf(i), 1e-12);
+    }
+    EXPECT_NEAR(cdf(N - 1), 1.0, 1e-9);
+
+    // the cdf follows subsequent weight changes
+    discrete_distribution.set_uniform(10);
+    EXPECT_EQ(discrete_distribution.cumulative_distribution().size(), 10);
+    EXPECT_NEAR(discrete_distribution.cumulative_distribution()(4), 0.5, 1e-12);
+}
+
+TEST(discrete_distribution, moments_match_two_pass)
+{
+    typedef Eigen::Vector3d Variate;
+    typedef Eigen::Matrix3d Covariance;
+    typedef fl::DiscreteDistribution<Variate> DiscreteDistribution;
+    typedef DiscreteDistribution::Function Function;
+
+    // not a multiple of the block size, large offset compared to the spread
+    int N = 1000;
+
+    DiscreteDistribution discrete_distribution;
+    discrete_distribution.log_unnormalized_prob_mass(Function::Random(N));
+    for(int i = 0; i < N; i++)
+    {
+        discrete_distribution.location(i) =
+            Variate::Constant(1e4) + 1e-2 * Variate::Random();
+    }
+
+    Function pmf = discrete_distribution.prob_mass();
+
+    Variate mean = Variate::Zero();
+    for(int i = 0; i < N; i++)
+    {
+        mean += pmf(i) * discrete_distribution.location(i);
+    }
+
+    Covariance covariance = Covariance::Zero();
+    for(int i = 0; i < N; i++)
+    {
+        Variate delta = discrete_distribution.location(i) - mean;
+        covariance += pmf(i) * delta * delta.transpose();
+    }
+
+    EXPECT_TRUE(discrete_distribution.mean().isApprox(mean, 1e-12));
+    EXPECT_TRUE(discrete_distribution.covariance().isApprox(covariance, 1e-6));
+}
+
+TEST(discrete_distribution, cached_moments_follow_changes)
+{
+    typedef Eigen::Vector3d Variate;
+    typedef fl::DiscreteDistribution<Variate> DiscreteDistribution;
+    typedef DiscreteDistribution::Function Function;
+
+    DiscreteDistribution discrete_distribution;
+    discrete_distribution.set_uniform(2);
+    discrete_distribution.location(0) = Variate(1, 0, 0);
+    discrete_distribution.location(1) = Variate(3, 0, 0);
+
+    EXPECT_TRUE(discrete_distribution.mean().isApprox(Variate(2, 0, 0)));
+    EXPECT_NEAR(discrete_distribution.covariance()(0, 0), 1.0, 1e-12);
+
+    // location change
+    discrete_distribution.location(1) = Variate(5, 0, 0);
+    EXPECT_TRUE(discrete_distribution.mean().isApprox(Variate(3, 0, 0)));
+    EXPECT_NEAR(discrete_distribution.covariance()(0, 0), 4.0, 1e-12);
+
+    // weight change
+    Function log_pmf(2);
+    log_pmf << std::log(3.0), 0.0;
+    discrete_distribution.log_unnormalized_prob_mass(log_pmf);
+    EXPECT_TRUE(discrete_distribution.mean().isApprox(Variate(2, 0, 0)));
+    EXPECT_NEAR(discrete_distribution.covariance()(0, 0), 3.0, 1e-12);
+}
+
+TEST(discrete_distribution, threaded_moments)
+{
+    typedef Eigen::VectorXd Variate;
+    typedef fl::DiscreteDistribution<Variate> DiscreteDistribution;
+    typedef DiscreteDistribution::Function Function;
+
+    int N = 10001;
+
+    DiscreteDistribution serial;
+    serial.log_unnormalized_prob_mass(Function::Random(N));
+    for(int i = 0; i < N; i++) serial.location(i) = Variate::Random(5);
+
+    DiscreteDistribution threaded = serial;
+
+    fl::ThreadPool thread_pool(4);
+    threaded.compute_moments(thread_pool);
+
+    EXPECT_TRUE(threaded.mean().isApprox(serial.mean(), 1e-12));
+    EXPECT_TRUE(threaded.covariance().isApprox(serial.covariance(), 1e-12));
+}
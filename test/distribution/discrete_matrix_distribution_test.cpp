@@ -0,0 +1,169 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <fl/distribution/discrete_distribution.hpp>
+#include <fl/distribution/discrete_matrix_distribution.hpp>
+#include <fl/distribution/gaussian.hpp>
+#include <fl/filter/particle/resampling/systematic_resampling.hpp>
+#include <fl/util/types.hpp>
+#include <fl/util/thread_pool.hpp>
+
+#include <Eigen/Core>
+
+TEST(discrete_matrix_distribution, default_initialization)
+{
+    typedef Eigen::Vector3d Variate;
+    typedef fl::DiscreteMatrixDistribution<Variate> DiscreteDistribution;
+
+    fl::Real e = 0.000000001;
+
+    DiscreteDistribution distribution;
+
+    EXPECT_TRUE(distribution.size() == 1);
+    EXPECT_TRUE(distribution.dimension() == 3);
+
+    EXPECT_TRUE(std::fabs(distribution.prob_mass(0) - 1.0) < e);
+    EXPECT_TRUE(std::fabs(distribution.log_prob_mass(0)) < e);
+    EXPECT_TRUE(std::fabs(distribution.entropy()) < e);
+    EXPECT_TRUE(std::fabs(distribution.kl_given_uniform()) < e);
+}
+
+TEST(discrete_matrix_distribution, moments_match_discrete_distribution)
+{
+    typedef Eigen::Vector3d Variate;
+    typedef fl::DiscreteDistribution<Variate> ArrayDistribution;
+    typedef fl::DiscreteMatrixDistribution<Variate> MatrixDistribution;
+    typedef ArrayDistribution::Function Function;
+
+    int N = 1000;
+    Function log_pmf = Function::Random(N);
+
+    ArrayDistribution array_distribution;
+    MatrixDistribution matrix_distribution;
+    array_distribution.log_unnormalized_prob_mass(log_pmf);
+    matrix_distribution.log_unnormalized_prob_mass(log_pmf);
+
+    for(int i = 0; i < N; i++)
+    {
+        array_distribution.location(i) = Variate::Random();
+        matrix_distribution.location(i) = array_distribution.location(i);
+    }
+
+    EXPECT_TRUE(matrix_distribution.mean().isApprox(
+                    array_distribution.mean(), 1e-9));
+    EXPECT_TRUE(matrix_distribution.covariance().isApprox(
+                    array_distribution.covariance(), 1e-9));
+    EXPECT_TRUE(matrix_distribution.max() == array_distribution.max());
+    EXPECT_NEAR(matrix_distribution.entropy(),
+                array_distribution.entropy(), 1e-9);
+}
+
+TEST(discrete_matrix_distribution, dynamic_size_from_gaussian)
+{
+    typedef Eigen::VectorXd Variate;
+    typedef fl::DiscreteMatrixDistribution<Variate> DiscreteDistribution;
+
+    fl::Gaussian<Variate> gaussian(4);
+
+    DiscreteDistribution distribution;
+    distribution.from_distribution(gaussian, 100000);
+
+    EXPECT_EQ(distribution.dimension(), 4);
+    EXPECT_EQ(distribution.size(), 100000);
+    EXPECT_TRUE(distribution.mean().norm() < 0.05);
+    EXPECT_TRUE(distribution.covariance().isApprox(
+                    Eigen::MatrixXd::Identity(4, 4), 0.05));
+}
+
+TEST(discrete_matrix_distribution, sampling_index)
+{
+    typedef fl::DiscreteMatrixDistribution<fl::ScalarMatrix>
+        DiscreteDistribution;
+    typedef DiscreteDistribution::Function Function;
+
+    int N_locations = 10;
+    int N_samples   = 100000;
+
+    Function pmf = Function::Random(N_locations).abs() + 0.01;
+    pmf /= pmf.sum();
+
+    DiscreteDistribution distribution;
+    distribution.log_unnormalized_prob_mass(pmf.log());
+
+    for(int i = 0; i < N_locations; i++) distribution.location(i)(0) = i;
+
+    Function empirical_pmf = Function::Zero(N_locations);
+    for(int i = 0; i < N_samples; i++)
+    {
+        int index;
+        fl::Real sample = distribution.sample(index);
+
+        EXPECT_TRUE(index == int(sample));
+        empirical_pmf(index) += 1./N_samples;
+    }
+
+    for(int i = 0; i < pmf.size(); i++)
+    {
+        EXPECT_TRUE(std::fabs(pmf[i] - empirical_pmf[i]) < 0.01);
+    }
+
+    // resampling in place keeps the locations consistent
+    distribution.from_distribution(distribution, 1000,
+                                   fl::SystematicResampling());
+
+    for(int i = 0; i < distribution.size(); i++)
+    {
+        fl::Real location = distribution.location(i)(0);
+        EXPECT_TRUE(location >= 0 && location < N_locations);
+    }
+}
+
+TEST(discrete_matrix_distribution, cached_moments_follow_changes)
+{
+    typedef Eigen::Vector2d Variate;
+    typedef fl::DiscreteMatrixDistribution<Variate> DiscreteDistribution;
+    typedef DiscreteDistribution::Function Function;
+
+    int N = 1000;
+
+    DiscreteDistribution distribution;
+    distribution.log_unnormalized_prob_mass(Function::Random(N));
+    distribution.locations().setRandom();
+
+    const Variate mean = distribution.mean();
+    EXPECT_TRUE(distribution.mean().isApprox(
+                    distribution.locations() * distribution.prob_mass()
+                                                            .matrix()));
+
+    // write access to all locations
+    distribution.locations().array() += 1.0;
+    EXPECT_TRUE(distribution.mean().isApprox(mean + Variate::Ones()));
+
+    // the covariance is invariant to the shift
+    fl::ThreadPool thread_pool(3);
+    DiscreteDistribution threaded = distribution;
+    threaded.location(0) = distribution.location(0);
+    threaded.compute_moments(thread_pool);
+
+    EXPECT_TRUE(threaded.mean().isApprox(distribution.mean(), 1e-12));
+    EXPECT_TRUE(threaded.covariance().isApprox(
+                    distribution.covariance(), 1e-12));
+}
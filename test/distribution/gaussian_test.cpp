@@ -23,6 +23,7 @@
 #include <cmath>
 #include <iostream>
 
+#include <fl/util/profiling.hpp>
 #include <fl/distribution/gaussian.hpp>
 
 template <typename TestType>
@@ -228,3 +229,125 @@ typedef ::testing::Types<
 INSTANTIATE_TYPED_TEST_CASE_P(GaussianTestCases,
                               GaussianTests,
                               TestTypes);
+
+TEST(GaussianFactorization, attributes_match_dense_computation)
+{
+    typedef fl::Gaussian<Eigen::Matrix<fl::Real, 30, 1>> Gaussian;
+    typedef Gaussian::SecondMoment Covariance;
+
+    Covariance A = Covariance::Random();
+    Covariance covariance = A * A.transpose() + Covariance::Identity();
+    Gaussian::Variate x = Gaussian::Variate::Random();
+
+    Gaussian gaussian;
+    gaussian.covariance(covariance);
+
+    Covariance L = gaussian.square_root();
+    EXPECT_TRUE(L.isApprox(covariance.llt().matrixL().toDenseMatrix()));
+    EXPECT_TRUE(gaussian.precision().isApprox(covariance.inverse()));
+    EXPECT_NEAR(gaussian.covariance_determinant() / covariance.determinant(),
+                1.0, 1e-9);
+    EXPECT_TRUE(gaussian.has_full_rank());
+
+    const fl::Real expected =
+        -0.5 * (std::log(covariance.determinant())
+                + 30 * std::log(2.0 * M_PI))
+        - 0.5 * x.dot(covariance.inverse() * x);
+    EXPECT_NEAR(gaussian.log_probability(x), expected, 1e-9);
+}
+
+TEST(GaussianFactorization, rank_deficient_covariance)
+{
+    typedef fl::Gaussian<Eigen::Matrix<fl::Real, 5, 1>> Gaussian;
+
+    Eigen::Matrix<fl::Real, 5, 2> B = Eigen::Matrix<fl::Real, 5, 2>::Random();
+
+    Gaussian gaussian;
+    gaussian.covariance(B * B.transpose());
+
+    EXPECT_FALSE(gaussian.has_full_rank());
+    EXPECT_TRUE(gaussian.square_root().allFinite());
+    EXPECT_TRUE((gaussian.square_root() * gaussian.square_root().transpose())
+                    .isApprox(B * B.transpose(), 1e-9));
+    EXPECT_EQ(gaussian.log_probability(Gaussian::Variate::Zero()),
+              -std::numeric_limits<fl::Real>::infinity());
+}
+
+TEST(GaussianFactorization, benchmark)
+{
+    typedef fl::Gaussian<Eigen::Matrix<fl::Real, 30, 1>> Gaussian;
+    typedef Gaussian::SecondMoment Covariance;
+
+    const int count = 2000;
+
+    Covariance A = Covariance::Random();
+    Covariance covariance = A * A.transpose() + Covariance::Identity();
+    Gaussian::Variate x = Gaussian::Variate::Random();
+
+    Gaussian gaussian;
+    fl::Real sum = 0;
+
+    INIT_PROFILING
+    for (int i = 0; i < count; ++i)
+    {
+        // separate rank, determinant and inverse decompositions
+        Covariance perturbed = covariance;
+        perturbed(0, 0) += 1e-3 * i;
+        bool full_rank =
+            perturbed.colPivHouseholderQr().rank() == perturbed.rows();
+        fl::Real determinant = perturbed.determinant();
+        Covariance precision = perturbed.inverse();
+        sum += full_rank ? std::log(determinant) - x.dot(precision * x) : 0;
+    }
+    MEASURE("log_probability with separate decompositions")
+
+    for (int i = 0; i < count; ++i)
+    {
+        Covariance perturbed = covariance;
+        perturbed(0, 0) += 1e-3 * i;
+        gaussian.covariance(perturbed);
+        sum += gaussian.log_probability(x);
+    }
+    MEASURE("log_probability with a single factorization")
+
+    EXPECT_TRUE(std::isfinite(sum));
+}
+
+TEST(GaussianFactorization, batch_log_probabilities)
+{
+    typedef fl::Gaussian<Eigen::Matrix<fl::Real, 6, 1>> Gaussian;
+    typedef Gaussian::SecondMoment Covariance;
+
+    Covariance A = Covariance::Random();
+    Gaussian gaussian;
+    gaussian.mean(Gaussian::Variate::Random());
+    gaussian.covariance(A * A.transpose() + Covariance::Identity());
+
+    Gaussian::VariateMatrix points = Gaussian::VariateMatrix::Random(6, 50);
+    Gaussian::ValueArray log_probs = gaussian.log_probabilities(points);
+
+    ASSERT_EQ(log_probs.size(), 50);
+    for (int i = 0; i < points.cols(); ++i)
+    {
+        Gaussian::Variate delta = points.col(i) - gaussian.mean();
+
+        EXPECT_NEAR(gaussian.squared_mahalanobis_distance(points.col(i)),
+                    delta.dot(gaussian.precision() * delta),
+                    1e-9);
+        EXPECT_NEAR(log_probs(i),
+                    gaussian.log_probability(points.col(i)),
+                    1e-9);
+    }
+
+    // diagonal representation
+    gaussian.diagonal_covariance(Covariance::Identity() * 2.0);
+    log_probs = gaussian.log_probabilities(points);
+    for (int i = 0; i < points.cols(); ++i)
+    {
+        Gaussian::Variate delta = points.col(i) - gaussian.mean();
+
+        EXPECT_NEAR(log_probs(i),
+                    -0.5 * (6 * std::log(4.0 * M_PI) + 0.5 * delta.dot(delta)),
+                    1e-9);
+    }
+}
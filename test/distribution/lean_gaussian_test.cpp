@@ -0,0 +1,182 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file lean_gaussian_test.cpp
+ * \date 2015
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+#include "../typecast.hpp"
+
+#include <Eigen/Dense>
+
+#include <cmath>
+
+#include <fl/distribution/gaussian.hpp>
+#include <fl/distribution/lean_gaussian.hpp>
+
+template <typename TestType>
+class LeanGaussianTests
+    : public testing::Test
+{
+public:
+    typedef typename TestType::Parameter Configuration;
+
+    enum: signed int
+    {
+        Dim = Configuration::Dim,
+        Size = fl::TestSize<Dim, TestType>::Value
+    };
+
+    typedef Eigen::Matrix<fl::Real, Size, 1> Vector;
+    typedef fl::LeanGaussian<Vector> LeanGaussian;
+    typedef fl::Gaussian<Vector> Gaussian;
+    typedef typename Gaussian::SecondMoment Covariance;
+
+    static Covariance random_covariance()
+    {
+        Covariance A = Covariance::Random(Dim, Dim);
+        return A * A.transpose() + Covariance::Identity(Dim, Dim);
+    }
+
+    static void expect_equal(const LeanGaussian& lean, const Gaussian& dense)
+    {
+        typename Gaussian::VariateMatrix points =
+            Gaussian::VariateMatrix::Random(Dim, 10);
+
+        EXPECT_TRUE(lean.covariance().isApprox(dense.covariance(), 1e-9));
+        EXPECT_TRUE(lean.precision().isApprox(dense.precision(), 1e-9));
+        EXPECT_TRUE((lean.square_root() * lean.square_root().transpose())
+                        .isApprox(dense.covariance(), 1e-9));
+        EXPECT_NEAR(lean.log_normalizer(), dense.log_normalizer(), 1e-9);
+        EXPECT_TRUE(lean.log_probabilities(points)
+                        .isApprox(dense.log_probabilities(points), 1e-9));
+    }
+};
+
+TYPED_TEST_CASE_P(LeanGaussianTests);
+
+TYPED_TEST_P(LeanGaussianTests, standard)
+{
+    typedef TestFixture This;
+
+    auto lean = typename This::LeanGaussian(This::Dim);
+
+    EXPECT_EQ(lean.dimension(), This::Dim);
+    EXPECT_TRUE(lean.mean().isZero());
+    EXPECT_TRUE(lean.covariance().isIdentity());
+    EXPECT_EQ(lean.allocated_slots(), 1);
+}
+
+TYPED_TEST_P(LeanGaussianTests, representations_match_gaussian)
+{
+    typedef TestFixture This;
+    typedef typename This::Covariance Covariance;
+
+    auto lean = typename This::LeanGaussian(This::Dim);
+    auto dense = typename This::Gaussian(This::Dim);
+
+    typename This::Vector mean = This::Vector::Random(This::Dim);
+    lean.mean(mean);
+    dense.mean(mean);
+
+    {
+        SCOPED_TRACE("Covariance setter");
+
+        Covariance covariance = This::random_covariance();
+        lean.covariance(covariance);
+        dense.covariance(covariance);
+        This::expect_equal(lean, dense);
+    }
+
+    {
+        SCOPED_TRACE("Precision setter");
+
+        Covariance precision = This::random_covariance();
+        lean.precision(precision);
+        dense.precision(precision);
+        This::expect_equal(lean, dense);
+    }
+
+    {
+        SCOPED_TRACE("SquareRoot setter");
+
+        Covariance square_root = This::random_covariance();
+        lean.square_root(square_root);
+        dense.square_root(square_root);
+        This::expect_equal(lean, dense);
+    }
+}
+
+TYPED_TEST_P(LeanGaussianTests, slots_allocated_on_demand)
+{
+    typedef TestFixture This;
+
+    auto lean = typename This::LeanGaussian(This::Dim);
+    lean.covariance(This::random_covariance());
+
+    lean.covariance();
+    EXPECT_EQ(lean.allocated_slots(), 1);
+
+    lean.log_probability(This::Vector::Zero(This::Dim));
+    EXPECT_EQ(lean.allocated_slots(), 2);
+
+    lean.precision();
+    lean.square_root();
+    EXPECT_EQ(lean.allocated_slots(), 4);
+
+    // copies only carry allocated slots
+    auto copy = lean;
+    EXPECT_EQ(copy.allocated_slots(), 4);
+    EXPECT_TRUE(copy.precision().isApprox(lean.precision()));
+
+    lean.release_derived_representations();
+    EXPECT_EQ(lean.allocated_slots(), 1);
+    EXPECT_TRUE(lean.precision().isApprox(copy.precision()));
+}
+
+REGISTER_TYPED_TEST_CASE_P(LeanGaussianTests,
+                           standard,
+                           representations_match_gaussian,
+                           slots_allocated_on_demand);
+
+template <int Dimension>
+struct TestConfiguration
+{
+    enum: signed int { Dim = Dimension };
+};
+
+typedef ::testing::Types<
+            fl::StaticTest<TestConfiguration<2>>,
+            fl::StaticTest<TestConfiguration<3>>,
+            fl::StaticTest<TestConfiguration<10>>,
+            fl::DynamicTest<TestConfiguration<2>>,
+            fl::DynamicTest<TestConfiguration<3>>,
+            fl::DynamicTest<TestConfiguration<10>>,
+            fl::DynamicTest<TestConfiguration<100>>
+        > TestTypes;
+
+INSTANTIATE_TYPED_TEST_CASE_P(LeanGaussianTestCases,
+                              LeanGaussianTests,
+                              TestTypes);
+
+TEST(LeanGaussian, footprint)
+{
+    typedef Eigen::Matrix<fl::Real, 100, 1> Vector;
+
+    // the standard Gaussian generator is part of both
+    EXPECT_LT(sizeof(fl::LeanGaussian<Vector>) * 20,
+              sizeof(fl::Gaussian<Vector>));
+}
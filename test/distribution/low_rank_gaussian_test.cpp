@@ -0,0 +1,181 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file low_rank_gaussian_test.cpp
+ * \date 2015
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+#include "../typecast.hpp"
+
+#include <Eigen/Dense>
+
+#include <cmath>
+
+#include <fl/distribution/gaussian.hpp>
+#include <fl/distribution/low_rank_gaussian.hpp>
+#include <fl/filter/gaussian/transform/point_set.hpp>
+#include <fl/filter/gaussian/transform/unscented_transform.hpp>
+
+template <typename TestType>
+class LowRankGaussianTests
+    : public testing::Test
+{
+public:
+    typedef typename TestType::Parameter Configuration;
+
+    enum: signed int
+    {
+        Dim = Configuration::Dim,
+        Rank = Configuration::Rank,
+        Size = fl::TestSize<Dim, TestType>::Value,
+        RankSize = fl::TestSize<Rank, TestType>::Value
+    };
+
+    typedef Eigen::Matrix<fl::Real, Size, 1> Vector;
+    typedef fl::LowRankGaussian<Vector, RankSize> LowRankGaussian;
+    typedef fl::Gaussian<Vector> Gaussian;
+
+    /**
+     * Creates a random low-rank Gaussian and its dense counterpart
+     */
+    static void create(LowRankGaussian& low_rank, Gaussian& dense)
+    {
+        typename LowRankGaussian::DiagonalVector diagonal =
+            LowRankGaussian::DiagonalVector::Random(Dim).array().abs() + 0.5;
+        typename LowRankGaussian::LowRankFactor factor =
+            LowRankGaussian::LowRankFactor::Random(Dim, Rank);
+        Vector mean = Vector::Random(Dim);
+
+        low_rank.mean(mean);
+        low_rank.covariance(diagonal, factor);
+
+        dense.mean(mean);
+        dense.covariance(
+            typename Gaussian::SecondMoment(diagonal.asDiagonal())
+            + factor * factor.transpose());
+    }
+};
+
+TYPED_TEST_CASE_P(LowRankGaussianTests);
+
+TYPED_TEST_P(LowRankGaussianTests, dense_representations)
+{
+    typedef TestFixture This;
+
+    auto low_rank = typename This::LowRankGaussian(This::Dim, This::Rank);
+    auto dense = typename This::Gaussian(This::Dim);
+    This::create(low_rank, dense);
+
+    EXPECT_EQ(low_rank.standard_variate_dimension(), This::Dim + This::Rank);
+    EXPECT_TRUE(low_rank.covariance().isApprox(dense.covariance()));
+    EXPECT_TRUE(low_rank.precision().isApprox(dense.precision(), 1e-9));
+    EXPECT_TRUE((low_rank.square_root() * low_rank.square_root().transpose())
+                    .isApprox(dense.covariance(), 1e-9));
+    EXPECT_NEAR(low_rank.covariance_determinant() /
+                    dense.covariance_determinant(),
+                1.0, 1e-9);
+}
+
+TYPED_TEST_P(LowRankGaussianTests, log_probabilities)
+{
+    typedef TestFixture This;
+
+    auto low_rank = typename This::LowRankGaussian(This::Dim, This::Rank);
+    auto dense = typename This::Gaussian(This::Dim);
+    This::create(low_rank, dense);
+
+    typename This::Gaussian::VariateMatrix points =
+        This::Gaussian::VariateMatrix::Random(This::Dim, 20);
+
+    auto expected = dense.log_probabilities(points);
+    auto log_probs = low_rank.log_probabilities(points);
+
+    ASSERT_EQ(log_probs.size(), 20);
+    for (int i = 0; i < points.cols(); ++i)
+    {
+        EXPECT_NEAR(log_probs(i), expected(i), 1e-9);
+        EXPECT_NEAR(low_rank.log_probability(points.col(i)),
+                    expected(i),
+                    1e-9);
+    }
+}
+
+TYPED_TEST_P(LowRankGaussianTests, map_standard_normal)
+{
+    typedef TestFixture This;
+    typedef typename This::LowRankGaussian::StandardVariate StandardVariate;
+
+    auto low_rank = typename This::LowRankGaussian(This::Dim, This::Rank);
+    auto dense = typename This::Gaussian(This::Dim);
+    This::create(low_rank, dense);
+
+    // the mapping is affine, its linear part A satisfies A A^T = Sigma
+    const int snv_dim = This::Dim + This::Rank;
+    Eigen::MatrixXd A(This::Dim, snv_dim);
+    for (int j = 0; j < snv_dim; ++j)
+    {
+        A.col(j) = low_rank.map_standard_normal(
+                       StandardVariate::Unit(snv_dim, j))
+                   - low_rank.mean();
+    }
+
+    EXPECT_TRUE((A * A.transpose()).isApprox(dense.covariance(), 1e-9));
+}
+
+TYPED_TEST_P(LowRankGaussianTests, unscented_transform)
+{
+    typedef TestFixture This;
+    typedef fl::PointSet<typename This::Vector> PointSet;
+
+    auto low_rank = typename This::LowRankGaussian(This::Dim, This::Rank);
+    auto dense = typename This::Gaussian(This::Dim);
+    This::create(low_rank, dense);
+
+    fl::UnscentedTransform transform;
+    PointSet point_set(This::Dim);
+    transform(low_rank, point_set);
+
+    auto centered = point_set.centered_points();
+    auto weights = point_set.covariance_weights_vector();
+
+    EXPECT_TRUE(point_set.mean().isApprox(dense.mean(), 1e-9));
+    EXPECT_TRUE((centered * weights.asDiagonal() * centered.transpose())
+                    .isApprox(dense.covariance(), 1e-9));
+}
+
+REGISTER_TYPED_TEST_CASE_P(LowRankGaussianTests,
+                           dense_representations,
+                           log_probabilities,
+                           map_standard_normal,
+                           unscented_transform);
+
+template <int Dimension, int LowRank>
+struct TestConfiguration
+{
+    enum: signed int { Dim = Dimension, Rank = LowRank };
+};
+
+typedef ::testing::Types<
+            fl::StaticTest<TestConfiguration<2, 1>>,
+            fl::StaticTest<TestConfiguration<10, 3>>,
+            fl::DynamicTest<TestConfiguration<2, 1>>,
+            fl::DynamicTest<TestConfiguration<10, 3>>,
+            fl::DynamicTest<TestConfiguration<200, 5>>
+        > TestTypes;
+
+INSTANTIATE_TYPED_TEST_CASE_P(LowRankGaussianTestCases,
+                              LowRankGaussianTests,
+                              TestTypes);
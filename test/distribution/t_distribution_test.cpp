@@ -83,6 +83,29 @@ TYPED_TEST_P(TDistributionTests, probability)
     }
 }
 
+TYPED_TEST_P(TDistributionTests, log_probabilities)
+{
+    typedef TestFixture This;
+    typedef typename This::TDistribution TDistribution;
+
+    auto t_distr = TDistribution(This::DegreesOfFreedom);
+    t_distr.location(0.5);
+    t_distr.scaling_matrix(fl::ScalarMatrix(2.0));
+
+    typename TDistribution::VariateMatrix points =
+        TDistribution::VariateMatrix::Random(1, 100) * 10.;
+    typename TDistribution::ValueArray log_probs =
+        t_distr.log_probabilities(points);
+
+    ASSERT_EQ(log_probs.size(), 100);
+    for (int i = 0; i < points.cols(); ++i)
+    {
+        EXPECT_NEAR(log_probs(i),
+                    t_distr.log_probability(points(0, i)),
+                    1e-9);
+    }
+}
+
 //TYPED_TEST_P(TDistributionTests, map_standard_uniform)
 //{
 //    typedef TestFixture This;
@@ -127,7 +150,8 @@ TYPED_TEST_P(TDistributionTests, probability)
 REGISTER_TYPED_TEST_CASE_P(TDistributionTests,
                            initial_degrees_of_freedom,
                            degrees_of_freedom,
-                           probability);
+                           probability,
+                           log_probabilities);
 
 template <int DOF>
 struct TestConfiguration
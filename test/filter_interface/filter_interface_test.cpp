@@ -106,3 +106,17 @@ TEST(FilterInterface, TemplatedFilter)
     EXPECT_DOUBLE_EQ(filter_context.dist_, (3. + 2.)/3. );
     EXPECT_DOUBLE_EQ(filter_context.y_, 2.);
 }
+
+TEST(FilterInterface, BatchUpdateDefaultsToSequentialUpdates)
+{
+    FilterForFun filter;
+
+    FilterForFun::Obsrvs obsrvs;
+    obsrvs.push_back(2.);
+    obsrvs.push_back(4.);
+
+    FilterForFun::Belief belief = 2.;
+    filter.batch_update(belief, obsrvs, belief);
+
+    EXPECT_DOUBLE_EQ(belief, ((2. + 2.) / 2. + 4.) / 2.);
+}
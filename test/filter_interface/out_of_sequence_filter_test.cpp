@@ -0,0 +1,172 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <fl/filter/out_of_sequence_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+typedef Eigen::Matrix<fl::Real, 4, 1> State;
+typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+typedef fl::GaussianFilter<Transition, Sensor> Filter;
+typedef fl::OutOfSequenceFilter<Filter> OutOfSequenceFilter;
+
+class OutOfSequenceFilterTests
+    : public ::testing::Test
+{
+protected:
+    OutOfSequenceFilterTests()
+        : filter_(create_filter())
+    { }
+
+    static Filter create_filter()
+    {
+        // constant velocity model of two coordinates
+        Transition::DynamicsMatrix A = Transition::DynamicsMatrix::Identity();
+        A(0, 2) = 0.1;
+        A(1, 3) = 0.1;
+        Transition transition;
+        transition.dynamics_matrix(A);
+        transition.noise_matrix(0.1 * Transition::NoiseMatrix::Identity());
+
+        Sensor::SensorMatrix H = Sensor::SensorMatrix::Zero();
+        H(0, 0) = 1;
+        H(1, 1) = 1;
+        Sensor sensor;
+        sensor.sensor_matrix(H);
+        sensor.noise_covariance(0.2 * Sensor::NoiseMatrix::Identity());
+
+        return Filter(transition, sensor);
+    }
+
+    static State input(int t)
+    {
+        State u = State::Zero();
+        u(2) = 0.01 * std::cos(0.3 * t);
+        return u;
+    }
+
+    static Obsrv observation(int t)
+    {
+        return Obsrv(std::sin(0.1 * t), 0.05 * t);
+    }
+
+    /**
+     * Runs the filter in sequence with the observations of all steps
+     */
+    Filter::Belief in_sequence(int steps,
+                               const std::vector<Obsrv>& extra_obsrvs,
+                               const std::vector<int>& extra_steps)
+    {
+        Filter::Belief belief = filter_.create_belief();
+
+        for (int t = 0; t < steps; ++t)
+        {
+            if (t > 0) filter_.predict(belief, input(t), belief);
+            filter_.update(belief, observation(t), belief);
+
+            for (int i = 0; i < int(extra_obsrvs.size()); ++i)
+            {
+                if (extra_steps[i] == t)
+                {
+                    filter_.update(belief, extra_obsrvs[i], belief);
+                }
+            }
+        }
+
+        return belief;
+    }
+
+protected:
+    Filter filter_;
+};
+
+TEST_F(OutOfSequenceFilterTests, in_sequence_matches_filter)
+{
+    OutOfSequenceFilter oos_filter(filter_, filter_.create_belief(), 5);
+
+    for (int t = 0; t < 10; ++t)
+    {
+        if (t > 0) oos_filter.predict(input(t));
+        oos_filter.update(observation(t));
+    }
+
+    auto expected = in_sequence(10, {}, {});
+
+    EXPECT_EQ(oos_filter.size(), 5);
+    EXPECT_TRUE(oos_filter.belief().mean().isApprox(expected.mean()));
+    EXPECT_TRUE(oos_filter.belief().covariance().isApprox(
+                    expected.covariance()));
+}
+
+TEST_F(OutOfSequenceFilterTests, delayed_observation_matches_in_sequence)
+{
+    const Obsrv delayed(0.3, -0.2);
+
+    OutOfSequenceFilter oos_filter(filter_, filter_.create_belief(), 8, 2);
+
+    for (int t = 0; t < 12; ++t)
+    {
+        if (t > 0) oos_filter.predict(input(t));
+        oos_filter.update(observation(t));
+    }
+
+    // observation of step 8 arrives 3 steps late
+    EXPECT_TRUE(oos_filter.update(delayed, 3));
+
+    auto expected = in_sequence(12, {delayed}, {8});
+
+    EXPECT_TRUE(oos_filter.belief().mean().isApprox(expected.mean()));
+    EXPECT_TRUE(oos_filter.belief().covariance().isApprox(
+                    expected.covariance()));
+
+    // steps before the insertion point are not affected
+    auto before = in_sequence(8, {}, {});
+    EXPECT_TRUE(oos_filter.belief(4).mean().isApprox(before.mean()));
+}
+
+TEST_F(OutOfSequenceFilterTests, too_old_observation_is_discarded)
+{
+    OutOfSequenceFilter oos_filter(filter_, filter_.create_belief(), 3);
+
+    for (int t = 0; t < 6; ++t)
+    {
+        if (t > 0) oos_filter.predict(input(t));
+        oos_filter.update(observation(t));
+    }
+
+    auto belief = oos_filter.belief();
+
+    EXPECT_FALSE(oos_filter.update(Obsrv::Ones(), 3));
+    EXPECT_TRUE(oos_filter.belief().mean().isApprox(belief.mean()));
+    EXPECT_THROW(oos_filter.belief(3), fl::Exception);
+
+    EXPECT_TRUE(oos_filter.update(Obsrv::Ones(), 2));
+    EXPECT_FALSE(oos_filter.belief().mean().isApprox(belief.mean()));
+}
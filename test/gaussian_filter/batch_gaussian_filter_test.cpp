@@ -0,0 +1,173 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <fl/util/profiling.hpp>
+#include <fl/filter/gaussian/batch_gaussian_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+/*
+ * Constant velocity tracks in the plane, [x, y, vx, vy], observed by their
+ * positions
+ */
+typedef Eigen::Matrix<fl::Real, 4, 1> State;
+typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+
+typedef fl::BatchGaussianFilter<Transition, Sensor> BatchFilter;
+typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+typedef BatchFilter::Belief BatchBelief;
+typedef BatchFilter::BatchMatrix BatchMatrix;
+
+class BatchGaussianFilterTests
+    : public ::testing::Test
+{
+protected:
+    BatchGaussianFilterTests()
+    {
+        Transition::DynamicsMatrix A = Transition::DynamicsMatrix::Identity();
+        A(0, 2) = 0.1;
+        A(1, 3) = 0.1;
+        transition_.dynamics_matrix(A);
+        transition_.noise_matrix(0.1 * Transition::NoiseMatrix::Random());
+        transition_.input_matrix(0.5 * Transition::InputMatrix::Random());
+
+        Sensor::SensorMatrix H = Sensor::SensorMatrix::Zero();
+        H(0, 0) = 1;
+        H(1, 1) = 1;
+        H(1, 2) = 0.3;
+        sensor_.sensor_matrix(H);
+        Sensor::NoiseMatrix R;
+        R << 0.3, 0.1,
+             0.1, 0.2;
+        sensor_.noise_covariance(R);
+    }
+
+    Transition transition_;
+    Sensor sensor_;
+};
+
+TEST_F(BatchGaussianFilterTests, packed_covariances)
+{
+    BatchBelief belief(3);
+
+    Eigen::Matrix4d P = Eigen::Matrix4d::Random();
+    P = P * P.transpose();
+
+    belief.covariance(1, P);
+
+    EXPECT_TRUE(belief.covariance(0).isIdentity());
+    EXPECT_TRUE(belief.covariance(1).isApprox(P));
+    EXPECT_EQ(belief.covariances().rows(), 10);
+    EXPECT_EQ(BatchBelief::packed_index(1, 3), BatchBelief::packed_index(3, 1));
+}
+
+TEST_F(BatchGaussianFilterTests, matches_independent_filters)
+{
+    const int size = 50;
+
+    BatchFilter batch_filter(transition_, sensor_);
+    Filter filter(transition_, sensor_);
+
+    BatchBelief batch_belief = batch_filter.create_belief(size);
+    std::vector<Filter::Belief> beliefs(size, filter.create_belief());
+
+    for (int k = 0; k < size; ++k)
+    {
+        Eigen::Matrix4d P = Eigen::Matrix4d::Random();
+        beliefs[k].mean(State::Random());
+        beliefs[k].covariance(P * P.transpose());
+        batch_belief.gaussian(k, beliefs[k]);
+    }
+
+    for (int t = 0; t < 20; ++t)
+    {
+        const BatchMatrix u = BatchMatrix::Random(4, size);
+        const BatchMatrix y = BatchMatrix::Random(2, size);
+
+        batch_filter.predict(batch_belief, u);
+        batch_filter.update(batch_belief, y);
+
+        for (int k = 0; k < size; ++k)
+        {
+            filter.predict(beliefs[k], u.col(k), beliefs[k]);
+            filter.update(beliefs[k], y.col(k), beliefs[k]);
+        }
+    }
+
+    for (int k = 0; k < size; ++k)
+    {
+        EXPECT_TRUE(batch_belief.mean(k).isApprox(beliefs[k].mean(), 1e-9));
+        EXPECT_TRUE(batch_belief.covariance(k).isApprox(
+                        beliefs[k].covariance(), 1e-9));
+    }
+
+    // prediction without input
+    batch_filter.predict(batch_belief);
+    filter.predict(beliefs[7], State::Zero(), beliefs[7]);
+    EXPECT_TRUE(batch_belief.mean(7).isApprox(beliefs[7].mean(), 1e-9));
+    EXPECT_TRUE(batch_belief.covariance(7).isApprox(
+                    beliefs[7].covariance(), 1e-9));
+}
+
+TEST_F(BatchGaussianFilterTests, benchmark)
+{
+    const int size = 20000;
+    const int steps = 5;
+
+    const BatchMatrix u = BatchMatrix::Random(4, size);
+    const BatchMatrix y = BatchMatrix::Random(2, size);
+
+    BatchFilter batch_filter(transition_, sensor_);
+    BatchBelief batch_belief = batch_filter.create_belief(size);
+
+    Filter filter(transition_, sensor_);
+    std::vector<Filter::Belief> beliefs(size, filter.create_belief());
+
+    INIT_PROFILING
+    for (int t = 0; t < steps; ++t)
+    {
+        for (int k = 0; k < size; ++k)
+        {
+            filter.predict(beliefs[k], u.col(k), beliefs[k]);
+            filter.update(beliefs[k], y.col(k), beliefs[k]);
+        }
+    }
+    MEASURE("5 predict/update cycles of 20k separate GaussianFilter beliefs")
+
+    for (int t = 0; t < steps; ++t)
+    {
+        batch_filter.predict(batch_belief, u);
+        batch_filter.update(batch_belief, y);
+    }
+    MEASURE("5 predict/update cycles of a BatchGaussianFilter of 20k beliefs")
+
+    EXPECT_TRUE(batch_belief.mean(size - 1).isApprox(
+                    beliefs[size - 1].mean(), 1e-9));
+}
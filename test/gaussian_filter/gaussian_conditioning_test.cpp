@@ -0,0 +1,145 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <Eigen/Dense>
+
+#include <fl/util/math/linear_algebra.hpp>
+#include <fl/distribution/gaussian.hpp>
+#include <fl/filter/gaussian/gaussian_conditioning.hpp>
+
+typedef Eigen::Matrix<fl::Real, 5, 1> State;
+typedef Eigen::Matrix<fl::Real, 3, 1> Obsrv;
+typedef Eigen::Matrix<fl::Real, 5, 5> StateCovariance;
+typedef Eigen::Matrix<fl::Real, 3, 3> ObsrvCovariance;
+typedef Eigen::Matrix<fl::Real, 5, 3> CrossCovariance;
+
+static StateCovariance random_covariance()
+{
+    StateCovariance A = StateCovariance::Random();
+    return A * A.transpose() + StateCovariance::Identity();
+}
+
+TEST(GaussianConditioningTests, matches_explicit_inverse)
+{
+    Eigen::Matrix<fl::Real, 3, 5> H = Eigen::Matrix<fl::Real, 3, 5>::Random();
+
+    StateCovariance cov_xx = random_covariance();
+    CrossCovariance cov_xy = cov_xx * H.transpose();
+    ObsrvCovariance cov_yy = H * cov_xy + ObsrvCovariance::Identity();
+
+    State mean = State::Random();
+    Obsrv innovation = Obsrv::Random();
+
+    CrossCovariance K = cov_xy * cov_yy.inverse();
+    State expected_mean = mean + K * innovation;
+    StateCovariance expected_covariance = cov_xx - K * cov_xy.transpose();
+
+    fl::condition_gaussian(cov_xy, cov_yy, innovation, mean, cov_xx);
+
+    EXPECT_TRUE(fl::are_similar(mean, expected_mean));
+    EXPECT_TRUE(fl::are_similar(cov_xx, expected_covariance));
+    EXPECT_TRUE(cov_xx == cov_xx.transpose());
+}
+
+TEST(GaussianConditioningTests, rejects_indefinite_observation_covariance)
+{
+    StateCovariance cov_xx = random_covariance();
+    CrossCovariance cov_xy = CrossCovariance::Random();
+    ObsrvCovariance cov_yy = -ObsrvCovariance::Identity();
+
+    State mean = State::Zero();
+    Obsrv innovation = Obsrv::Ones();
+
+    EXPECT_THROW(
+        fl::condition_gaussian(cov_xy, cov_yy, innovation, mean, cov_xx),
+        fl::Exception);
+}
+
+TEST(GaussianConditioningTests, factorized_covariance_sets_square_root)
+{
+    fl::Gaussian<State> gaussian;
+    StateCovariance covariance = random_covariance();
+
+    fl::set_factorized_covariance(gaussian, covariance);
+
+    StateCovariance L = gaussian.square_root();
+    EXPECT_TRUE(gaussian.covariance().isApprox(covariance));
+    EXPECT_TRUE(fl::are_similar(L * L.transpose(), covariance));
+    EXPECT_TRUE(L.isApprox(covariance.llt().matrixL().toDenseMatrix()));
+}
+
+TEST(GaussianConditioningTests, factorized_covariance_repairs_round_off)
+{
+    // rank deficient covariance perturbed into a slightly indefinite one
+    Eigen::Matrix<fl::Real, 5, 2> B = Eigen::Matrix<fl::Real, 5, 2>::Random();
+    StateCovariance covariance = B * B.transpose();
+    covariance(4, 4) -= 1e-12;
+
+    ASSERT_NE(covariance.llt().info(), Eigen::Success);
+
+    fl::Gaussian<State> gaussian;
+    fl::set_factorized_covariance(gaussian, covariance);
+
+    StateCovariance L = gaussian.square_root();
+    EXPECT_TRUE(L.allFinite());
+    EXPECT_TRUE(fl::are_similar(L * L.transpose(), gaussian.covariance()));
+    EXPECT_TRUE(fl::are_similar(gaussian.covariance(), covariance));
+
+    Eigen::SelfAdjointEigenSolver<StateCovariance> solver(
+        gaussian.covariance());
+    EXPECT_GT(solver.eigenvalues().minCoeff(), -1e-12);
+}
+
+TEST(GaussianConditioningTests, information_posterior)
+{
+    StateCovariance precision = random_covariance();
+    State mean = State::Random();
+    State information = State::Random();
+
+    fl::Gaussian<State> gaussian;
+    fl::set_information_posterior(mean, precision, information, gaussian);
+
+    StateCovariance covariance = precision.inverse();
+    StateCovariance L = gaussian.square_root();
+
+    EXPECT_TRUE(fl::are_similar(gaussian.covariance(), covariance));
+    EXPECT_TRUE(fl::are_similar(L * L.transpose(), covariance));
+    EXPECT_TRUE(fl::are_similar(gaussian.mean(),
+                                mean + covariance * information));
+}
+
+TEST(GaussianConditioningTests, covariance_with_square_root)
+{
+    fl::Gaussian<State> gaussian;
+    StateCovariance covariance = random_covariance();
+    StateCovariance square_root = covariance.llt().matrixL();
+
+    gaussian.covariance(covariance, square_root);
+
+    EXPECT_TRUE(gaussian.square_root() == square_root);
+    EXPECT_TRUE(gaussian.covariance() == covariance);
+
+    // setting the covariance alone invalidates the square root
+    gaussian.covariance(StateCovariance::Identity());
+    EXPECT_TRUE(gaussian.square_root().isIdentity());
+}
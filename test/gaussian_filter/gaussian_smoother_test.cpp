@@ -0,0 +1,258 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <fl/filter/gaussian/gaussian_smoother.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/filter/gaussian/quadrature/unscented_quadrature.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+typedef Eigen::Matrix<fl::Real, 4, 1> State;
+typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+
+typedef fl::GaussianFilter<Transition, Sensor> Filter;
+typedef fl::GaussianSmoother<Transition> Smoother;
+typedef fl::GaussianSmoother<Transition, fl::UnscentedQuadrature>
+    UnscentedSmoother;
+
+typedef Smoother::Belief Belief;
+
+class GaussianSmootherTests
+    : public ::testing::Test
+{
+protected:
+    GaussianSmootherTests()
+    {
+        // constant velocity model of two coordinates
+        Transition::DynamicsMatrix A = Transition::DynamicsMatrix::Identity();
+        A(0, 2) = 0.1;
+        A(1, 3) = 0.1;
+        transition_.dynamics_matrix(A);
+        transition_.noise_matrix(0.1 * Transition::NoiseMatrix::Identity());
+
+        Sensor::SensorMatrix H = Sensor::SensorMatrix::Zero();
+        H(0, 0) = 1;
+        H(1, 1) = 1;
+        sensor_.sensor_matrix(H);
+        sensor_.noise_covariance(0.2 * Sensor::NoiseMatrix::Identity());
+
+        run_filter(20);
+    }
+
+    void run_filter(int steps)
+    {
+        Filter filter(transition_, sensor_);
+
+        Belief belief = filter.create_belief();
+        Belief predicted = belief;
+
+        for (int t = 0; t < steps; ++t)
+        {
+            State u = State::Zero();
+            u(2) = 0.01 * std::cos(0.3 * t);
+
+            if (t > 0) filter.predict(filtered_.back(), inputs_.back(),
+                                      predicted);
+            filter.update(predicted,
+                          Obsrv(std::sin(0.1 * t), 0.05 * t),
+                          belief);
+
+            filtered_.push_back(belief);
+            inputs_.push_back(u);
+        }
+    }
+
+protected:
+    Transition transition_;
+    Sensor sensor_;
+    std::vector<Belief> filtered_;
+    std::vector<State> inputs_;
+};
+
+TEST_F(GaussianSmootherTests, last_belief_is_filtered_belief)
+{
+    Smoother smoother(transition_);
+
+    std::vector<Belief> smoothed;
+    smoother.smooth(filtered_, inputs_, smoothed);
+
+    ASSERT_EQ(smoothed.size(), filtered_.size());
+    EXPECT_TRUE(smoothed.back().mean().isApprox(filtered_.back().mean()));
+    EXPECT_TRUE(smoothed.back().covariance().isApprox(
+                    filtered_.back().covariance()));
+}
+
+TEST_F(GaussianSmootherTests, smoothing_reduces_uncertainty)
+{
+    Smoother smoother(transition_);
+
+    std::vector<Belief> smoothed;
+    smoother.smooth(filtered_, inputs_, smoothed);
+
+    for (int k = 0; k < int(smoothed.size()) - 1; ++k)
+    {
+        Belief::SecondMoment difference =
+            filtered_[k].covariance() - smoothed[k].covariance();
+
+        Eigen::SelfAdjointEigenSolver<Belief::SecondMoment> solver(difference);
+        EXPECT_GT(solver.eigenvalues().minCoeff(), -1e-10);
+        EXPECT_LT(smoothed[k].covariance().trace(),
+                  filtered_[k].covariance().trace());
+    }
+}
+
+TEST_F(GaussianSmootherTests, smooth_in_place)
+{
+    Smoother smoother(transition_);
+
+    std::vector<Belief> smoothed;
+    smoother.smooth(filtered_, inputs_, smoothed);
+
+    std::vector<Belief> beliefs = filtered_;
+    smoother.smooth(beliefs, inputs_, beliefs);
+
+    for (int k = 0; k < int(beliefs.size()); ++k)
+    {
+        EXPECT_TRUE(beliefs[k].mean().isApprox(smoothed[k].mean()));
+        EXPECT_TRUE(beliefs[k].covariance().isApprox(
+                        smoothed[k].covariance()));
+    }
+}
+
+TEST_F(GaussianSmootherTests, unscented_smoother_matches_linear_smoother)
+{
+    Smoother smoother(transition_);
+    UnscentedSmoother unscented_smoother(transition_,
+                                         fl::UnscentedQuadrature());
+
+    std::vector<Belief> smoothed;
+    std::vector<Belief> unscented_smoothed;
+    smoother.smooth(filtered_, inputs_, smoothed);
+    unscented_smoother.smooth(filtered_, inputs_, unscented_smoothed);
+
+    for (int k = 0; k < int(smoothed.size()); ++k)
+    {
+        EXPECT_TRUE(fl::are_similar(unscented_smoothed[k].mean(),
+                                    smoothed[k].mean()));
+        EXPECT_TRUE(fl::are_similar(unscented_smoothed[k].covariance(),
+                                    smoothed[k].covariance()));
+    }
+}
+
+TEST_F(GaussianSmootherTests, fixed_lag_smoother_matches_window_smoothing)
+{
+    const int lag = 3;
+
+    fl::FixedLagSmoother<Smoother> fixed_lag_smoother(Smoother(transition_),
+                                                      lag);
+    Smoother smoother(transition_);
+
+    Belief smoothed_belief;
+    int emitted = 0;
+
+    for (int t = 0; t < int(filtered_.size()); ++t)
+    {
+        const State& u = t > 0 ? inputs_[t - 1] : inputs_[0];
+
+        if (!fixed_lag_smoother.push(filtered_[t], u, smoothed_belief))
+        {
+            EXPECT_LT(t, lag);
+            continue;
+        }
+
+        // smooth the window t - lag, ..., t explicitly
+        std::vector<Belief> window(filtered_.begin() + t - lag,
+                                   filtered_.begin() + t + 1);
+        std::vector<State> window_inputs(inputs_.begin() + t - lag,
+                                         inputs_.begin() + t);
+        std::vector<Belief> smoothed_window;
+        smoother.smooth(window, window_inputs, smoothed_window);
+
+        EXPECT_TRUE(smoothed_belief.mean().isApprox(
+                        smoothed_window.front().mean()));
+        EXPECT_TRUE(smoothed_belief.covariance().isApprox(
+                        smoothed_window.front().covariance()));
+        ++emitted;
+    }
+
+    EXPECT_EQ(emitted, int(filtered_.size()) - lag);
+
+    std::vector<Belief> remaining;
+    fixed_lag_smoother.flush(remaining);
+    EXPECT_EQ(int(remaining.size()), lag);
+}
+
+TEST_F(GaussianSmootherTests, fixed_lag_smoother_with_zero_lag_is_filter)
+{
+    fl::FixedLagSmoother<Smoother> fixed_lag_smoother(Smoother(transition_),
+                                                      0);
+
+    Belief smoothed_belief;
+    for (int t = 0; t < int(filtered_.size()); ++t)
+    {
+        const State& u = t > 0 ? inputs_[t - 1] : inputs_[0];
+
+        ASSERT_TRUE(fixed_lag_smoother.push(filtered_[t], u, smoothed_belief));
+        EXPECT_TRUE(smoothed_belief.mean().isApprox(filtered_[t].mean()));
+        EXPECT_TRUE(smoothed_belief.covariance().isApprox(
+                        filtered_[t].covariance()));
+    }
+
+    std::vector<Belief> remaining;
+    fixed_lag_smoother.flush(remaining);
+    EXPECT_TRUE(remaining.empty());
+}
+
+TEST_F(GaussianSmootherTests, fixed_lag_smoother_with_full_lag_is_rts)
+{
+    const int steps = filtered_.size();
+
+    fl::FixedLagSmoother<Smoother> fixed_lag_smoother(Smoother(transition_),
+                                                      steps);
+
+    Belief smoothed_belief;
+    for (int t = 0; t < steps; ++t)
+    {
+        const State& u = t > 0 ? inputs_[t - 1] : inputs_[0];
+        EXPECT_FALSE(fixed_lag_smoother.push(filtered_[t], u, smoothed_belief));
+    }
+
+    std::vector<Belief> flushed;
+    fixed_lag_smoother.flush(flushed);
+
+    std::vector<Belief> smoothed;
+    Smoother(transition_).smooth(filtered_, inputs_, smoothed);
+
+    ASSERT_EQ(flushed.size(), smoothed.size());
+    for (int k = 0; k < steps; ++k)
+    {
+        EXPECT_TRUE(flushed[k].mean().isApprox(smoothed[k].mean()));
+        EXPECT_TRUE(flushed[k].covariance().isApprox(smoothed[k].covariance()));
+    }
+}
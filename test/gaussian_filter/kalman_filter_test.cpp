@@ -22,9 +22,14 @@
 
 #include <Eigen/Dense>
 
+#include <limits>
+
 #include "gaussian_filter_test_suite.hpp"
 
 #include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/filter/gaussian/gaussian_filter_nonlinear.hpp>
+#include <fl/filter/gaussian/quadrature/unscented_quadrature.hpp>
+#include <fl/model/sensor/linear_decorrelated_gaussian_sensor.hpp>
 
 template <
     int StateDimension,
@@ -74,3 +79,525 @@ typedef ::testing::Types<
 INSTANTIATE_TYPED_TEST_CASE_P(KalmanFilterTest,
                               GaussianFilterTest,
                               TestTypes);
+
+TEST(KalmanFilterInformationForm, matches_covariance_form)
+{
+    typedef Eigen::Matrix<fl::Real, 4, 1> State;
+    typedef Eigen::Matrix<fl::Real, Eigen::Dynamic, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+    const int obsrv_dim = 200;
+
+    Transition transition;
+    transition.noise_matrix(0.1 * Transition::NoiseMatrix::Identity());
+
+    Sensor sensor(obsrv_dim);
+    sensor.sensor_matrix(Sensor::SensorMatrix::Random(obsrv_dim, 4));
+    Sensor::NoiseMatrix noise = Sensor::NoiseMatrix::Random(obsrv_dim,
+                                                            obsrv_dim);
+    sensor.noise_covariance(noise * noise.transpose()
+                            + Sensor::NoiseMatrix::Identity(obsrv_dim,
+                                                            obsrv_dim));
+
+    Filter filter(transition, sensor);
+
+    EXPECT_TRUE(Filter::information_form_preferred(obsrv_dim, 4));
+    EXPECT_FALSE(Filter::information_form_preferred(4, 4));
+
+    auto covariance_belief = filter.create_belief();
+    auto information_belief = filter.create_belief();
+    auto belief = filter.create_belief();
+
+    for (int t = 0; t < 10; ++t)
+    {
+        const Obsrv y = Obsrv::Random(obsrv_dim);
+
+        filter.predict(covariance_belief, State::Zero(), covariance_belief);
+        filter.predict(information_belief, State::Zero(), information_belief);
+        filter.predict(belief, State::Zero(), belief);
+
+        filter.covariance_form_update(
+            covariance_belief, y, covariance_belief);
+        filter.information_form_update(
+            information_belief, y, information_belief);
+        filter.update(belief, y, belief);
+
+        EXPECT_TRUE(information_belief.mean().isApprox(
+                        covariance_belief.mean(), 1e-8));
+        EXPECT_TRUE(information_belief.covariance().isApprox(
+                        covariance_belief.covariance(), 1e-8));
+        EXPECT_TRUE(belief.mean().isApprox(information_belief.mean()));
+    }
+}
+
+TEST(KalmanFilterInformationForm, singular_predicted_covariance)
+{
+    typedef Eigen::Matrix<fl::Real, 2, 1> State;
+    typedef Eigen::Matrix<fl::Real, 3, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+    Transition transition;
+    Sensor sensor;
+    Filter filter(transition, sensor);
+
+    // the second state has zero variance, its precision does not exist
+    auto belief = filter.create_belief();
+    belief.mean(State(0.0, 0.5));
+    belief.covariance(State(1.0, 0.0).asDiagonal());
+
+    filter.update(belief, Obsrv(1.0, 1.0, 0.0), belief);
+
+    EXPECT_TRUE(belief.mean().isApprox(State(0.5, 0.5)));
+    EXPECT_TRUE(belief.covariance().isApprox(
+                    Eigen::Matrix<fl::Real, 2, 2>(State(0.5, 0.0).asDiagonal())));
+}
+
+TEST(KalmanFilterSequentialUpdate, matches_covariance_form)
+{
+    typedef Eigen::Matrix<fl::Real, 4, 1> State;
+    typedef Eigen::Matrix<fl::Real, Eigen::Dynamic, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearDecorrelatedGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::LinearGaussianSensor<Obsrv, State> DenseSensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+    typedef fl::GaussianFilter<Transition, DenseSensor> DenseFilter;
+
+    const int obsrv_dim = 50;
+
+    Transition transition;
+    transition.noise_matrix(0.1 * Transition::NoiseMatrix::Identity());
+
+    Sensor sensor(obsrv_dim);
+    DenseSensor dense_sensor(obsrv_dim);
+
+    const Sensor::SensorMatrix H = Sensor::SensorMatrix::Random(obsrv_dim, 4);
+    const Obsrv r = Obsrv::Random(obsrv_dim).array().abs() + 0.1;
+    sensor.sensor_matrix(H);
+    sensor.noise_covariance(r.asDiagonal());
+    dense_sensor.sensor_matrix(H);
+    dense_sensor.noise_covariance(r.asDiagonal());
+
+    Filter filter(transition, sensor);
+    DenseFilter dense_filter(transition, dense_sensor);
+
+    auto belief = filter.create_belief();
+    auto dense_belief = dense_filter.create_belief();
+
+    for (int t = 0; t < 20; ++t)
+    {
+        const Obsrv y = Obsrv::Random(obsrv_dim);
+
+        filter.predict(belief, State::Zero(), belief);
+        filter.update(belief, y, belief);
+
+        dense_filter.predict(dense_belief, State::Zero(), dense_belief);
+        dense_filter.covariance_form_update(dense_belief, y, dense_belief);
+
+        EXPECT_TRUE(belief.mean().isApprox(dense_belief.mean(), 1e-8));
+        EXPECT_TRUE(belief.covariance().isApprox(
+                        dense_belief.covariance(), 1e-8));
+    }
+}
+
+TEST(KalmanFilterSequentialUpdate, skips_missing_measurements)
+{
+    typedef Eigen::Matrix<fl::Real, 3, 1> State;
+    typedef Eigen::Matrix<fl::Real, Eigen::Dynamic, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearDecorrelatedGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+    const fl::Real nan = std::numeric_limits<fl::Real>::quiet_NaN();
+
+    Transition transition;
+
+    Sensor sensor(6);
+    const Sensor::SensorMatrix H = Sensor::SensorMatrix::Random(6, 3);
+    const Obsrv r = Obsrv::Random(6).array().abs() + 0.1;
+    sensor.sensor_matrix(H);
+    sensor.noise_covariance(r.asDiagonal());
+
+    // the same sensor without the rows 1 and 4
+    const int rows[] = { 0, 2, 3, 5 };
+    Sensor reduced_sensor(4);
+    Sensor::SensorMatrix reduced_H(4, 3);
+    Obsrv reduced_r(4);
+    for (int i = 0; i < 4; ++i)
+    {
+        reduced_H.row(i) = H.row(rows[i]);
+        reduced_r(i) = r(rows[i]);
+    }
+    reduced_sensor.sensor_matrix(reduced_H);
+    reduced_sensor.noise_covariance(reduced_r.asDiagonal());
+
+    Filter filter(transition, sensor);
+    Filter reduced_filter(transition, reduced_sensor);
+
+    Obsrv y = Obsrv::Random(6);
+    Obsrv reduced_y(4);
+    for (int i = 0; i < 4; ++i) reduced_y(i) = y(rows[i]);
+    y(1) = nan;
+    y(4) = nan;
+
+    auto belief = filter.create_belief();
+    auto reduced_belief = reduced_filter.create_belief();
+
+    filter.update(belief, y, belief);
+    reduced_filter.update(reduced_belief, reduced_y, reduced_belief);
+
+    EXPECT_TRUE(belief.mean().allFinite());
+    EXPECT_TRUE(belief.mean().isApprox(reduced_belief.mean()));
+    EXPECT_TRUE(belief.covariance().isApprox(reduced_belief.covariance()));
+}
+
+class KalmanFilterSteadyStateTests
+    : public ::testing::Test
+{
+protected:
+    typedef Eigen::Matrix<fl::Real, 4, 1> State;
+    typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+    KalmanFilterSteadyStateTests()
+    {
+        Transition::DynamicsMatrix A = Transition::DynamicsMatrix::Identity();
+        A(0, 2) = 0.1;
+        A(1, 3) = 0.1;
+        transition_.dynamics_matrix(A);
+        transition_.noise_matrix(0.1 * Transition::NoiseMatrix::Identity());
+
+        Sensor::SensorMatrix H = Sensor::SensorMatrix::Zero();
+        H(0, 0) = 1;
+        H(1, 1) = 1;
+        sensor_.sensor_matrix(H);
+        sensor_.noise_covariance(0.5 * Sensor::NoiseMatrix::Identity());
+    }
+
+    Transition transition_;
+    Sensor sensor_;
+};
+
+TEST_F(KalmanFilterSteadyStateTests, matches_converged_filter)
+{
+    Filter filter(transition_, sensor_);
+    Filter steady_filter(transition_, sensor_);
+    steady_filter.enable_steady_state();
+    EXPECT_TRUE(steady_filter.steady_state_enabled());
+
+    auto belief = filter.create_belief();
+    for (int t = 0; t < 1000; ++t)
+    {
+        filter.predict(belief, State::Zero(), belief);
+        filter.update(belief, Obsrv::Zero(), belief);
+    }
+
+    EXPECT_TRUE(steady_filter.steady_state_covariance().isApprox(
+                    belief.covariance(), 1e-8));
+
+    auto steady_belief = belief;
+    for (int t = 0; t < 20; ++t)
+    {
+        const Obsrv y = Obsrv::Random();
+
+        filter.predict(belief, State::Ones(), belief);
+        filter.update(belief, y, belief);
+
+        steady_filter.predict(steady_belief, State::Ones(), steady_belief);
+        steady_filter.update(steady_belief, y, steady_belief);
+
+        EXPECT_TRUE(steady_belief.mean().isApprox(belief.mean(), 1e-8));
+        EXPECT_TRUE(steady_belief.covariance().isApprox(
+                        belief.covariance(), 1e-8));
+    }
+}
+
+TEST_F(KalmanFilterSteadyStateTests, model_changes_invalidate_cache)
+{
+    Filter steady_filter(transition_, sensor_);
+    steady_filter.enable_steady_state();
+
+    const Filter::GainMatrix gain = steady_filter.steady_state_gain();
+
+    steady_filter.sensor().noise_covariance(
+        0.01 * Sensor::NoiseMatrix::Identity());
+    sensor_.noise_covariance(0.01 * Sensor::NoiseMatrix::Identity());
+
+    Filter reference(transition_, sensor_);
+    reference.enable_steady_state();
+
+    EXPECT_FALSE(steady_filter.steady_state_gain().isApprox(gain));
+    EXPECT_TRUE(steady_filter.steady_state_gain().isApprox(
+                    reference.steady_state_gain()));
+
+    Transition::DynamicsMatrix A = Transition::DynamicsMatrix::Identity();
+    A(0, 2) = 0.2;
+    A(1, 3) = 0.2;
+    steady_filter.transition().dynamics_matrix(A);
+    transition_.dynamics_matrix(A);
+
+    Filter other_reference(transition_, sensor_);
+    other_reference.enable_steady_state();
+
+    EXPECT_TRUE(steady_filter.steady_state_covariance().isApprox(
+                    other_reference.steady_state_covariance()));
+    EXPECT_FALSE(steady_filter.steady_state_covariance().isApprox(
+                     reference.steady_state_covariance()));
+}
+
+TEST_F(KalmanFilterSteadyStateTests, unobservable_system_throws)
+{
+    // an unstable system without observations has no steady state
+    transition_.dynamics_matrix(2 * Transition::DynamicsMatrix::Identity());
+    sensor_.sensor_matrix(Sensor::SensorMatrix::Zero());
+
+    Filter steady_filter(transition_, sensor_);
+    steady_filter.enable_steady_state(1e-12, 1000);
+
+    auto belief = steady_filter.create_belief();
+    EXPECT_THROW(steady_filter.predict(belief, State::Zero(), belief),
+                 fl::Exception);
+}
+
+TEST(KalmanFilterBlockStructure, matches_dense_computation)
+{
+    typedef Eigen::Matrix<fl::Real, 8, 1> State;
+    typedef Eigen::Matrix<fl::Real, 3, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+    // two independent constant velocity targets and a static part
+    Transition::DynamicsMatrix A = Transition::DynamicsMatrix::Identity();
+    A(0, 1) = 0.1;
+    A(2, 3) = 0.1;
+    A.block(4, 4, 2, 2) = Eigen::Matrix<fl::Real, 2, 2>::Random();
+
+    Transition transition;
+    transition.dynamics_matrix(A);
+    transition.noise_matrix(0.1 * Transition::NoiseMatrix::Random());
+    EXPECT_FALSE(transition.dynamics_blocks().dense());
+
+    // only positions are observed
+    Sensor::SensorMatrix H = Sensor::SensorMatrix::Zero();
+    H(0, 0) = 1;
+    H(1, 2) = 1;
+    H.col(4).setRandom();
+    Sensor sensor;
+    sensor.sensor_matrix(H);
+    sensor.noise_covariance(0.3 * Sensor::NoiseMatrix::Identity());
+    EXPECT_EQ(sensor.sensor_column_blocks().count(), 3);
+
+    Filter filter(transition, sensor);
+
+    auto belief = filter.create_belief();
+    Filter::Belief::SecondMoment P = Filter::Belief::SecondMoment::Random();
+    belief.covariance(P * P.transpose());
+    auto dense = belief;
+
+    const auto Q = transition.noise_covariance();
+    const auto R = sensor.noise_covariance();
+
+    for (int t = 0; t < 10; ++t)
+    {
+        const Obsrv y = Obsrv::Random();
+
+        filter.predict(belief, State::Ones(), belief);
+        filter.update(belief, y, belief);
+
+        dense.mean(A * dense.mean() + State::Ones());
+        dense.covariance(A * dense.covariance() * A.transpose() + Q);
+
+        const auto S = (H * dense.covariance() * H.transpose() + R).eval();
+        const auto K = (dense.covariance() * H.transpose() * S.inverse()).eval();
+        dense.mean(dense.mean() + K * (y - H * dense.mean()));
+        dense.covariance(dense.covariance() - K * H * dense.covariance());
+
+        EXPECT_TRUE(belief.mean().isApprox(dense.mean(), 1e-9));
+        EXPECT_TRUE(belief.covariance().isApprox(dense.covariance(), 1e-9));
+    }
+}
+
+TEST(KalmanFilterBatchUpdate, matches_sequential_updates)
+{
+    typedef Eigen::Matrix<fl::Real, 4, 1> State;
+    typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+    Transition transition;
+    transition.noise_matrix(0.1 * Transition::NoiseMatrix::Identity());
+
+    Sensor sensor;
+    sensor.sensor_matrix(Sensor::SensorMatrix::Random());
+    Sensor::NoiseMatrix N = Sensor::NoiseMatrix::Random();
+    sensor.noise_covariance(N * N.transpose()
+                            + 0.1 * Sensor::NoiseMatrix::Identity());
+
+    Filter filter(transition, sensor);
+
+    auto belief = filter.create_belief();
+    auto sequential_belief = belief;
+
+    for (int t = 0; t < 20; ++t)
+    {
+        Filter::Obsrvs obsrvs(1 + t % 4);
+        for (auto& y : obsrvs) y = Obsrv::Random();
+
+        filter.predict(belief, State::Zero(), belief);
+        filter.batch_update(belief, obsrvs, belief);
+
+        filter.predict(sequential_belief, State::Zero(), sequential_belief);
+        for (const auto& y : obsrvs)
+        {
+            filter.update(sequential_belief, y, sequential_belief);
+        }
+
+        EXPECT_TRUE(belief.mean().isApprox(sequential_belief.mean(), 1e-9));
+        EXPECT_TRUE(belief.covariance().isApprox(
+                        sequential_belief.covariance(), 1e-9));
+    }
+}
+
+TEST(KalmanFilterBatchUpdate, invalid_measurements_are_updated_sequentially)
+{
+    typedef Eigen::Matrix<fl::Real, 3, 1> State;
+    typedef Eigen::Matrix<fl::Real, Eigen::Dynamic, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearDecorrelatedGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+    Transition transition;
+    Sensor sensor(3);
+    sensor.sensor_matrix(Sensor::SensorMatrix::Identity(3, 3));
+
+    Filter filter(transition, sensor);
+
+    Filter::Obsrvs obsrvs(2, Obsrv::Ones(3));
+    obsrvs[1](1) = std::numeric_limits<fl::Real>::quiet_NaN();
+
+    auto belief = filter.create_belief();
+    filter.batch_update(belief, obsrvs, belief);
+
+    auto sequential_belief = filter.create_belief();
+    filter.update(sequential_belief, obsrvs[0], sequential_belief);
+    filter.update(sequential_belief, obsrvs[1], sequential_belief);
+
+    EXPECT_TRUE(belief.mean().allFinite());
+    EXPECT_TRUE(belief.mean().isApprox(sequential_belief.mean()));
+    EXPECT_TRUE(belief.covariance().isApprox(sequential_belief.covariance()));
+}
+
+TEST(KalmanFilterBatchUpdate, empty_batch_keeps_belief)
+{
+    typedef Eigen::Matrix<fl::Real, 2, 1> State;
+    typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+
+    Filter filter((Transition()), (Sensor()));
+
+    auto prior = filter.create_belief();
+    prior.mean(State::Ones());
+
+    auto posterior = filter.create_belief();
+    filter.batch_update(prior, Filter::Obsrvs(), posterior);
+
+    EXPECT_TRUE(posterior.mean().isApprox(prior.mean()));
+    EXPECT_TRUE(posterior.covariance().isApprox(prior.covariance()));
+}
+
+TEST(KalmanFilterBatchUpdate, sigma_point_filter_fuses_observations)
+{
+    typedef Eigen::Matrix<fl::Real, 4, 1> State;
+    typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+    typedef fl::LinearDecorrelatedGaussianSensor<Obsrv, State> DecorrelatedSensor;
+    typedef fl::GaussianFilter<Transition, Sensor> Filter;
+    typedef fl::GaussianFilter<Transition, Sensor, fl::UnscentedQuadrature>
+        SigmaPointFilter;
+    typedef fl::GaussianFilter<
+                Transition, DecorrelatedSensor, fl::UnscentedQuadrature
+            > DecorrelatedSigmaPointFilter;
+
+    Transition transition;
+    transition.noise_matrix(0.1 * Transition::NoiseMatrix::Identity());
+
+    Sensor::SensorMatrix H = Sensor::SensorMatrix::Random();
+    Sensor sensor;
+    sensor.sensor_matrix(H);
+    sensor.noise_covariance(0.2 * Sensor::NoiseMatrix::Identity());
+    DecorrelatedSensor decorrelated_sensor;
+    decorrelated_sensor.sensor_matrix(H);
+
+    Filter filter(transition, sensor);
+    SigmaPointFilter sigma_point_filter(
+        transition, sensor, fl::UnscentedQuadrature());
+    DecorrelatedSigmaPointFilter decorrelated_filter(
+        transition, decorrelated_sensor, fl::UnscentedQuadrature());
+
+    auto belief = filter.create_belief();
+    auto sigma_point_belief = sigma_point_filter.create_belief();
+    auto decorrelated_belief = decorrelated_filter.create_belief();
+
+    for (int t = 0; t < 10; ++t)
+    {
+        Filter::Obsrvs obsrvs(3);
+        for (auto& y : obsrvs) y = Obsrv::Random();
+
+        filter.predict(belief, State::Zero(), belief);
+        filter.batch_update(belief, obsrvs, belief);
+
+        sigma_point_filter.predict(
+            sigma_point_belief, State::Zero(), sigma_point_belief);
+        sigma_point_filter.batch_update(
+            sigma_point_belief, obsrvs, sigma_point_belief);
+
+        EXPECT_TRUE(fl::are_similar(sigma_point_belief.mean(),
+                                    belief.mean()));
+        EXPECT_TRUE(fl::are_similar(sigma_point_belief.covariance(),
+                                    belief.covariance()));
+    }
+
+    // identity noise covariance of the decorrelated sensor
+    sensor.noise_covariance(Sensor::NoiseMatrix::Identity());
+    Filter identity_filter(transition, sensor);
+    belief = identity_filter.create_belief();
+
+    for (int t = 0; t < 10; ++t)
+    {
+        Filter::Obsrvs obsrvs(2);
+        for (auto& y : obsrvs) y = Obsrv::Random();
+
+        identity_filter.predict(belief, State::Zero(), belief);
+        identity_filter.batch_update(belief, obsrvs, belief);
+
+        decorrelated_filter.predict(
+            decorrelated_belief, State::Zero(), decorrelated_belief);
+        decorrelated_filter.batch_update(
+            decorrelated_belief, obsrvs, decorrelated_belief);
+
+        EXPECT_TRUE(fl::are_similar(decorrelated_belief.mean(),
+                                    belief.mean()));
+        EXPECT_TRUE(fl::are_similar(decorrelated_belief.covariance(),
+                                    belief.covariance()));
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <Eigen/Dense>
+
+#include <fl/filter/gaussian/square_root_gaussian_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+typedef Eigen::Matrix<fl::Real, 4, 1> State;
+typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+
+typedef fl::SquareRootGaussianFilter<Transition, Sensor> SquareRootFilter;
+typedef fl::GaussianFilter<Transition, Sensor> GaussianFilter;
+
+typedef SquareRootFilter::Belief Belief;
+
+class SquareRootGaussianFilterTests
+    : public ::testing::Test
+{
+protected:
+    SquareRootGaussianFilterTests()
+    {
+        // constant velocity model of two coordinates
+        Transition::DynamicsMatrix A = Transition::DynamicsMatrix::Identity();
+        A(0, 2) = 0.1;
+        A(1, 3) = 0.1;
+        transition_.dynamics_matrix(A);
+        transition_.noise_matrix(0.1 * Transition::NoiseMatrix::Random());
+
+        Sensor::SensorMatrix H = Sensor::SensorMatrix::Zero();
+        H(0, 0) = 1;
+        H(1, 1) = 1;
+        sensor_.sensor_matrix(H);
+        sensor_.noise_covariance(0.2 * Sensor::NoiseMatrix::Identity());
+    }
+
+    Obsrv observation(int t) const
+    {
+        return Obsrv(std::sin(0.1 * t), 0.05 * t);
+    }
+
+    static bool is_lower_triangular(const Belief::SecondMoment& L)
+    {
+        return L.isApprox(L.triangularView<Eigen::Lower>().toDenseMatrix())
+               && (L.diagonal().array() >= 0).all();
+    }
+
+protected:
+    Transition transition_;
+    Sensor sensor_;
+};
+
+TEST_F(SquareRootGaussianFilterTests, matches_kalman_filter)
+{
+    SquareRootFilter square_root_filter(transition_, sensor_);
+    GaussianFilter gaussian_filter(transition_, sensor_);
+
+    Belief belief = square_root_filter.create_belief();
+    Belief gaussian = gaussian_filter.create_belief();
+
+    const State u = State::Zero();
+
+    for (int t = 0; t < 100; ++t)
+    {
+        square_root_filter.predict(belief, u, belief);
+        gaussian_filter.predict(gaussian, u, gaussian);
+
+        EXPECT_TRUE(belief.mean().isApprox(gaussian.mean(), 1e-9));
+        EXPECT_TRUE(belief.covariance().isApprox(gaussian.covariance(), 1e-9));
+        EXPECT_TRUE(is_lower_triangular(belief.square_root()));
+
+        square_root_filter.update(belief, observation(t), belief);
+        gaussian_filter.update(gaussian, observation(t), gaussian);
+
+        EXPECT_TRUE(belief.mean().isApprox(gaussian.mean(), 1e-9));
+        EXPECT_TRUE(belief.covariance().isApprox(gaussian.covariance(), 1e-9));
+        EXPECT_TRUE(is_lower_triangular(belief.square_root()));
+    }
+}
+
+TEST_F(SquareRootGaussianFilterTests, factor_is_propagated)
+{
+    SquareRootFilter filter(transition_, sensor_);
+
+    Belief belief = filter.create_belief();
+    filter.predict(belief, State::Zero(), belief);
+    filter.update(belief, observation(0), belief);
+
+    // the stored factor is returned as is, not recomputed from the covariance
+    const Belief::SecondMoment L = belief.square_root();
+    EXPECT_TRUE(belief.covariance().isApprox(L * L.transpose()));
+    EXPECT_TRUE(belief.square_root().isApprox(L));
+}
+
+TEST_F(SquareRootGaussianFilterTests, remains_positive_definite)
+{
+    // a nearly noise free, poorly observed system over many steps
+    transition_.noise_matrix(1e-6 * Transition::NoiseMatrix::Identity());
+    sensor_.noise_covariance(1e-10 * Sensor::NoiseMatrix::Identity());
+
+    SquareRootFilter filter(transition_, sensor_);
+
+    Belief belief = filter.create_belief();
+    belief.covariance(1e4 * Belief::SecondMoment::Identity());
+
+    for (int t = 0; t < 1000; ++t)
+    {
+        filter.predict(belief, State::Zero(), belief);
+        filter.update(belief, observation(t), belief);
+    }
+
+    const Belief::SecondMoment& covariance = belief.covariance();
+    EXPECT_TRUE(covariance.isApprox(covariance.transpose()));
+    EXPECT_TRUE(is_lower_triangular(belief.square_root()));
+    EXPECT_EQ(covariance.llt().info(), Eigen::Success);
+    EXPECT_TRUE((belief.square_root().diagonal().array() > 0).all());
+}
@@ -164,6 +164,25 @@ public:
                          body_tail_log_prob);
     }
 
+    void batch_log_probabilities()
+    {
+        auto y = Obsrv::Random(ObsrvDim).eval();
+
+        typename BodyTailModel::StateMatrix states(StateDim, 50);
+        states.setRandom();
+
+        auto log_probs = body_tail_model.log_probabilities(y, states);
+
+        ASSERT_EQ(log_probs.size(), states.cols());
+        for (int i = 0; i < states.cols(); ++i)
+        {
+            State x = states.col(i);
+            EXPECT_NEAR(log_probs(i),
+                        body_tail_model.log_probability(y, x),
+                        1e-9);
+        }
+    }
+
 protected:
     BodyModel body_model;
     TailModel tail_model;
@@ -259,3 +278,8 @@ TYPED_TEST(BodyTailSensorTest, correct_threshlold)
                      TestFixture::create_tail_model(),
                      fl::Real(0.000000001)));
 }
+
+TYPED_TEST(BodyTailSensorTest, batch_log_probabilities)
+{
+    TestFixture::batch_log_probabilities();
+}
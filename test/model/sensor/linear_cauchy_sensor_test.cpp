@@ -0,0 +1,108 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file linear_cauchy_sensor_test.cpp
+ * \date 2015
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+#include "../../typecast.hpp"
+
+#include <Eigen/Dense>
+
+#include <fl/util/types.hpp>
+#include <fl/model/sensor/linear_cauchy_sensor.hpp>
+
+template <typename TestType>
+class LinearCauchySensorTest
+    : public testing::Test
+{
+public:
+    enum: signed int
+    {
+        StateDim = TestType::Parameter::StateDim,
+        ObsrvDim = TestType::Parameter::ObsrvDim,
+
+        StateSize = fl::TestSize<StateDim, TestType>::Value,
+        ObsrvSize = fl::TestSize<ObsrvDim, TestType>::Value
+    };
+
+    typedef Eigen::Matrix<fl::Real, StateSize, 1> State;
+    typedef Eigen::Matrix<fl::Real, ObsrvSize, 1> Obsrv;
+    typedef fl::LinearCauchySensor<Obsrv, State> LinearModel;
+
+    LinearCauchySensorTest()
+        : model(ObsrvDim, StateDim)
+    { }
+
+    void batch_log_probabilities_test()
+    {
+        auto H = model.create_sensor_matrix();
+        H.setRandom();
+        model.sensor_matrix(H);
+
+        typename LinearModel::NoiseMatrix A =
+            LinearModel::NoiseMatrix::Random(ObsrvDim, ObsrvDim);
+        model.noise_covariance(
+            A * A.transpose()
+            + LinearModel::NoiseMatrix::Identity(ObsrvDim, ObsrvDim));
+
+        auto y = Obsrv(model.obsrv_dimension());
+        y.setRandom();
+
+        typename LinearModel::StateMatrix states(model.state_dimension(), 50);
+        states.setRandom();
+
+        auto log_probs = model.log_probabilities(y, states);
+
+        ASSERT_EQ(log_probs.size(), states.cols());
+        for (int i = 0; i < states.cols(); ++i)
+        {
+            State x = states.col(i);
+            EXPECT_NEAR(log_probs(i), model.log_probability(y, x), 1e-9);
+        }
+    }
+
+protected:
+    LinearModel model;
+};
+
+template <int ObsrvDimension, int StateDimension>
+struct Dimensions
+{
+    enum: signed int
+    {
+        ObsrvDim = ObsrvDimension,
+        StateDim = StateDimension
+    };
+};
+
+typedef ::testing::Types<
+            fl::StaticTest<Dimensions<2, 1>>,
+            fl::StaticTest<Dimensions<2, 2>>,
+            fl::StaticTest<Dimensions<3, 3>>,
+            fl::StaticTest<Dimensions<10, 10>>,
+            fl::DynamicTest<Dimensions<2, 1>>,
+            fl::DynamicTest<Dimensions<2, 2>>,
+            fl::DynamicTest<Dimensions<3, 3>>,
+            fl::DynamicTest<Dimensions<10, 10>>
+        > TestTypes;
+
+TYPED_TEST_CASE(LinearCauchySensorTest, TestTypes);
+
+TYPED_TEST(LinearCauchySensorTest, batch_log_probabilities)
+{
+    TestFixture::batch_log_probabilities_test();
+}
@@ -219,6 +219,32 @@ public:
         EXPECT_TRUE(fl::are_similar(model.observation(x, v), y));
     }
 
+    void batch_log_probabilities_test()
+    {
+        auto H = model.create_sensor_matrix();
+        auto N = model.create_noise_diagonal_matrix();
+        H.setRandom();
+        N.diagonal().setRandom();
+        N.diagonal() = N.diagonal().cwiseAbs() + Obsrv::Ones(ObsrvDim);
+        model.sensor_matrix(H);
+        model.noise_matrix(N);
+
+        auto y = Obsrv(model.obsrv_dimension());
+        y.setRandom();
+
+        typename LinearModel::StateMatrix states(model.state_dimension(), 50);
+        states.setRandom();
+
+        auto log_probs = model.log_probabilities(y, states);
+
+        ASSERT_EQ(log_probs.size(), states.cols());
+        for (int i = 0; i < states.cols(); ++i)
+        {
+            State x = states.col(i);
+            EXPECT_NEAR(log_probs(i), model.log_probability(y, x), 1e-9);
+        }
+    }
+
 protected:
     LinearModel model;
 };
@@ -294,3 +320,8 @@ TYPED_TEST(LinearUncorrelatedGaussianSensorTest, observation)
 }
 
 /// \todo missing probability and log_probability tests
+
+TYPED_TEST(LinearUncorrelatedGaussianSensorTest, batch_log_probabilities)
+{
+    TestFixture::batch_log_probabilities_test();
+}
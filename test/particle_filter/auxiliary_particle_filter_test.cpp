@@ -0,0 +1,140 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include <fl/filter/particle/particle_filter.hpp>
+#include <fl/filter/particle/auxiliary_particle_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+typedef Eigen::Matrix<fl::Real, 2, 1> State;
+typedef Eigen::Matrix<fl::Real, 2, 2> Matrix;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearGaussianSensor<State, State> Sensor;
+
+typedef fl::GaussianFilter<Transition, Sensor> GaussianFilter;
+
+/**
+ * Slowly moving state observed by an accurate sensor. Starting from a
+ * diffuse prior, the observations are highly informative. The process noise
+ * is small compared to the sensor noise, hence the noise-free prediction is
+ * a good look-ahead.
+ */
+Transition create_transition()
+{
+    Transition transition;
+    transition.noise_matrix(0.05 * Matrix::Identity());
+    return transition;
+}
+
+Sensor create_informative_sensor()
+{
+    Sensor sensor;
+    sensor.noise_matrix(0.1 * Matrix::Identity());
+    return sensor;
+}
+
+/**
+ * Runs the particle filter alongside the exact Kalman filter.
+ *
+ * \return Largest deviation of the particle mean from the Kalman mean in
+ *         terms of the Mahalanobis distance
+ */
+template <typename Filter>
+fl::Real track(int particles, fl::Real& first_ess)
+{
+    Transition transition = create_transition();
+    Sensor sensor = create_informative_sensor();
+
+    Filter particle_filter(transition, sensor);
+    GaussianFilter gaussian_filter(transition, sensor);
+
+    auto gaussian_belief = gaussian_filter.create_belief();
+    typename Filter::Belief particle_belief;
+    particle_belief.from_distribution(gaussian_belief, particles);
+
+    fl::Real max_error = 0;
+    for(int i = 0; i < 10; i++)
+    {
+        State u = State::Zero();
+        State y = State::Constant(0.5 + 0.05 * i);
+
+        particle_filter.predict_and_update(particle_belief, u, y,
+                                           particle_belief);
+        gaussian_filter.predict(gaussian_belief, u, gaussian_belief);
+        gaussian_filter.update(gaussian_belief, y, gaussian_belief);
+
+        // the first observation is the most informative given the prior
+        if (i == 0) first_ess = particle_belief.effective_sample_size();
+
+        State delta = particle_belief.mean() - gaussian_belief.mean();
+        max_error = std::max(
+            max_error,
+            fl::Real(std::sqrt(delta.transpose()
+                               * gaussian_belief.precision() * delta)));
+    }
+
+    return max_error;
+}
+
+TEST(auxiliary_particle_filter, tracks_kalman_filter)
+{
+    typedef fl::AuxiliaryParticleFilter<Transition, Sensor> Filter;
+
+    fl::Real ess;
+    EXPECT_LT(track<Filter>(2000, ess), 0.4);
+}
+
+TEST(auxiliary_particle_filter, matrix_belief)
+{
+    typedef fl::AuxiliaryParticleFilter<
+                Transition,
+                Sensor,
+                fl::SystematicResampling,
+                fl::DiscreteMatrixDistribution<State>
+            > Filter;
+
+    fl::Real ess;
+    EXPECT_LT(track<Filter>(2000, ess), 0.4);
+}
+
+TEST(auxiliary_particle_filter, retains_more_effective_particles)
+{
+    typedef fl::ParticleFilter<
+                Transition, Sensor, fl::SystematicResampling
+            > BootstrapFilter;
+    typedef fl::AuxiliaryParticleFilter<Transition, Sensor> AuxiliaryFilter;
+
+    fl::Real bootstrap_ess;
+    fl::Real auxiliary_ess;
+    track<BootstrapFilter>(5000, bootstrap_ess);
+    track<AuxiliaryFilter>(5000, auxiliary_ess);
+
+    // the look-ahead places the particles where the observation is, the
+    // bootstrap filter retains more than an order of magnitude less
+    EXPECT_GT(auxiliary_ess, 10.0 * bootstrap_ess);
+}
@@ -0,0 +1,226 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include <fl/filter/particle/kld_sampling.hpp>
+#include <fl/filter/particle/particle_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+typedef Eigen::Matrix<fl::Real, 2, 1> State;
+typedef Eigen::Matrix<fl::Real, 2, 2> Matrix;
+
+typedef fl::DiscreteDistribution<State> Belief;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearGaussianSensor<State, State> Sensor;
+
+typedef fl::ParticleFilter<Transition, Sensor, fl::SystematicResampling>
+    ParticleFilter;
+typedef fl::GaussianFilter<Transition, Sensor> GaussianFilter;
+
+Belief gaussian_belief(fl::Real variance, int size)
+{
+    fl::Gaussian<State> gaussian;
+    gaussian.covariance(variance * Matrix::Identity());
+
+    Belief belief;
+    belief.from_distribution(gaussian, size);
+    return belief;
+}
+
+TEST(kld_sampling, required_particles)
+{
+    fl::KldSampling kld_sampling(0.1, 10, 100000, 0.05, 0.01);
+
+    EXPECT_EQ(kld_sampling.required_particles(1), 1);
+
+    // (k-1)/(2 eps) (1 - 2/(9(k-1)) + sqrt(2/(9(k-1))) z_{0.99})^3
+    EXPECT_NEAR(kld_sampling.required_particles(2), 66, 1);
+    EXPECT_NEAR(kld_sampling.required_particles(100), 1347, 2);
+
+    for (int k = 2; k < 1000; ++k)
+    {
+        EXPECT_LT(kld_sampling.required_particles(k),
+                  kld_sampling.required_particles(k + 1));
+    }
+}
+
+TEST(kld_sampling, invalid_parameters)
+{
+    EXPECT_THROW(fl::KldSampling(0.0, 10, 100), fl::Exception);
+    EXPECT_THROW(fl::KldSampling(0.1, 0, 100), fl::Exception);
+    EXPECT_THROW(fl::KldSampling(0.1, 100, 10), fl::Exception);
+    EXPECT_THROW(fl::KldSampling(0.1, 10, 100, 0.0), fl::Exception);
+    EXPECT_THROW(fl::KldSampling(0.1, 10, 100, 0.05, 1.0), fl::Exception);
+}
+
+TEST(kld_sampling, concentrated_belief_requires_min_particles)
+{
+    fl::KldSampling kld_sampling(0.1, 50, 10000);
+
+    Belief belief(1000);
+    for (int i = 0; i < belief.size(); ++i)
+    {
+        belief.location(i) = State::Constant(0.55);
+    }
+
+    EXPECT_EQ(kld_sampling(belief), 50);
+}
+
+TEST(kld_sampling, diffuse_belief_requires_max_particles)
+{
+    fl::KldSampling kld_sampling(0.1, 50, 10000);
+
+    EXPECT_EQ(kld_sampling(gaussian_belief(100.0, 1000)), 10000);
+}
+
+TEST(kld_sampling, count_grows_with_spread)
+{
+    fl::KldSampling kld_sampling(0.5, 10, 1000000);
+
+    const int narrow = kld_sampling(gaussian_belief(0.1, 5000));
+    const int wide = kld_sampling(gaussian_belief(1.0, 5000));
+    const int wider = kld_sampling(gaussian_belief(10.0, 5000));
+
+    EXPECT_GE(narrow, 10);
+    EXPECT_GT(wide, 2 * narrow);
+    EXPECT_GT(wider, 2 * wide);
+    EXPECT_LE(wider, 1000000);
+}
+
+TEST(kld_sampling, weights_are_respected)
+{
+    fl::KldSampling kld_sampling(0.1, 10, 100000);
+
+    // half of the locations are spread, but carry no weight
+    Belief belief = gaussian_belief(100.0, 1000);
+    Belief::Function log_weights(belief.size());
+    for (int i = 0; i < belief.size(); ++i)
+    {
+        if (i % 2)
+        {
+            belief.location(i) = State::Constant(0.55);
+            log_weights(i) = 0;
+        }
+        else
+        {
+            log_weights(i) = -1000;
+        }
+    }
+    belief.log_unnormalized_prob_mass(log_weights);
+
+    EXPECT_EQ(kld_sampling(belief), 10);
+}
+
+TEST(kld_sampling, gathers_drawn_particles)
+{
+    fl::KldSampling kld_sampling(0.1, 10, 100000);
+
+    // only the odd locations carry weight and are distinct
+    Belief belief = gaussian_belief(100.0, 1000);
+    Belief::Function log_weights(belief.size());
+    for (int i = 0; i < belief.size(); ++i)
+    {
+        log_weights(i) = (i % 2) ? 0 : -1000;
+    }
+    belief.log_unnormalized_prob_mass(log_weights);
+
+    const int size = kld_sampling(belief);
+
+    Belief resampled;
+    resampled.from_distribution(belief, size, kld_sampling);
+
+    ASSERT_EQ(resampled.size(), size);
+    for (int i = 0; i < resampled.size(); ++i)
+    {
+        bool drawn_from_odd = false;
+        for (int j = 1; j < belief.size(); j += 2)
+        {
+            drawn_from_odd |= (resampled.location(i) == belief.location(j));
+        }
+        EXPECT_TRUE(drawn_from_odd);
+    }
+}
+
+TEST(kld_sampling, particle_filter_adapts_particle_count)
+{
+    Transition transition;
+    transition.noise_matrix(0.05 * Matrix::Identity());
+
+    Sensor sensor;
+    sensor.noise_matrix(0.1 * Matrix::Identity());
+
+    // a negative threshold resamples, hence adapts, in every update
+    ParticleFilter particle_filter(transition, sensor, -1.0);
+    particle_filter.kld_sampling(fl::KldSampling(0.1, 100, 20000));
+    EXPECT_TRUE(particle_filter.kld_sampling_enabled());
+
+    GaussianFilter gaussian_filter(transition, sensor);
+
+    auto gaussian = gaussian_filter.create_belief();
+    gaussian.covariance(Matrix::Identity());
+
+    Belief belief;
+    belief.from_distribution(gaussian, 5000);
+
+    const State u = State::Zero();
+    const State y = State::Constant(0.5);
+
+    // the diffuse predicted belief occupies many cells
+    particle_filter.predict(belief, u, belief);
+    particle_filter.update(belief, y, belief);
+    const int initial_size = belief.size();
+    EXPECT_GT(initial_size, 5000);
+    EXPECT_LE(initial_size, 20000);
+
+    gaussian_filter.predict(gaussian, u, gaussian);
+    gaussian_filter.update(gaussian, y, gaussian);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        particle_filter.predict(belief, u, belief);
+        particle_filter.update(belief, y, belief);
+
+        gaussian_filter.predict(gaussian, u, gaussian);
+        gaussian_filter.update(gaussian, y, gaussian);
+    }
+
+    // the concentrated posterior requires far fewer particles
+    EXPECT_GE(belief.size(), 100);
+    EXPECT_LT(belief.size(), initial_size / 2);
+
+    State delta = belief.mean() - gaussian.mean();
+    EXPECT_LT(std::sqrt(delta.transpose() * gaussian.precision() * delta),
+              0.5);
+
+    particle_filter.disable_kld_sampling();
+    EXPECT_FALSE(particle_filter.kld_sampling_enabled());
+
+    const int size = belief.size();
+    particle_filter.predict(belief, u, belief);
+    particle_filter.update(belief, y, belief);
+    EXPECT_EQ(belief.size(), size);
+}
@@ -0,0 +1,227 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <new>
+#include <vector>
+#include <cassert>
+#include <cstdlib>
+
+/*
+ * Allocation counter. Eigen allocates through aligned_malloc instead of
+ * operator new. With EIGEN_RUNTIME_NO_MALLOC every Eigen heap allocation is
+ * checked via eigen_assert while Eigen::internal::set_is_malloc_allowed(false)
+ * is in effect. Here, such a violation is counted instead of aborting. All
+ * other Eigen assertions, and any assertion while allocations are allowed,
+ * remain regular assertions.
+ */
+static bool count_allocations = false;
+static long allocations = 0;
+
+static bool eigen_malloc_allowed();
+
+#define EIGEN_RUNTIME_NO_MALLOC
+#define eigen_assert(x)                                                        \
+    do                                                                         \
+    {                                                                          \
+        if (!(x))                                                              \
+        {                                                                      \
+            if (!eigen_malloc_allowed()) ++allocations;                        \
+            else assert(x);                                                    \
+        }                                                                      \
+    } while (false)
+
+#include <Eigen/Core>
+
+bool eigen_malloc_allowed()
+{
+    return Eigen::internal::is_malloc_allowed();
+}
+
+#include <fl/filter/particle/particle_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+/*
+ * Any other heap allocation passes through operator new
+ */
+void* operator new(std::size_t size)
+{
+    if (count_allocations) ++allocations;
+
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+/*
+ * All deallocations are released by this single function. It is kept out of
+ * line, otherwise GCC reports the free() of memory obtained by operator new
+ * once the replacement is inlined at a delete expression
+ * (-Wmismatched-new-delete).
+ */
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void start_counting()
+{
+    allocations = 0;
+    count_allocations = true;
+    Eigen::internal::set_is_malloc_allowed(false);
+}
+
+void stop_counting()
+{
+    Eigen::internal::set_is_malloc_allowed(true);
+    count_allocations = false;
+}
+
+typedef Eigen::Matrix<fl::Real, 3, 1> State;
+typedef Eigen::Matrix<fl::Real, 2, 1> Obsrv;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+
+template <typename ParticleFilter>
+long steady_state_allocations(fl::Real max_kl_divergence,
+                              bool kld_sampling = false)
+{
+    typedef typename ParticleFilter::Belief Belief;
+
+    Transition transition;
+    Sensor sensor;
+    ParticleFilter filter(transition, sensor, max_kl_divergence);
+
+    // with equal bounds the count remains constant
+    if (kld_sampling) filter.kld_sampling(fl::KldSampling(0.1, 1000, 1000));
+
+    fl::Gaussian<State> gaussian;
+    Belief belief;
+    belief.from_distribution(gaussian, 1000);
+
+    const State u = State::Zero();
+    const Obsrv y = Obsrv::Constant(0.5);
+
+    // warm-up, all buffers reach their final size
+    for (int i = 0; i < 3; ++i)
+    {
+        filter.predict(belief, u, belief);
+        filter.update(belief, y, belief);
+    }
+
+    start_counting();
+    for (int i = 0; i < 10; ++i)
+    {
+        filter.predict(belief, u, belief);
+        filter.update(belief, y, belief);
+    }
+    stop_counting();
+
+    return allocations;
+}
+
+TEST(particle_filter_allocation, discrete_distribution_resampling)
+{
+    typedef fl::ParticleFilter<
+                Transition, Sensor, fl::SystematicResampling
+            > ParticleFilter;
+
+    // a negative threshold resamples in every update
+    EXPECT_EQ(steady_state_allocations<ParticleFilter>(-1.0), 0);
+}
+
+TEST(particle_filter_allocation, discrete_distribution_no_resampling)
+{
+    typedef fl::ParticleFilter<
+                Transition, Sensor, fl::SystematicResampling
+            > ParticleFilter;
+
+    EXPECT_EQ(steady_state_allocations<ParticleFilter>(1e10), 0);
+}
+
+TEST(particle_filter_allocation, matrix_distribution_resampling)
+{
+    typedef fl::ParticleFilter<
+                Transition,
+                Sensor,
+                fl::SystematicResampling,
+                fl::DiscreteMatrixDistribution<State>
+            > ParticleFilter;
+
+    EXPECT_EQ(steady_state_allocations<ParticleFilter>(-1.0), 0);
+}
+
+TEST(particle_filter_allocation, residual_resampling)
+{
+    typedef fl::ParticleFilter<
+                Transition,
+                Sensor,
+                fl::ResidualResampling,
+                fl::DiscreteMatrixDistribution<State>
+            > ParticleFilter;
+
+    EXPECT_EQ(steady_state_allocations<ParticleFilter>(-1.0), 0);
+}
+
+TEST(particle_filter_allocation, kld_sampling)
+{
+    typedef fl::ParticleFilter<
+                Transition,
+                Sensor,
+                fl::SystematicResampling,
+                fl::DiscreteMatrixDistribution<State>
+            > ParticleFilter;
+
+    EXPECT_EQ(steady_state_allocations<ParticleFilter>(-1.0, true), 0);
+}
+
+TEST(particle_filter_allocation, counter_detects_allocations)
+{
+    start_counting();
+    Eigen::VectorXd v(100);
+    std::vector<int> w(100);
+    stop_counting();
+
+    EXPECT_EQ(allocations, 2);
+    EXPECT_EQ(v.size() + w.size(), 200);
+}
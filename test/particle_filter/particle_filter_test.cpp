@@ -289,3 +289,70 @@ TEST(particle_filter, predict_and_update)
     // make sure that the estimate of the pf is within one std dev
     EXPECT_TRUE(std::sqrt(mh_distance) <= 1.0);
 }
+
+TEST(particle_filter, predict_and_update_with_matrix_belief)
+{
+    typedef Eigen::Matrix<double, 3, 1> State;
+    typedef Eigen::Matrix<double, 3, 1> Observation;
+    typedef Eigen::Matrix<double, 3, 3> Matrix;
+
+    typedef fl::LinearTransition<State, State, State> ProcessModel;
+    typedef fl::LinearGaussianSensor<Observation, State> ObservationModel;
+
+    // particle filter storing the particles contiguously
+    typedef fl::ParticleFilter<
+                ProcessModel,
+                ObservationModel,
+                fl::SystematicResampling,
+                fl::DiscreteMatrixDistribution<State>
+            > ParticleFilter;
+    typedef ParticleFilter::Belief ParticleBelief;
+
+    // gaussian filter
+    typedef fl::GaussianFilter<ProcessModel, ObservationModel> GaussianFilter;
+    typedef GaussianFilter::Belief GaussianBelief;
+
+    srand(0);
+    size_t N_particles = 10000;
+    size_t N_steps = 10;
+
+    ProcessModel transition;
+    {
+        transition.dynamics_matrix(some_rotation());
+        Matrix R = some_rotation();
+        Matrix D = Eigen::DiagonalMatrix<double, 3>(1, 3.5, 1.2);
+        transition.noise_matrix(R*D*R.transpose());
+    }
+
+    ObservationModel sensor;
+    {
+        sensor.sensor_matrix(some_rotation());
+        Matrix R = some_rotation();
+        Matrix D = Eigen::DiagonalMatrix<double, 3>(3.1, 1.0, 1.3);
+        D = D.cwiseSqrt();
+        sensor.noise_matrix(R*D);
+    }
+
+    ParticleFilter particle_filter(transition, sensor);
+    GaussianFilter gaussian_filter(transition, sensor);
+
+    GaussianBelief gaussian_belief;
+    ParticleBelief particle_belief;
+    particle_belief.from_distribution(gaussian_belief, N_particles);
+
+    for(size_t i = 0; i < N_steps; i++)
+    {
+        Observation observation(0.5, 0.5, 0.5);
+
+        particle_filter.predict(particle_belief, State::Zero(), particle_belief);
+        gaussian_filter.predict(gaussian_belief, State::Zero(), gaussian_belief);
+
+        particle_filter.update(particle_belief, observation, particle_belief);
+        gaussian_filter.update(gaussian_belief, observation, gaussian_belief);
+
+        EXPECT_TRUE(moments_are_similar(
+                        particle_belief.mean(), particle_belief.covariance(),
+                        gaussian_belief.mean(), gaussian_belief.covariance(),
+                        0.2));
+    }
+}
@@ -0,0 +1,210 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Jan Issac (jan.issac@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include <fl/util/profiling.hpp>
+#include <fl/util/thread_pool.hpp>
+#include <fl/filter/particle/particle_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+typedef Eigen::Matrix<fl::Real, 3, 1> State;
+typedef Eigen::Matrix<fl::Real, 3, 3> Matrix;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearGaussianSensor<State, State> Sensor;
+
+typedef fl::ParticleFilter<
+            Transition,
+            Sensor,
+            fl::SystematicResampling,
+            fl::DiscreteMatrixDistribution<State>
+        > ParticleFilter;
+typedef ParticleFilter::Belief ParticleBelief;
+
+typedef fl::GaussianFilter<Transition, Sensor> GaussianFilter;
+typedef GaussianFilter::Belief GaussianBelief;
+
+TEST(thread_pool, chunks_cover_range_once)
+{
+    fl::ThreadPool pool(4);
+
+    std::vector<int> visits(1003, 0);
+    std::vector<int> chunk_of(1003, -1);
+
+    pool.parallel_for(
+        visits.size(),
+        [&](int chunk, int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                visits[i]++;
+                chunk_of[i] = chunk;
+            }
+        });
+
+    for (size_t i = 0; i < visits.size(); ++i)
+    {
+        EXPECT_EQ(visits[i], 1);
+    }
+
+    // chunking is deterministic and contiguous
+    EXPECT_TRUE(std::is_sorted(chunk_of.begin(), chunk_of.end()));
+    EXPECT_EQ(chunk_of.front(), 0);
+    EXPECT_EQ(chunk_of.back(), 3);
+}
+
+TEST(thread_pool, rethrows_exceptions)
+{
+    fl::ThreadPool pool(3);
+
+    EXPECT_THROW(
+        pool.parallel_for(
+            30,
+            [](int chunk, int begin, int end)
+            {
+                if (chunk == 2) throw std::runtime_error("chunk 2");
+            }),
+        std::runtime_error);
+
+    // the pool remains usable
+    std::vector<int> visits(3, 0);
+    pool.parallel_for(3, [&](int chunk, int begin, int end)
+                         { for (int i = begin; i < end; ++i) visits[i]++; });
+    EXPECT_EQ(visits, std::vector<int>(3, 1));
+}
+
+TEST(particle_filter_threads, parallel_weights_equal_serial_weights)
+{
+    Transition transition;
+    Sensor sensor;
+
+    // never resample to compare the weights only
+    ParticleFilter serial_filter(transition, sensor, 1e10);
+    ParticleFilter parallel_filter(transition, sensor, 1e10);
+    parallel_filter.threads(4);
+
+    GaussianBelief gaussian_belief;
+    ParticleBelief prior;
+    prior.from_distribution(gaussian_belief, 1001);
+
+    ParticleBelief serial_posterior;
+    ParticleBelief parallel_posterior;
+
+    State y = State::Constant(0.5);
+    serial_filter.update(prior, y, serial_posterior);
+    parallel_filter.update(prior, y, parallel_posterior);
+
+    EXPECT_TRUE(serial_posterior.log_prob_mass().isApprox(
+                    parallel_posterior.log_prob_mass(), 1e-12));
+}
+
+TEST(particle_filter_threads, parallel_predict)
+{
+    Transition transition;
+    Sensor sensor;
+
+    ParticleFilter particle_filter(transition, sensor);
+    GaussianFilter gaussian_filter(transition, sensor);
+    particle_filter.threads(4);
+
+    GaussianBelief gaussian_belief;
+    ParticleBelief particle_belief;
+    particle_belief.from_distribution(gaussian_belief, 100000);
+
+    for(int i = 0; i < 5; i++)
+    {
+        particle_filter.predict(particle_belief, State::Zero(), particle_belief);
+        gaussian_filter.predict(gaussian_belief, State::Zero(), gaussian_belief);
+    }
+
+    EXPECT_TRUE(particle_belief.covariance().isApprox(
+                    gaussian_belief.covariance(), 0.05));
+    EXPECT_TRUE(particle_belief.mean().norm() < 0.1);
+}
+
+TEST(particle_filter_threads, benchmark)
+{
+    Transition transition;
+    Sensor sensor;
+
+    GaussianBelief gaussian_belief;
+    ParticleBelief initial_belief;
+    initial_belief.from_distribution(gaussian_belief, 100000);
+
+    int max_threads = std::max(4, int(std::thread::hardware_concurrency()));
+
+    for (int threads = 1; threads <= max_threads; ++threads)
+    {
+        ParticleFilter particle_filter(transition, sensor);
+        particle_filter.threads(threads);
+
+        ParticleBelief belief = initial_belief;
+
+        INIT_PROFILING
+        for(int i = 0; i < 5; i++)
+        {
+            particle_filter.predict(belief, State::Zero(), belief);
+            particle_filter.update(belief, State::Constant(0.5), belief);
+        }
+        MEASURE("5 predict/update cycles, 100k particles, "
+                + std::to_string(threads) + " thread(s)")
+
+        EXPECT_EQ(belief.size(), 100000);
+    }
+}
+
+TEST(particle_filter_threads, copies_run_own_thread_pool)
+{
+    Transition transition;
+    Sensor sensor;
+
+    ParticleFilter particle_filter(transition, sensor);
+    particle_filter.threads(4);
+
+    // the copy continues with the same noise generator states
+    ParticleFilter copy(particle_filter);
+    ParticleFilter assigned(transition, sensor);
+    assigned = particle_filter;
+
+    EXPECT_EQ(copy.threads(), 4);
+    EXPECT_EQ(assigned.threads(), 4);
+
+    GaussianBelief gaussian_belief;
+    ParticleBelief prior;
+    prior.from_distribution(gaussian_belief, 1001);
+
+    ParticleBelief belief;
+    ParticleBelief copy_belief;
+    ParticleBelief assigned_belief;
+
+    particle_filter.predict(prior, State::Zero(), belief);
+    copy.predict(prior, State::Zero(), copy_belief);
+    assigned.predict(prior, State::Zero(), assigned_belief);
+
+    EXPECT_TRUE(belief.locations().isApprox(copy_belief.locations()));
+    EXPECT_TRUE(belief.locations().isApprox(assigned_belief.locations()));
+}
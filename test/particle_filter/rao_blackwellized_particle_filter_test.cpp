@@ -0,0 +1,262 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <Eigen/Dense>
+
+#include <fl/filter/particle/rao_blackwellized_particle_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+/*
+ * Sampled state x, sub state z and observation y = [x; x + z] + e. The
+ * joint model is linear which allows comparing with the Kalman filter over
+ * the joint state [x; z].
+ */
+typedef Eigen::Matrix<fl::Real, 2, 1> State;
+typedef Eigen::Matrix<fl::Real, 2, 1> SubState;
+typedef Eigen::Matrix<fl::Real, 4, 1> Obsrv;
+typedef Eigen::Matrix<fl::Real, 4, 1> JointState;
+
+typedef fl::LinearTransition<State, State, State> Transition;
+typedef fl::LinearTransition<SubState, SubState, State> SubTransition;
+typedef fl::LinearGaussianSensor<Obsrv, State> Sensor;
+typedef fl::LinearGaussianSensor<Obsrv, SubState> SubSensor;
+
+typedef fl::RaoBlackwellizedParticleFilter<
+            Transition, Sensor, SubTransition, SubSensor
+        > Filter;
+typedef Filter::Belief Belief;
+
+typedef fl::LinearTransition<JointState, JointState, JointState>
+    JointTransition;
+typedef fl::LinearGaussianSensor<Obsrv, JointState> JointSensor;
+typedef fl::GaussianFilter<JointTransition, JointSensor> GaussianFilter;
+
+class RaoBlackwellizedParticleFilterTests
+    : public ::testing::Test
+{
+protected:
+    RaoBlackwellizedParticleFilterTests()
+        : state_noise_(0.1),
+          sub_state_noise_(0.05),
+          obsrv_noise_(0.2)
+    {
+        transition_.noise_matrix(
+            std::sqrt(state_noise_) * Transition::NoiseMatrix::Identity());
+        sub_transition_.noise_matrix(
+            std::sqrt(sub_state_noise_)
+                * SubTransition::NoiseMatrix::Identity());
+
+        // h(x) = [x; x]
+        Sensor::SensorMatrix h;
+        h << Eigen::Matrix2d::Identity(), Eigen::Matrix2d::Identity();
+        sensor_.sensor_matrix(h);
+
+        // H = [0; I]
+        SubSensor::SensorMatrix H;
+        H << Eigen::Matrix2d::Zero(), Eigen::Matrix2d::Identity();
+        sub_sensor_.sensor_matrix(H);
+        sub_sensor_.noise_covariance(
+            obsrv_noise_ * SubSensor::NoiseMatrix::Identity());
+
+        JointTransition::NoiseMatrix Q = JointTransition::NoiseMatrix::Zero();
+        Q.topLeftCorner(2, 2).diagonal().setConstant(std::sqrt(state_noise_));
+        Q.bottomRightCorner(2, 2).diagonal()
+            .setConstant(std::sqrt(sub_state_noise_));
+        joint_transition_.noise_matrix(Q);
+
+        JointSensor::SensorMatrix joint_h;
+        joint_h << h, H;
+        joint_sensor_.sensor_matrix(joint_h);
+        joint_sensor_.noise_covariance(
+            obsrv_noise_ * JointSensor::NoiseMatrix::Identity());
+    }
+
+    Obsrv observation(int t) const
+    {
+        Obsrv y;
+        y << 0.1 * t, -0.2 * t, 0.5 + 0.1 * t, 0.3 - 0.2 * t;
+        return y;
+    }
+
+protected:
+    fl::Real state_noise_;
+    fl::Real sub_state_noise_;
+    fl::Real obsrv_noise_;
+
+    Transition transition_;
+    SubTransition sub_transition_;
+    Sensor sensor_;
+    SubSensor sub_sensor_;
+
+    JointTransition joint_transition_;
+    JointSensor joint_sensor_;
+};
+
+TEST_F(RaoBlackwellizedParticleFilterTests, tracks_kalman_filter)
+{
+    Filter filter(transition_, sensor_, sub_transition_, sub_sensor_);
+    GaussianFilter gaussian_filter(joint_transition_, joint_sensor_);
+
+    // prior x ~ N(0, I), z ~ N(0, I)
+    auto gaussian = gaussian_filter.create_belief();
+
+    Belief belief = filter.create_belief();
+    belief.from_distribution(fl::Gaussian<State>(), 1000);
+
+    const State u = State::Zero();
+
+    fl::Real max_error = 0;
+    for (int t = 0; t < 15; ++t)
+    {
+        filter.predict(belief, u, belief);
+        filter.update(belief, observation(t), belief);
+
+        gaussian_filter.predict(gaussian, JointState::Zero(), gaussian);
+        gaussian_filter.update(gaussian, observation(t), gaussian);
+
+        JointState delta;
+        delta << belief.mean() - gaussian.mean().topRows(2),
+                 belief.sub_mean() - gaussian.mean().bottomRows(2);
+
+        max_error = std::max(
+            max_error,
+            fl::Real(std::sqrt(delta.transpose()
+                               * gaussian.precision() * delta)));
+    }
+
+    EXPECT_LT(max_error, 0.3);
+    EXPECT_TRUE(belief.sub_covariance().isApprox(
+                    gaussian.covariance().bottomRightCorner(2, 2), 0.3));
+}
+
+TEST_F(RaoBlackwellizedParticleFilterTests, point_mass_reduces_to_kalman_filter)
+{
+    // without uncertainty in x, the filter is the Kalman filter of z
+    transition_.noise_matrix(Transition::NoiseMatrix::Zero());
+
+    Filter filter(transition_, sensor_, sub_transition_, sub_sensor_);
+
+    typedef fl::GaussianFilter<SubTransition, SubSensor> SubFilter;
+    SubFilter sub_filter(sub_transition_, sub_sensor_);
+
+    const State x = State(0.3, -0.4);
+
+    Belief belief(50);
+    for (int i = 0; i < belief.size(); ++i) belief.location(i) = x;
+
+    SubFilter::Belief sub_belief;
+    sub_belief.mean(SubState(1.0, 2.0));
+    sub_belief.covariance(2.0 * Eigen::Matrix2d::Identity());
+    belief.sub_belief(sub_belief);
+
+    for (int t = 0; t < 5; ++t)
+    {
+        filter.predict(belief, State::Zero(), belief);
+        filter.update(belief, observation(t), belief);
+
+        sub_filter.predict(sub_belief, State::Zero(), sub_belief);
+        sub_filter.update(sub_belief,
+                          observation(t) - sensor_.expected_observation(x),
+                          sub_belief);
+    }
+
+    for (int i = 0; i < belief.size(); ++i)
+    {
+        EXPECT_TRUE(belief.location(i).isApprox(x));
+        EXPECT_TRUE(belief.sub_belief(i).mean().isApprox(
+                        sub_belief.mean(), 1e-9));
+        EXPECT_TRUE(belief.sub_belief(i).covariance().isApprox(
+                        sub_belief.covariance(), 1e-9));
+    }
+
+    // all particles agree, the weights remain uniform
+    EXPECT_NEAR(belief.effective_sample_size(), belief.size(), 1e-6);
+}
+
+TEST(rao_blackwellized_distribution, resampling_keeps_sub_beliefs)
+{
+    Belief belief(100);
+    for (int i = 0; i < belief.size(); ++i)
+    {
+        belief.location(i) = State::Constant(i);
+        belief.sub_means().col(i) = SubState::Constant(-i);
+    }
+
+    // the entire mass is on particle 42
+    Belief::Function log_weights = Belief::Function::Constant(100, -1000);
+    log_weights(42) = 0;
+    belief.log_unnormalized_prob_mass(log_weights);
+
+    belief.from_distribution(belief, 30, fl::SystematicResampling());
+
+    EXPECT_EQ(belief.size(), 30);
+    EXPECT_EQ(belief.sub_means().cols(), 30);
+    for (int i = 0; i < belief.size(); ++i)
+    {
+        EXPECT_TRUE(belief.location(i).isApprox(State::Constant(42)));
+        EXPECT_TRUE(belief.sub_means().col(i).isApprox(SubState::Constant(-42)));
+    }
+}
+
+TEST(rao_blackwellized_distribution, marginal_moments)
+{
+    Belief belief(2);
+    belief.location(0) = State::Zero();
+    belief.location(1) = State::Zero();
+    belief.sub_means().col(0) = SubState(1.0, 0.0);
+    belief.sub_means().col(1) = SubState(-1.0, 0.0);
+    belief.conditional_sub_covariance(0.5 * Eigen::Matrix2d::Identity());
+
+    EXPECT_TRUE(belief.sub_mean().isZero());
+
+    Eigen::Matrix2d covariance;
+    covariance << 1.5, 0.0,
+                  0.0, 0.5;
+    EXPECT_TRUE(belief.sub_covariance().isApprox(covariance));
+}
+
+TEST(rao_blackwellized_distribution, sub_means_follow_particle_count)
+{
+    Belief belief(2);
+    belief.sub_means().col(0) = SubState(1.0, 0.0);
+    belief.sub_means().col(1) = SubState(3.0, 0.0);
+
+    // added particles carry the marginal sub mean
+    belief.set_uniform(5);
+    ASSERT_EQ(belief.sub_means().cols(), 5);
+    EXPECT_TRUE(belief.sub_means().col(1).isApprox(SubState(3.0, 0.0)));
+    for (int i = 2; i < belief.size(); ++i)
+    {
+        EXPECT_TRUE(belief.sub_belief(i).mean().isApprox(SubState(2.0, 0.0)));
+    }
+
+    belief.log_unnormalized_prob_mass(Belief::Function::Zero(3));
+    EXPECT_EQ(belief.size(), 3);
+    EXPECT_EQ(belief.sub_means().cols(), 3);
+    EXPECT_TRUE(belief.sub_covariance().allFinite());
+
+    belief.delta_log_prob_mass(Belief::Function::Zero(3));
+    EXPECT_EQ(belief.sub_means().cols(), 3);
+}
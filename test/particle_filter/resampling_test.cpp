@@ -0,0 +1,235 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include <fl/util/types.hpp>
+#include <fl/util/profiling.hpp>
+#include <fl/distribution/discrete_distribution.hpp>
+#include <fl/filter/particle/resampling/multinomial_resampling.hpp>
+#include <fl/filter/particle/resampling/systematic_resampling.hpp>
+#include <fl/filter/particle/resampling/stratified_resampling.hpp>
+#include <fl/filter/particle/resampling/residual_resampling.hpp>
+#include <fl/filter/particle/particle_filter.hpp>
+#include <fl/filter/gaussian/gaussian_filter_linear.hpp>
+#include <fl/model/transition/linear_transition.hpp>
+#include <fl/model/sensor/linear_gaussian_sensor.hpp>
+
+typedef fl::DiscreteDistribution<fl::ScalarMatrix> Distribution;
+typedef Distribution::Function Function;
+typedef Distribution::IndexArray IndexArray;
+
+Distribution create_distribution(int size)
+{
+    Function pmf = Function::Random(size).abs() + 0.01;
+
+    Distribution distribution;
+    distribution.log_unnormalized_prob_mass(pmf.log());
+
+    for(int i = 0; i < size; i++) distribution.location(i) = i;
+
+    return distribution;
+}
+
+template <typename Resampling>
+Function average_copies(const Distribution& distribution,
+                        int new_size,
+                        int runs,
+                        fl::Real& max_deviation)
+{
+    Resampling resampling;
+    IndexArray indices(new_size);
+    Function average = Function::Zero(distribution.size());
+
+    max_deviation = 0;
+    for(int r = 0; r < runs; r++)
+    {
+        resampling(distribution.cumulative_distribution(), indices);
+
+        Function copies = Function::Zero(distribution.size());
+        for(int k = 0; k < new_size; k++) copies(indices(k)) += 1;
+
+        Function deviation =
+            (copies - new_size * distribution.prob_mass()).abs();
+        max_deviation = std::max(max_deviation, deviation.maxCoeff());
+
+        average += copies / runs;
+    }
+
+    return average;
+}
+
+template <typename Resampling>
+void expect_unbiased(const Distribution& distribution, fl::Real& max_deviation)
+{
+    int new_size = 100;
+
+    Function average =
+        average_copies<Resampling>(distribution, new_size, 20000, max_deviation);
+
+    Function expected = new_size * distribution.prob_mass();
+    for(int i = 0; i < distribution.size(); i++)
+    {
+        EXPECT_NEAR(average(i), expected(i), 0.1);
+    }
+}
+
+TEST(resampling, multinomial_is_unbiased)
+{
+    fl::Real max_deviation;
+    expect_unbiased<fl::MultinomialResampling>(create_distribution(10),
+                                               max_deviation);
+}
+
+TEST(resampling, systematic_is_unbiased)
+{
+    fl::Real max_deviation;
+    expect_unbiased<fl::SystematicResampling>(create_distribution(10),
+                                              max_deviation);
+
+    // each particle is copied floor(N w_i) or ceil(N w_i) times
+    EXPECT_LT(max_deviation, 1.0 + 1e-9);
+}
+
+TEST(resampling, stratified_is_unbiased)
+{
+    fl::Real max_deviation;
+    expect_unbiased<fl::StratifiedResampling>(create_distribution(10),
+                                              max_deviation);
+
+    EXPECT_LT(max_deviation, 2.0 + 1e-9);
+}
+
+TEST(resampling, residual_is_unbiased)
+{
+    fl::Real max_deviation;
+    expect_unbiased<fl::ResidualResampling>(create_distribution(10),
+                                            max_deviation);
+
+    EXPECT_LT(max_deviation, 1.0 + 1e-9);
+}
+
+TEST(resampling, from_distribution_in_place)
+{
+    Distribution distribution = create_distribution(50);
+    Function prob_mass = distribution.prob_mass();
+
+    distribution.from_distribution(distribution, 5000,
+                                   fl::SystematicResampling());
+
+    EXPECT_EQ(distribution.size(), 5000);
+    EXPECT_NEAR(distribution.prob_mass(0), 1.0 / 5000., 1e-12);
+
+    Function copies = Function::Zero(50);
+    for(int i = 0; i < distribution.size(); i++)
+    {
+        copies(int(distribution.location(i))) += 1;
+    }
+
+    for(int i = 0; i < 50; i++)
+    {
+        EXPECT_LT(std::fabs(copies(i) - 5000 * prob_mass(i)), 1.0 + 1e-9);
+    }
+}
+
+TEST(resampling, particle_filter_with_systematic_resampling)
+{
+    typedef Eigen::Matrix<fl::Real, 2, 1> State;
+    typedef Eigen::Matrix<fl::Real, 2, 2> Matrix;
+
+    typedef fl::LinearTransition<State, State, State> Transition;
+    typedef fl::LinearGaussianSensor<State, State> Sensor;
+
+    typedef fl::ParticleFilter<
+                Transition, Sensor, fl::SystematicResampling
+            > ParticleFilter;
+    typedef fl::GaussianFilter<Transition, Sensor> GaussianFilter;
+
+    Transition transition;
+    Sensor sensor;
+
+    ParticleFilter particle_filter(transition, sensor, 0.1);
+    GaussianFilter gaussian_filter(transition, sensor);
+
+    auto gaussian_belief = gaussian_filter.create_belief();
+    auto particle_belief = particle_filter.create_belief();
+    particle_belief.from_distribution(gaussian_belief, 20000);
+
+    for(int i = 0; i < 5; i++)
+    {
+        State y = State::Constant(0.5);
+        particle_filter.update(particle_belief, y, particle_belief);
+        gaussian_filter.update(gaussian_belief, y, gaussian_belief);
+    }
+
+    State delta = particle_belief.mean() - gaussian_belief.mean();
+    Matrix cov_delta =
+        particle_belief.covariance() - gaussian_belief.covariance();
+
+    EXPECT_LT(std::sqrt(delta.transpose() * gaussian_belief.precision() * delta),
+              0.1);
+    EXPECT_LT(cov_delta.norm(), 0.1 * gaussian_belief.covariance().norm());
+}
+
+template <typename Resampling>
+void benchmark_resampling(const std::string& name,
+                          const Distribution& distribution,
+                          int repetitions)
+{
+    Distribution resampled;
+    Resampling resampling;
+
+    INIT_PROFILING
+    for(int r = 0; r < repetitions; r++)
+    {
+        resampled.from_distribution(distribution,
+                                    distribution.size(),
+                                    resampling);
+    }
+    MEASURE(name + " x " + std::to_string(repetitions))
+
+    EXPECT_EQ(resampled.size(), distribution.size());
+}
+
+TEST(resampling, benchmark)
+{
+    Distribution distribution = create_distribution(50000);
+    int repetitions = 10;
+
+    Distribution resampled;
+    INIT_PROFILING
+    for(int r = 0; r < repetitions; r++)
+    {
+        resampled.from_distribution(distribution, distribution.size());
+    }
+    MEASURE("sample() based resampling x " + std::to_string(repetitions))
+
+    benchmark_resampling<fl::MultinomialResampling>(
+        "MultinomialResampling", distribution, repetitions);
+    benchmark_resampling<fl::SystematicResampling>(
+        "SystematicResampling", distribution, repetitions);
+    benchmark_resampling<fl::StratifiedResampling>(
+        "StratifiedResampling", distribution, repetitions);
+    benchmark_resampling<fl::ResidualResampling>(
+        "ResidualResampling", distribution, repetitions);
+}
@@ -0,0 +1,101 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * @date 2015
+ * @author Manuel Wuthrich (manuel.wuthrich@gmail.com)
+ * Max-Planck-Institute for Intelligent Systems
+ */
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+
+#include <fl/util/math/block_structure.hpp>
+
+TEST(block_structure, diagonal_blocks)
+{
+    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(7, 7);
+    A.block(0, 0, 2, 2) = Eigen::Matrix2d::Random();
+    A.block(2, 2, 2, 2).setIdentity();
+    A(4, 4) = 3;
+    A.block(5, 5, 2, 2) = Eigen::Matrix2d::Random();
+    A(6, 5) = 0;  // upper triangular block remains one block
+    A(5, 6) = 1;
+
+    fl::DiagonalBlocks blocks(A);
+
+    ASSERT_EQ(blocks.count(), 5);
+    EXPECT_FALSE(blocks.dense());
+
+    EXPECT_EQ(blocks.offset(0), 0);   EXPECT_EQ(blocks.size(0), 2);
+    EXPECT_EQ(blocks.offset(1), 2);   EXPECT_EQ(blocks.size(1), 1);
+    EXPECT_EQ(blocks.offset(2), 3);   EXPECT_EQ(blocks.size(2), 1);
+    EXPECT_EQ(blocks.offset(3), 4);   EXPECT_EQ(blocks.size(3), 1);
+    EXPECT_EQ(blocks.offset(4), 5);   EXPECT_EQ(blocks.size(4), 2);
+
+    EXPECT_FALSE(blocks.identity(0));
+    EXPECT_TRUE(blocks.identity(1));
+    EXPECT_TRUE(blocks.identity(2));
+    EXPECT_FALSE(blocks.identity(3));
+    EXPECT_FALSE(blocks.identity(4));
+}
+
+TEST(block_structure, dense_matrix_is_one_block)
+{
+    Eigen::MatrixXd A = Eigen::MatrixXd::Random(5, 5);
+    A(4, 0) = 1;
+
+    fl::DiagonalBlocks blocks(A);
+
+    EXPECT_EQ(blocks.count(), 1);
+    EXPECT_TRUE(blocks.dense());
+
+    // a coupling of the first and the last element spans all
+    Eigen::MatrixXd B = Eigen::MatrixXd::Identity(5, 5);
+    B(0, 4) = 1;
+    blocks.detect(B);
+    EXPECT_EQ(blocks.count(), 1);
+}
+
+TEST(block_structure, block_diagonal_congruence)
+{
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(6, 6);
+    A.block(0, 0, 2, 2) = Eigen::Matrix2d::Random();
+    A.block(4, 4, 2, 2) = Eigen::Matrix2d::Random();
+
+    Eigen::MatrixXd P = Eigen::MatrixXd::Random(6, 6);
+    P = P * P.transpose();
+
+    Eigen::MatrixXd result;
+    fl::block_diagonal_congruence(A, fl::DiagonalBlocks(A), P, result);
+
+    EXPECT_TRUE(result.isApprox(A * P * A.transpose()));
+}
+
+TEST(block_structure, column_blocks)
+{
+    Eigen::MatrixXd H = Eigen::MatrixXd::Zero(3, 8);
+    H.col(1).setRandom();
+    H.col(2).setRandom();
+    H(0, 5) = 1;
+    H(2, 7) = -1;
+
+    fl::ColumnBlocks blocks(H);
+
+    ASSERT_EQ(blocks.count(), 3);
+    EXPECT_EQ(blocks.offset(0), 1);   EXPECT_EQ(blocks.size(0), 2);
+    EXPECT_EQ(blocks.offset(1), 5);   EXPECT_EQ(blocks.size(1), 1);
+    EXPECT_EQ(blocks.offset(2), 7);   EXPECT_EQ(blocks.size(2), 1);
+    EXPECT_EQ(blocks.dimension(), 8);
+}
@@ -0,0 +1,154 @@
+/*
+ * This is part of the fl library, a C++ Bayesian filtering library
+ * (https://github.com/filtering-library)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the MIT License (MIT).
+ * A copy of the license can be found in the LICENSE file distributed with this
+ * source code.
+ */
+
+/**
+ * \file covariance_factorization_test.cpp
+ * \date 2015
+ * \author Jan Issac (jan.issac@gmail.com)
+ */
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+
+#include <cmath>
+
+#include <fl/util/types.hpp>
+#include <fl/util/profiling.hpp>
+#include <fl/util/math/covariance_factorization.hpp>
+
+template <int Dimension>
+struct TestConfiguration
+{
+    enum: signed int { Dim = Dimension };
+};
+
+template <typename TestType>
+class CovarianceFactorizationTests
+    : public testing::Test
+{
+public:
+    enum: signed int { Dim = TestType::Dim };
+
+    typedef Eigen::Matrix<fl::Real, Dim, Dim> Matrix;
+    typedef Eigen::Matrix<fl::Real, Dim, 1> Vector;
+
+    typedef fl::CovarianceFactorization<Matrix, true> Unrolled;
+    typedef fl::CovarianceFactorization<Matrix, false> Generic;
+
+    static Matrix random_covariance()
+    {
+        Matrix A = Matrix::Random();
+        return A * A.transpose() + Matrix::Identity();
+    }
+};
+
+TYPED_TEST_CASE_P(CovarianceFactorizationTests);
+
+TYPED_TEST_P(CovarianceFactorizationTests, unrolled_matches_generic)
+{
+    typedef TestFixture This;
+    typedef typename This::Matrix Matrix;
+    typedef typename This::Vector Vector;
+
+    Matrix covariance = This::random_covariance();
+    Vector delta = Vector::Random();
+    Vector delta_copy = delta;
+
+    typename This::Unrolled unrolled;
+    typename This::Generic generic;
+    unrolled.compute(covariance);
+    generic.compute(covariance);
+
+    ASSERT_TRUE(unrolled.positive_definite());
+    ASSERT_TRUE(generic.positive_definite());
+
+    EXPECT_TRUE(unrolled.square_root().isApprox(generic.square_root()));
+    EXPECT_TRUE(unrolled.pivots().isApprox(generic.pivots()));
+    EXPECT_NEAR(unrolled.pivots().prod() / covariance.determinant(),
+                1.0, 1e-9);
+    EXPECT_NEAR(unrolled.squared_norms(delta)(0),
+                generic.squared_norms(delta_copy)(0),
+                1e-9);
+}
+
+TYPED_TEST_P(CovarianceFactorizationTests, singular_matrix_falls_back)
+{
+    typedef TestFixture This;
+    typedef typename This::Matrix Matrix;
+    typedef typename This::Vector Vector;
+
+    Vector v = Vector::Random();
+    Matrix covariance = v * v.transpose();
+
+    typename This::Unrolled unrolled;
+    unrolled.compute(covariance);
+
+    if (This::Dim > 1) EXPECT_FALSE(unrolled.positive_definite());
+    EXPECT_TRUE((unrolled.square_root() * unrolled.square_root().transpose())
+                    .isApprox(covariance, 1e-9));
+}
+
+TYPED_TEST_P(CovarianceFactorizationTests, benchmark)
+{
+    typedef TestFixture This;
+    typedef typename This::Matrix Matrix;
+    typedef typename This::Vector Vector;
+
+    const int count = 100000;
+
+    Matrix covariance = This::random_covariance();
+    Vector delta = Vector::Random();
+    fl::Real sum = 0;
+
+    typename This::Unrolled unrolled;
+    typename This::Generic generic;
+
+    INIT_PROFILING
+    for (int i = 0; i < count; ++i)
+    {
+        covariance(0, 0) += 1e-6;
+        Vector d = delta;
+        generic.compute(covariance);
+        sum += generic.squared_norms(d)(0) + generic.pivots().prod();
+    }
+    MEASURE("generic factorization, dimension " << This::Dim)
+
+    for (int i = 0; i < count; ++i)
+    {
+        covariance(0, 0) += 1e-6;
+        Vector d = delta;
+        unrolled.compute(covariance);
+        sum += unrolled.squared_norms(d)(0) + unrolled.pivots().prod();
+    }
+    MEASURE("unrolled factorization, dimension " << This::Dim)
+
+    EXPECT_TRUE(std::isfinite(sum));
+}
+
+REGISTER_TYPED_TEST_CASE_P(CovarianceFactorizationTests,
+                           unrolled_matches_generic,
+                           singular_matrix_falls_back,
+                           benchmark);
+
+typedef ::testing::Types<
+            TestConfiguration<1>,
+            TestConfiguration<2>,
+            TestConfiguration<3>,
+            TestConfiguration<6>,
+            TestConfiguration<12>
+        > TestTypes;
+
+INSTANTIATE_TYPED_TEST_CASE_P(CovarianceFactorizationTestCases,
+                              CovarianceFactorizationTests,
+                              TestTypes);